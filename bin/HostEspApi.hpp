@@ -0,0 +1,36 @@
+#ifndef BIN_HOSTESPAPI_HPP
+#define BIN_HOSTESPAPI_HPP
+
+#include <chrono>
+
+#include "common/EspApi.hpp"
+
+// Only the time is needed to run operations on the host.
+class HostEspApi : public EspApi {
+public:
+    void pinMode(uint8_t /*pin*/, GpioMode /*mode*/) override {}
+    void digitalWrite(uint8_t /*pin*/, uint8_t /*val*/) override {}
+    int digitalRead(uint8_t /*pin*/) override { return 0; }
+
+    unsigned long millis() override { return this->micros() / 1000; }
+    unsigned long micros() override {
+        return std::chrono::duration_cast<std::chrono::microseconds>(
+                   std::chrono::steady_clock::now() - this->start)
+            .count();
+    }
+    void delay(unsigned long /*ms*/) override {}
+    void restart(bool /*hard*/) override {}
+
+    uint32_t getFreeHeap() override { return 0; }
+
+    void doDisableInterrupt() override {}
+    void doEnableInterrupt() override {}
+
+    void setRush(unsigned long /*microseconds*/) override {}
+
+private:
+    std::chrono::steady_clock::time_point start =
+        std::chrono::steady_clock::now();
+};
+
+#endif  // BIN_HOSTESPAPI_HPP
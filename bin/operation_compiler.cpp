@@ -0,0 +1,188 @@
+#include <algorithm>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "HostEspApi.hpp"
+#include "common/ArduinoJson.hpp"
+#include "common/InterfaceConfig.hpp"
+#include "operation/Generator.hpp"
+#include "operation/OperationParser2.hpp"
+
+using namespace ArduinoJson;
+
+void printUsage() {
+    std::cerr << "Usage: operation_compiler < device_config.json > rules.cpp\n"
+                 "Turns the actions given as expressions into C++ functions. "
+                 "Build the output into the firmware, and these actions are "
+                 "not parsed at boot.\n";
+}
+
+struct Rule {
+    std::string expression;
+    std::string defaultInterface;
+    std::vector<std::string> interfaces;
+    std::size_t stackSize;
+    std::string code;
+};
+
+void writeRules(
+    std::ostream& out, const std::vector<Rule>& rules,
+    const std::vector<std::string>& strings) {
+    out << "// Generated by operation_compiler. Do not edit.\n"
+           "\n"
+           "#include <functional>\n"
+           "#include <string>\n"
+           "\n"
+           "#include \"operation/Operations.hpp\"\n"
+           "#include \"operation/Precompiled.hpp\"\n"
+           "\n"
+           "namespace operation {\n"
+           "namespace {\n";
+
+    if (!strings.empty()) {
+        out << "\nconst std::string strings[] = {\n";
+        for (const auto& value : strings) {
+            out << "    ";
+            operation::writeStringLiteral(out, value);
+            out << ",\n";
+        }
+        out << "};\n";
+    }
+
+    for (std::size_t i = 0; i < rules.size(); ++i) {
+        const Rule& rule = rules[i];
+        out << "\n// ";
+        operation::writeStringLiteral(out, rule.expression);
+        out << "\nvoid rule" << i << "(const InterfaceConfig* const* "
+            << (rule.interfaces.empty() ? "/*interfaces*/" : "interfaces")
+            << ", TypedValue* stack) {\n"
+            << rule.code << "}\n";
+        if (!rule.interfaces.empty()) {
+            out << "\nconst char* const interfaces" << i << "[] = {";
+            for (std::size_t j = 0; j < rule.interfaces.size(); ++j) {
+                out << (j == 0 ? "" : ", ");
+                operation::writeStringLiteral(out, rule.interfaces[j]);
+            }
+            out << "};\n";
+        }
+    }
+
+    if (!rules.empty()) {
+        out << "\nconst Precompiled::Rule rules[] = {\n";
+        for (std::size_t i = 0; i < rules.size(); ++i) {
+            const Rule& rule = rules[i];
+            out << "    {";
+            operation::writeStringLiteral(out, rule.expression);
+            out << ",\n     ";
+            operation::writeStringLiteral(out, rule.defaultInterface);
+            out << ", ";
+            if (rule.interfaces.empty()) {
+                out << "nullptr";
+            } else {
+                out << "interfaces" << i;
+            }
+            out << ", " << rule.interfaces.size() << ", " << rule.stackSize
+                << ", &rule" << i << "},\n";
+        }
+        out << "};\n"
+               "\n"
+               "Precompiled::Registration registration{rules, "
+            << rules.size() << "};\n";
+    }
+
+    out << "\n}  // unnamed namespace\n"
+           "}  // namespace operation\n";
+}
+
+int main(int argc, const char** /*argv*/) {
+    if (argc != 1) {
+        printUsage();
+        return 1;
+    }
+
+    DynamicJsonBuffer buffer{512};
+    std::string content, line;
+    while (std::getline(std::cin, line)) {
+        content += line;
+        content += "\n";
+    }
+    auto& data = buffer.parseObject(content);
+    if (!data.success()) {
+        std::cerr << "Invalid JSON.\n";
+        return 2;
+    }
+
+    std::vector<std::unique_ptr<InterfaceConfig>> interfaces;
+    for (const JsonObject& interface : data.get<JsonArray>("interfaces")) {
+        interfaces.emplace_back(std::make_unique<InterfaceConfig>());
+        interfaces.back()->name = interface.get<std::string>("name");
+    }
+
+    HostEspApi esp;
+    std::vector<Rule> rules;
+    std::vector<std::string> strings;
+    bool failed = false;
+    int index = 0;
+    for (const JsonObject& action : data.get<JsonArray>("actions")) {
+        ++index;
+        const char* fieldName =
+            action.get<std::string>("type") == "command" ? "command"
+                                                         : "payload";
+        if (!action[fieldName].is<std::string>()) {
+            continue;
+        }
+
+        Rule rule;
+        rule.expression = action.get<std::string>(fieldName);
+        rule.defaultInterface = action.get<std::string>("interface");
+        if (std::any_of(rules.begin(), rules.end(), [&](const Rule& other) {
+            return other.expression == rule.expression &&
+                   other.defaultInterface == rule.defaultInterface;
+        })) {
+            continue;
+        }
+
+        operation::Parser2 parser{
+            std::cerr, interfaces,
+            findInterface(interfaces, rule.defaultInterface), &esp};
+        auto operation = parser.parse(rule.expression);
+        if (!operation) {
+            std::cerr << "action " << index << ": cannot parse\n";
+            failed = true;
+            continue;
+        }
+
+        // The generated code refers to the interfaces by their position, so
+        // the order must not depend on the hash of the pointers.
+        std::vector<const InterfaceConfig*> used{
+            parser.getUsedInterfaces().begin(),
+            parser.getUsedInterfaces().end()};
+        std::sort(used.begin(), used.end(), [](auto lhs, auto rhs) {
+            return lhs->name < rhs->name;
+        });
+
+        std::ostringstream code;
+        std::vector<std::string> ruleStrings = strings;
+        operation::Generator generator{code, used, ruleStrings};
+        if (!operation->generate(generator)) {
+            std::cerr << "action " << index
+                      << ": cannot be precompiled, it is parsed at boot\n";
+            continue;
+        }
+
+        for (const InterfaceConfig* interface : used) {
+            rule.interfaces.push_back(interface->name);
+        }
+        rule.stackSize = generator.getStackSize();
+        rule.code = code.str();
+        strings = std::move(ruleStrings);
+        rules.push_back(std::move(rule));
+    }
+
+    writeRules(std::cout, rules, strings);
+    return failed ? 3 : 0;
+}
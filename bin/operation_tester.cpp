@@ -1,16 +1,255 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
 #include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
 
+#include "HostEspApi.hpp"
 #include "common/ArduinoJson.hpp"
 #include "common/Interface.hpp"
 #include "common/InterfaceConfig.hpp"
+#include "operation/Batch.hpp"
 #include "operation/OperationParser.hpp"
+#include "operation/OperationParser2.hpp"
+#include "operation/Profiled.hpp"
 
 using namespace ArduinoJson;
 
 void printUsage() {
-    std::cerr << "Usage: operation_tester -i name value [value...] [-i name "
-                 "value...]...\n"
-                 "stdin: valid JSON containing action";
+    std::cerr << "Usage: operation_tester [-p count] -i name value [value...] "
+                 "[-i name value...]...\n"
+                 "stdin: valid JSON containing action\n"
+                 "-p: evaluate count times and print the time spent in each "
+                 "part of the operation\n"
+                 "\n"
+                 "Usage: operation_tester -b [-n repetitions]\n"
+                 "stdin: one test case per line, such as\n"
+                 "  {\"interfaces\": {\"a\": [\"1\", \"2\"]}, "
+                 "\"action\": {...}, \"expected\": \"3\"}\n"
+                 "  {\"interfaces\": {\"a\": [\"1\"]}, \"interface\": "
+                 "\"a\", \"expression\": \"%1 + 1\"}\n"
+                 "-b: evaluate each case, print the ones that do not give the "
+                 "expected value, and measure parsing and evaluation\n"
+                 "-n: parse and evaluate each case this many times, default "
+                 "1000\n"
+                 "\n"
+                 "Usage: operation_tester -c expression [-d interface]\n"
+                 "stdin: CSV with a header of interface names, such as\n"
+                 "  a,a.2,b\n"
+                 "  1,2,3\n"
+                 "-c: print the value of the expression for each row, where "
+                 "a.2 is the second value of a\n"
+                 "-d: the default interface of the expression";
+}
+
+struct Measurement {
+    std::chrono::steady_clock::duration time{};
+    unsigned long count = 0;
+};
+
+template <typename Function>
+void measure(Measurement& measurement, int repetitions, Function function) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < repetitions; ++i) {
+        function();
+    }
+    measurement.time += std::chrono::steady_clock::now() - start;
+    measurement.count += repetitions;
+}
+
+void printMeasurement(const char* name, const Measurement& measurement) {
+    double nanoseconds =
+        std::chrono::duration<double, std::nano>(measurement.time).count();
+    double perOperation = measurement.count ? nanoseconds / measurement.count
+                                            : 0.0;
+    std::cout << name << ": " << measurement.count << " ops, "
+              << std::fixed << std::setprecision(0)
+              << (perOperation != 0.0 ? 1e9 / perOperation : 0.0)
+              << " ops/s, " << std::setprecision(1) << perOperation
+              << " ns/op\n";
+}
+
+// Parses the operation of an action the same way as the configuration does,
+// which looks up the interfaces of all actions in one registry.
+std::unique_ptr<operation::Operation> parseAction(
+    const std::vector<std::unique_ptr<InterfaceConfig>>& interfaces,
+    const InterfaceRegistry& registry, EspApi& esp, JsonObject& action) {
+    auto defaultInterface =
+        findInterface(registry, action.get<std::string>("interface"));
+    bool isCommand = action.get<std::string>("type") == "command";
+    const char* fieldName = isCommand ? "command" : "payload";
+    if (action[fieldName].is<std::string>()) {
+        operation::Parser2 parser{
+            std::cerr, registry, defaultInterface, &esp};
+        return parser.parse(action.get<std::string>(fieldName));
+    }
+    if (!isCommand && !action["payload"].success() &&
+        !action["template"].success()) {
+        action.set("template", "%1");
+    }
+    operation::Parser parser{interfaces, defaultInterface};
+    return parser.parse(action, fieldName, "template");
+}
+
+int runBatch(int repetitions) {
+    HostEspApi esp;
+    Measurement parsing;
+    Measurement evaluation;
+    int cases = 0;
+    int failures = 0;
+    std::string line;
+    for (int lineNumber = 1; std::getline(std::cin, line); ++lineNumber) {
+        if (line.find_first_not_of(" \t\r") == std::string::npos) {
+            continue;
+        }
+        ++cases;
+        DynamicJsonBuffer buffer{512};
+        auto& data = buffer.parseObject(line);
+        if (!data.success()) {
+            std::cout << "line " << lineNumber << ": invalid JSON\n";
+            ++failures;
+            continue;
+        }
+
+        std::vector<std::unique_ptr<InterfaceConfig>> interfaces;
+        for (const auto& interfaceData : data.get<JsonObject>("interfaces")) {
+            interfaces.emplace_back(std::make_unique<InterfaceConfig>());
+            interfaces.back()->name = interfaceData.key;
+            for (const auto& value : interfaceData.value.as<JsonArray>()) {
+                interfaces.back()->storedValue.push_back(
+                    value.as<std::string>());
+            }
+        }
+        InterfaceRegistry registry{interfaces};
+
+        std::function<std::unique_ptr<operation::Operation>()> parse;
+        if (data["action"].is<JsonObject>()) {
+            JsonObject& action = data["action"];
+            parse = [&]() {
+                return parseAction(interfaces, registry, esp, action);
+            };
+        } else {
+            auto defaultInterface =
+                findInterface(registry, data.get<std::string>("interface"));
+            std::string expression = data["expression"];
+            parse = [&, defaultInterface, expression]() {
+                operation::Parser2 parser{
+                    std::cerr, registry, defaultInterface, &esp};
+                return parser.parse(expression);
+            };
+        }
+
+        auto operation = parse();
+        if (!operation) {
+            std::cout << "line " << lineNumber << ": cannot parse\n";
+            ++failures;
+            continue;
+        }
+        std::string value = operation->evaluate();
+        if (data["expected"].success()) {
+            std::string expected = data["expected"];
+            if (value != expected) {
+                std::cout << "line " << lineNumber << ": expected \""
+                          << expected << "\", got \"" << value << "\"\n";
+                ++failures;
+            }
+        }
+
+        measure(parsing, repetitions, [&]() { parse(); });
+        measure(
+            evaluation, repetitions, [&]() { operation->evaluateValue(); });
+    }
+
+    std::cout << cases << " cases, " << failures << " failed\n";
+    printMeasurement("parse", parsing);
+    printMeasurement("evaluate", evaluation);
+    return failures == 0 ? 0 : 3;
+}
+
+std::vector<std::string> splitCsvLine(const std::string& line) {
+    std::vector<std::string> result;
+    std::size_t begin = 0;
+    while (true) {
+        std::size_t end = line.find(',', begin);
+        result.push_back(line.substr(begin, end - begin));
+        if (end == std::string::npos) {
+            break;
+        }
+        begin = end + 1;
+    }
+    if (!result.back().empty() && result.back().back() == '\r') {
+        result.back().pop_back();
+    }
+    return result;
+}
+
+int runCsv(const std::string& expression, const std::string& interfaceName) {
+    std::string line;
+    if (!std::getline(std::cin, line)) {
+        std::cerr << "Missing header.\n";
+        return 2;
+    }
+
+    // A column named a.2 holds the second value of interface a.
+    std::vector<std::unique_ptr<InterfaceConfig>> interfaces;
+    std::vector<std::pair<InterfaceConfig*, std::size_t>> columns;
+    for (const std::string& header : splitCsvLine(line)) {
+        std::size_t dot = header.find('.');
+        std::string name = header.substr(0, dot);
+        int index = dot == std::string::npos
+            ? 1 : std::atoi(header.c_str() + dot + 1);
+        if (name.empty() || index <= 0) {
+            std::cerr << "Invalid column: " << header << "\n";
+            return 2;
+        }
+        auto it = std::find_if(
+            interfaces.begin(), interfaces.end(), [&](const auto& interface) {
+            return interface->name == name;
+        });
+        if (it == interfaces.end()) {
+            interfaces.emplace_back(std::make_unique<InterfaceConfig>());
+            interfaces.back()->name = std::move(name);
+            it = interfaces.end() - 1;
+        }
+        columns.emplace_back(it->get(), index);
+    }
+
+    std::vector<std::vector<std::string>> values(columns.size());
+    for (int lineNumber = 2; std::getline(std::cin, line); ++lineNumber) {
+        auto fields = splitCsvLine(line);
+        if (fields.size() != columns.size()) {
+            std::cerr << "line " << lineNumber << ": expected "
+                      << columns.size() << " fields, got " << fields.size()
+                      << "\n";
+            return 2;
+        }
+        for (std::size_t i = 0; i < fields.size(); ++i) {
+            values[i].push_back(std::move(fields[i]));
+        }
+    }
+
+    InterfaceRegistry registry{interfaces};
+    // There is no time to replay, so the time functions are rejected.
+    operation::Parser2 parser{
+        std::cerr, registry, findInterface(registry, interfaceName)};
+    auto operation = parser.parse(expression);
+    if (!operation) {
+        return 2;
+    }
+
+    operation::Batch batch{values.empty() ? 0 : values.front().size()};
+    for (std::size_t i = 0; i < columns.size(); ++i) {
+        batch.setInput(
+            *columns[i].first, columns[i].second, std::move(values[i]));
+    }
+    for (const std::string& value : batch.evaluate(*operation)) {
+        std::cout << value << "\n";
+    }
+    return 0;
 }
 
 int main(int argc, const char** argv) {
@@ -18,9 +257,38 @@ int main(int argc, const char** argv) {
     args.reserve(argc - 1);
 
     std::vector<std::unique_ptr<InterfaceConfig>> interfaces;
+    int profileCount = 0;
+    bool batch = false;
+    int repetitions = 1000;
+    std::string csvExpression;
+    std::string csvInterface;
     for (int i = 1; i < argc; ++i) {
         std::string arg(argv[i]);
-        if (arg == "-i") {
+        if (arg == "-b") {
+            batch = true;
+        } else if (arg == "-c") {
+            if (i + 1 == argc) {
+                printUsage();
+                return 1;
+            }
+            csvExpression = argv[++i];
+        } else if (arg == "-d") {
+            if (i + 1 == argc) {
+                printUsage();
+                return 1;
+            }
+            csvInterface = argv[++i];
+        } else if (arg == "-n") {
+            if (i + 1 == argc || (repetitions = std::atoi(argv[++i])) <= 0) {
+                printUsage();
+                return 1;
+            }
+        } else if (arg == "-p") {
+            if (i + 1 == argc || (profileCount = std::atoi(argv[++i])) <= 0) {
+                printUsage();
+                return 1;
+            }
+        } else if (arg == "-i") {
             if (!interfaces.empty() &&
                 (interfaces.back()->name.empty() ||
                  interfaces.back()->storedValue.empty())) {
@@ -29,6 +297,9 @@ int main(int argc, const char** argv) {
             }
 
             interfaces.emplace_back(std::make_unique<InterfaceConfig>());
+        } else if (interfaces.empty()) {
+            printUsage();
+            return 1;
         } else {
             auto& interface = *interfaces.back();
             if (interface.name.empty()) {
@@ -39,6 +310,23 @@ int main(int argc, const char** argv) {
         }
     }
 
+    if (!csvExpression.empty() || !csvInterface.empty()) {
+        if (csvExpression.empty() || batch || !interfaces.empty() ||
+            profileCount != 0) {
+            printUsage();
+            return 1;
+        }
+        return runCsv(csvExpression, csvInterface);
+    }
+
+    if (batch) {
+        if (!interfaces.empty() || profileCount != 0) {
+            printUsage();
+            return 1;
+        }
+        return runBatch(repetitions);
+    }
+
     if (interfaces.empty()) {
         printUsage();
         return 1;
@@ -71,7 +359,28 @@ int main(int argc, const char** argv) {
     const std::string type = data["type"];
     const char* fieldName = type == "command" ? "command" : "payload";
     auto operation = parser.parse(data, fieldName, "template");
+    if (profileCount == 0) {
+        std::cout << operation->evaluate() << "\n";
+        return 0;
+    }
+
+    HostEspApi esp;
+    operation = operation::profile(std::move(operation), esp, "", true);
+    for (int i = 1; i < profileCount; ++i) {
+        operation->evaluate();
+    }
     std::cout << operation->evaluate() << "\n";
 
+    auto profile = operation::Profiled::getAll();
+    std::sort(profile.begin(), profile.end(), [](auto lhs, auto rhs) {
+        return lhs->getName() < rhs->getName();
+    });
+    std::cerr << "count\tmicros\tnode\n";
+    for (const operation::Profiled* profiled : profile) {
+        const std::string& name = profiled->getName();
+        std::cerr << profiled->getCount() << "\t" << profiled->getMicros()
+                  << "\t" << (name.empty() ? "/" : name) << "\n";
+    }
+
     return 0;
 }
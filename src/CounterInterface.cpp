@@ -57,14 +57,14 @@ void IRAM_ATTR CounterInterface::onRiseStatic(void* arg) {
 }
 
 CounterInterface::CounterInterface(
-    std::ostream& debug, EspApi& esp, std::string name, uint8_t pin,
-    int bounceTime, float multiplier, int interval, int offset,
+    std::ostream& debug, EspApi& esp, TimerWheel& timers, std::string name,
+    uint8_t pin, int bounceTime, float multiplier, int interval, int offset,
     std::vector<std::string> pulse)
     : bounceTime(bounceTime)
     , interval(interval)
     , sensorInterface(
-          debug, esp, createCounterSensor(multiplier), std::move(name),
-          interval, offset, std::move(pulse)) {
+          debug, esp, timers, createCounterSensor(multiplier),
+          std::move(name), interval, offset, std::move(pulse)) {
     pinMode(pin, INPUT);
     this->resetMinInterval();
     attachInterruptArg(pin, onRiseStatic, this, RISING);
@@ -10,9 +10,9 @@
 class CounterInterface : public Interface {
 public:
     CounterInterface(
-        std::ostream& debug, EspApi& esp, std::string name, uint8_t pin,
-        int bounceTime, float multiplier, int interval, int offset,
-        std::vector<std::string> pulse);
+        std::ostream& debug, EspApi& esp, TimerWheel& timers,
+        std::string name, uint8_t pin, int bounceTime, float multiplier,
+        int interval, int offset, std::vector<std::string> pulse);
 
     void start() override;
     void execute(const std::string& command) override;
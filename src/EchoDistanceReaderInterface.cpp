@@ -43,7 +43,7 @@ void EchoDistanceReaderInterface::update(Actions action) {
     }
 
     double distance = (this->fallTime - this->riseTime) * speedOfSound / 2.0;
-    action.fire(std::vector<std::string>{tools::floatToString(distance, 3)});
+    action.fire({tools::floatToString(distance, 3)});
     reset();
 }
 
@@ -1,9 +1,10 @@
 #ifndef COMMON_ACTION_HPP
 #define COMMON_ACTION_HPP
 
+#include "../tools/arena.hpp"
 #include "InterfaceConfig.hpp"
 
-class Action {
+class Action : public tools::ArenaAllocated {
 public:
     virtual void fire(const InterfaceConfig& interface) = 0;
     virtual void reset() = 0;
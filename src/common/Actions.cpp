@@ -1,15 +1,28 @@
 #include "Actions.hpp"
 
-void Actions::fire(const std::vector<std::string>& values) {
-    this->interface.storedValue = values;
-    if (values.empty()) {
+template <typename Values>
+void Actions::fireValues(const Values& values) {
+    if (this->interface.storedValue != values) {
+        this->interface.storedValue.assign(values.begin(), values.end());
+        ++this->interface.generation;
+    }
+    if (values.size() == 0) {
         return;
     }
+    this->interface.lastFired = this->esp.millis();
     for (const auto& action : this->interface.actions) {
         action->fire(this->interface);
     }
 }
 
+void Actions::fire(std::initializer_list<std::string_view> values) {
+    this->fireValues(values);
+}
+
+void Actions::fire(const std::vector<std::string>& values) {
+    this->fireValues(values);
+}
+
 void Actions::reset() {
     for (const auto& action : this->interface.actions) {
         action->reset();
@@ -1,17 +1,33 @@
 #ifndef COMMON_ACTIONS_HPP
 #define COMMON_ACTIONS_HPP
 
+#include <initializer_list>
+#include <string>
+#include <string_view>
+#include <vector>
+
 #include "Action.hpp"
+#include "EspApi.hpp"
 
 class Actions {
 public:
-    Actions(InterfaceConfig& interface) : interface(interface) {}
+    Actions(InterfaceConfig& interface, EspApi& esp)
+        : interface(interface), esp(esp) {}
 
+    // The values are copied into the slots of the interface, reusing their
+    // storage, so firing does not allocate memory once the interface has had
+    // values of the same size. Prefer this to the vector overload, which
+    // needs the vector to be built first.
+    void fire(std::initializer_list<std::string_view> values);
     void fire(const std::vector<std::string>& values);
     void reset();
 
 private:
+    template <typename Values>
+    void fireValues(const Values& values);
+
     InterfaceConfig& interface;
+    EspApi& esp;
 };
 
 #endif  // COMMON_ACTIONS_HPP
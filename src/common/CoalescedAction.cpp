@@ -0,0 +1,51 @@
+#include "CoalescedAction.hpp"
+
+CoalescedAction* CoalescedAction::first = nullptr;
+CoalescedAction* CoalescedAction::last = nullptr;
+
+CoalescedAction::~CoalescedAction() {
+    if (this->isPending()) {
+        this->unlink();
+    }
+}
+
+void CoalescedAction::fire(const InterfaceConfig& interface) {
+    if (!this->isPending()) {
+        this->previous = last;
+        if (last) {
+            last->next = this;
+        } else {
+            first = this;
+        }
+        last = this;
+    }
+    this->interface = &interface;
+}
+
+void CoalescedAction::reset() {
+    this->action->reset();
+}
+
+bool CoalescedAction::firePending() {
+    if (!first) {
+        return false;
+    }
+    // Actions marked while firing, such as by a command given to another
+    // interface, are fired in the next loop.
+    CoalescedAction* end = last;
+    CoalescedAction* action = nullptr;
+    do {
+        action = first;
+        const InterfaceConfig& interface = *action->interface;
+        action->unlink();
+        action->action->fire(interface);
+    } while (action != end && first);
+    return true;
+}
+
+void CoalescedAction::unlink() {
+    (this->previous ? this->previous->next : first) = this->next;
+    (this->next ? this->next->previous : last) = this->previous;
+    this->previous = this->next = nullptr;
+    this->interface = nullptr;
+}
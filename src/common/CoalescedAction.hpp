@@ -0,0 +1,41 @@
+#ifndef COMMON_COALESCEDACTION_HPP
+#define COMMON_COALESCEDACTION_HPP
+
+#include <memory>
+
+#include "Action.hpp"
+
+// Fires an action at most once per loop, after all the interfaces are
+// updated. An action that uses more interfaces is fired by each of them, so
+// when more of them change in the same loop, the action would see the values
+// of some of them before the others change.
+class CoalescedAction : public Action {
+public:
+    explicit CoalescedAction(std::unique_ptr<Action> action)
+        : action(std::move(action)) {}
+    ~CoalescedAction();
+
+    // Marks the action to be fired by firePending().
+    void fire(const InterfaceConfig& interface) override;
+    void reset() override;
+
+    bool isPending() const { return this->interface != nullptr; }
+
+    // Fires the marked actions in the order they were marked. Returns whether
+    // there were any.
+    static bool firePending();
+
+private:
+    void unlink();
+
+    std::unique_ptr<Action> action;
+    // The last interface that fired it, if it is pending.
+    const InterfaceConfig* interface = nullptr;
+    CoalescedAction* previous = nullptr;
+    CoalescedAction* next = nullptr;
+
+    static CoalescedAction* first;
+    static CoalescedAction* last;
+};
+
+#endif  // COMMON_COALESCEDACTION_HPP
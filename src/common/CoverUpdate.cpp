@@ -109,11 +109,12 @@ void CoverUpdate::update(Actions& action) {
             "state=" + stateName +
             " position=" + tools::intToString(this->context.position));
 
-        std::vector<std::string> values{std::move(stateName)};
         if (this->context.position != noPosition) {
-            values.push_back(tools::intToString(this->context.position));
+            action.fire(
+                {stateName, tools::intToString(this->context.position)});
+        } else {
+            action.fire({stateName});
         }
-        action.fire(values);
 
         this->context.stateChanged = false;
     }
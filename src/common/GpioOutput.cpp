@@ -1,8 +1,9 @@
 #include "GpioOutput.hpp"
 
 #include <cstdlib>
+#include <limits>
 
-#include "tools/string.hpp"
+#include "../tools/string.hpp"
 
 namespace {
 
@@ -20,10 +21,11 @@ bool GpioOutput::getOutput() {
 }
 
 GpioOutput::GpioOutput(
-    std::ostream& debug, EspApi& esp, Rtc& rtc, uint8_t pin, bool defaultValue,
-    bool invert)
+    std::ostream& debug, EspApi& esp, TimerWheel& timers, Rtc& rtc,
+    uint8_t pin, bool defaultValue, bool invert)
     : debug(debug)
     , esp(esp)
+    , timers(timers)
     , rtc(rtc)
     , pin(pin)
     , rtcId(rtc.next())
@@ -51,7 +53,7 @@ void GpioOutput::execute(const std::string& command) {
     std::string commandName = tools::nextToken(command, ' ', position);
 
     if (commandName == "toggle") {
-        if (this->nextBlink != 0) {
+        if (this->blinkTimer.isActive()) {
             this->debug << "Cannot toggle while blinking." << std::endl;
         } else {
             toggle();
@@ -67,7 +69,7 @@ void GpioOutput::execute(const std::string& command) {
         if (this->blinkOn == 0 || this->blinkOff == 0) {
             clearBlink();
         } else {
-            this->nextBlink = this->esp.millis();
+            this->timers.startAfter(this->blinkTimer, 0);
         }
         return;
     }
@@ -86,11 +88,6 @@ void GpioOutput::execute(const std::string& command) {
 }
 
 void GpioOutput::update(Actions action) {
-    if (this->nextBlink != 0 && this->nextBlink <= this->esp.millis()) {
-        toggle();
-        this->nextBlink += this->value ? this->blinkOn : this->blinkOff;
-    }
-
     if (this->changed) {
         bool localValue = this->esp.digitalRead(this->pin);
         action.fire(
@@ -101,6 +98,18 @@ void GpioOutput::update(Actions action) {
     }
 }
 
+unsigned long GpioOutput::getNextUpdate() const {
+    return this->changed ? 0 : std::numeric_limits<unsigned long>::max();
+}
+
+void GpioOutput::blink() {
+    toggle();
+    // Counted from the previous deadline, so that blinking does not drift.
+    const int duration = this->value ? this->blinkOn : this->blinkOff;
+    this->timers.start(
+        this->blinkTimer, this->blinkTimer.getDeadline() + duration);
+}
+
 void GpioOutput::toggle() {
     this->value = !this->value;
     setValue();
@@ -108,8 +117,8 @@ void GpioOutput::toggle() {
 }
 
 void GpioOutput::clearBlink() {
-    if (this->nextBlink != 0) {
-        this->nextBlink = 0;
+    if (this->blinkTimer.isActive()) {
+        this->timers.cancel(this->blinkTimer);
         this->blinkOn = 0;
         this->blinkOff = 0;
         this->changed = true;
@@ -3,26 +3,30 @@
 
 #include <ostream>
 
-#include "common/EspApi.hpp"
-#include "common/Interface.hpp"
-#include "common/rtc.hpp"
+#include "EspApi.hpp"
+#include "Interface.hpp"
+#include "TimerWheel.hpp"
+#include "rtc.hpp"
 
 class GpioOutput : public Interface {
 public:
     GpioOutput(
-        std::ostream& debug, EspApi& esp, Rtc& rtc, uint8_t pin,
-        bool defaultValue, bool invert);
+        std::ostream& debug, EspApi& esp, TimerWheel& timers, Rtc& rtc,
+        uint8_t pin, bool defaultValue, bool invert);
 
     void start() override;
     void execute(const std::string& command) override;
     void update(Actions action) override;
+    unsigned long getNextUpdate() const override;
 
 private:
     std::ostream& debug;
     EspApi& esp;
+    TimerWheel& timers;
     Rtc& rtc;
 
     void toggle();
+    void blink();
     void setValue();
     void clearBlink();
     bool getOutput();
@@ -32,7 +36,7 @@ private:
     bool changed = false;
     bool value;
     bool invert;
-    unsigned long nextBlink = 0;
+    Timer blinkTimer{[this]() { this->blink(); }};
     int blinkOn = 0;
     int blinkOff = 0;
 };
@@ -10,6 +10,11 @@ public:
     virtual void start() = 0;
     virtual void execute(const std::string& command) = 0;
     virtual void update(Actions action) = 0;
+    // The time in milliseconds when update() next has something to do. It
+    // is asked again after every update and command, so it only needs to be
+    // correct until the next one. Interfaces that poll their inputs return
+    // 0, so they are updated in every loop.
+    virtual unsigned long getNextUpdate() const { return 0; }
     virtual ~Interface() {}
 };
 
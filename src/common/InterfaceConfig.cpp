@@ -1,6 +1,81 @@
 #include "InterfaceConfig.hpp"
 
+#include <functional>
+#include <queue>
+
 #include "Interface.hpp"  // IWYU pragma: keep
 
 InterfaceConfig::InterfaceConfig() = default;
 InterfaceConfig::~InterfaceConfig() {}
+
+InterfaceRegistry::InterfaceRegistry(
+    const std::vector<std::unique_ptr<InterfaceConfig>>& interfaces) {
+    this->interfaces.reserve(interfaces.size());
+    for (const auto& interface : interfaces) {
+        if (interface) {
+            this->interfaces.emplace(interface->name, interface.get());
+        }
+    }
+}
+
+InterfaceConfig* InterfaceRegistry::find(std::string_view name) const {
+    auto iterator = this->interfaces.find(name);
+    return iterator == this->interfaces.end() ? nullptr : iterator->second;
+}
+
+std::vector<const InterfaceConfig*> sortInterfaces(
+    std::vector<std::unique_ptr<InterfaceConfig>>& interfaces,
+    const std::vector<InterfaceDependency>& dependencies) {
+    std::unordered_map<const InterfaceConfig*, std::size_t> indices;
+    for (std::size_t i = 0; i < interfaces.size(); ++i) {
+        indices.emplace(interfaces[i].get(), i);
+    }
+
+    std::vector<std::vector<std::size_t>> dependents(interfaces.size());
+    std::vector<std::size_t> dependencyCounts(interfaces.size());
+    for (const auto& [from, to] : dependencies) {
+        auto fromIndex = indices.find(from);
+        auto toIndex = indices.find(to);
+        // An interface giving commands to itself does not affect the order.
+        if (fromIndex == indices.end() || toIndex == indices.end() ||
+            from == to) {
+            continue;
+        }
+        dependents[fromIndex->second].push_back(toIndex->second);
+        ++dependencyCounts[toIndex->second];
+    }
+
+    // Of the interfaces that can come next, the one that was first in the
+    // original order is taken.
+    std::priority_queue<
+        std::size_t, std::vector<std::size_t>, std::greater<std::size_t>>
+        ready;
+    for (std::size_t i = 0; i < interfaces.size(); ++i) {
+        if (dependencyCounts[i] == 0) {
+            ready.push(i);
+        }
+    }
+
+    std::vector<std::unique_ptr<InterfaceConfig>> result;
+    result.reserve(interfaces.size());
+    while (!ready.empty()) {
+        std::size_t index = ready.top();
+        ready.pop();
+        result.push_back(std::move(interfaces[index]));
+        for (std::size_t dependent : dependents[index]) {
+            if (--dependencyCounts[dependent] == 0) {
+                ready.push(dependent);
+            }
+        }
+    }
+
+    std::vector<const InterfaceConfig*> unordered;
+    for (auto& interface : interfaces) {
+        if (interface) {
+            unordered.push_back(interface.get());
+            result.push_back(std::move(interface));
+        }
+    }
+    interfaces = std::move(result);
+    return unordered;
+}
@@ -3,9 +3,15 @@
 
 #include <algorithm>
 #include <memory>
+#include <optional>
 #include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
+#include "../tools/slotVector.hpp"
+
 class Interface;
 class Action;
 
@@ -13,7 +19,12 @@ struct InterfaceConfig {
     std::string name;
     std::unique_ptr<Interface> interface;
     std::vector<std::shared_ptr<Action>> actions;
-    std::vector<std::string> storedValue;
+    // Most interfaces have at most three values, so they are kept inline.
+    tools::SlotVector<std::string, 3> storedValue;
+    // Incremented whenever storedValue changes.
+    unsigned generation = 0;
+    // The time in milliseconds when the interface last fired with a value.
+    std::optional<unsigned long> lastFired;
     bool hasExternalAction = false;
     bool hasInternalAction = false;
 
@@ -54,4 +65,38 @@ InterfaceConfig* findInterface(
     return &**iterator;
 }
 
+// Finds interfaces by name in constant time. Build it once after all the
+// interfaces are created and share it between parsers. The names of the
+// interfaces must not change while it is used.
+class InterfaceRegistry {
+public:
+    InterfaceRegistry() = default;
+    explicit InterfaceRegistry(
+        const std::vector<std::unique_ptr<InterfaceConfig>>& interfaces);
+
+    // If more interfaces have the same name, the first one is found.
+    InterfaceConfig* find(std::string_view name) const;
+
+private:
+    std::unordered_map<std::string_view, InterfaceConfig*> interfaces;
+};
+
+inline InterfaceConfig* findInterface(
+    const InterfaceRegistry& interfaces, const std::string& name) {
+    return interfaces.find(name);
+}
+
+// An action of the first interface gives commands to the second one.
+using InterfaceDependency =
+    std::pair<const InterfaceConfig*, const InterfaceConfig*>;
+
+// Orders the interfaces so that each one comes after the interfaces that give
+// it commands. When they are updated in this order, the state a command
+// causes is handled in the same loop as the command. Otherwise the order is
+// kept. Interfaces that cannot be ordered because of a cycle are put at the
+// end and returned.
+std::vector<const InterfaceConfig*> sortInterfaces(
+    std::vector<std::unique_ptr<InterfaceConfig>>& interfaces,
+    const std::vector<InterfaceDependency>& dependencies);
+
 #endif  // INTERFACECONFIG_HPP
@@ -0,0 +1,36 @@
+#include "KeepaliveInterface.hpp"
+
+#include <limits>
+
+KeepaliveInterface::KeepaliveInterface(
+    EspApi& esp, TimerWheel& timers, uint8_t pin, unsigned interval,
+    unsigned resetInterval)
+    : esp(esp)
+    , timers(timers)
+    , pin(pin)
+    , interval(interval)
+    , resetInterval(resetInterval) {
+    esp.pinMode(pin, GpioMode::input);
+    this->timers.startAfter(this->resetTimer, 0);
+}
+
+void KeepaliveInterface::start() {
+    this->reset();
+}
+
+void KeepaliveInterface::execute(const std::string& /*command*/) {}
+
+void KeepaliveInterface::update(Actions /*action*/) {}
+
+unsigned long KeepaliveInterface::getNextUpdate() const {
+    // Resets are done by the timer.
+    return std::numeric_limits<unsigned long>::max();
+}
+
+void KeepaliveInterface::reset() {
+    this->esp.pinMode(this->pin, GpioMode::output);
+    this->esp.digitalWrite(this->pin, 0);
+    this->esp.delay(this->resetInterval);
+    this->esp.pinMode(this->pin, GpioMode::input);
+    this->timers.startAfter(this->resetTimer, this->interval);
+}
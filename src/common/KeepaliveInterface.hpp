@@ -1,27 +1,31 @@
 #ifndef KEEPALIVEINTERFACE_HPP
 #define KEEPALIVEINTERFACE_HPP
 
-#include "common/EspApi.hpp"
-#include "common/Interface.hpp"
+#include "EspApi.hpp"
+#include "Interface.hpp"
+#include "TimerWheel.hpp"
 
 class KeepaliveInterface : public Interface {
 public:
     KeepaliveInterface(
-        EspApi& esp, uint8_t pin, unsigned interval, unsigned resetInterval);
+        EspApi& esp, TimerWheel& timers, uint8_t pin, unsigned interval,
+        unsigned resetInterval);
 
     void start() override;
     void execute(const std::string& command) override;
     void update(Actions action) override;
+    unsigned long getNextUpdate() const override;
 
 private:
     EspApi& esp;
+    TimerWheel& timers;
 
     void reset();
 
     const uint8_t pin;
     const unsigned interval;
     const unsigned resetInterval;
-    unsigned nextReset = 0;
+    Timer resetTimer{[this]() { this->reset(); }};
 };
 
 #endif  // KEEPALIVEINTERFACE_HPP
@@ -3,6 +3,9 @@
 #include <algorithm>
 #include <vector>
 
+#include "../operation/Memoized.hpp"
+#include "../operation/Profiled.hpp"
+#include "../tools/arena.hpp"
 #include "../tools/string.hpp"
 #include "Interface.hpp"
 
@@ -14,6 +17,7 @@ constexpr unsigned initialBackoff = 500;
 constexpr unsigned maxBackoff = 60000;
 constexpr unsigned statusSendInterval = 60000;
 constexpr unsigned availabilityReceiveTimeout = 2000;
+constexpr std::size_t profileSize = 5;
 
 }  // unnamed namespace
 
@@ -44,10 +48,39 @@ const char* MqttClient::getStatusMessage(bool restarted) {
     message["avgCycleTime"] = avgCycleTime;
     message["maxCycleTime"] = this->maxCycleTime;
 
+    const auto& cache = operation::Memoized::statistics;
+    if (cache.hits != 0 || cache.misses != 0) {
+        message["cacheHits"] = cache.hits;
+        message["cacheMisses"] = cache.misses;
+    }
+
+    auto arena = tools::Arena::getTotalStatistics();
+    if (arena.capacity != 0) {
+        message["configMemory"] = arena.capacity;
+        // Operations dropped by optimizing or by the limits of the parser
+        // still take space in the blocks.
+        message["configMemoryReleased"] = arena.released;
+    }
+
     message.printTo(this->statusMsg);
     return this->statusMsg;
 }
 
+std::string MqttClient::getProfileMessage() const {
+    DynamicJsonBuffer buffer{256};
+    JsonArray& message = buffer.createArray();
+    for (const operation::Profiled* profiled :
+         operation::Profiled::getTop(profileSize)) {
+        JsonObject& entry = message.createNestedObject();
+        entry["name"] = profiled->getName().c_str();
+        entry["count"] = profiled->getCount();
+        entry["micros"] = profiled->getMicros();
+    }
+    std::string result;
+    message.printTo(result);
+    return result;
+}
+
 void MqttClient::setConfig(MqttConfig config_) {
     this->config = std::move(config_);
 }
@@ -315,6 +348,16 @@ void MqttClient::sendStatusMessage(bool restarted) {
         }
     }
 
+    if (this->config.topics.profileTopic.length() != 0) {
+        std::string message = this->getProfileMessage();
+        if (!this->connection.publish(
+                MqttConnection::Message{
+                    this->config.topics.profileTopic.c_str(), message.c_str(),
+                    message.length(), false})) {
+            this->debug << "Failed to send profile." << std::endl;
+        }
+    }
+
     this->nextStatusSend +=
         ((now - this->nextStatusSend) / statusSendInterval + 1) *
         statusSendInterval;
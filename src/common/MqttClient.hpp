@@ -26,6 +26,9 @@ struct ServerConfig {
 struct TopicConfig {
     std::string availabilityTopic;
     std::string statusTopic;
+    // If set, actions are profiled and the slowest ones are sent here with
+    // the status message.
+    std::string profileTopic;
 };
 
 struct MqttConfig {
@@ -94,7 +97,7 @@ private:
     unsigned long cycles = 0;
 
     static constexpr size_t statusMsgBufSize = 350;
-    static constexpr size_t statusMsgSize = 250;
+    static constexpr size_t statusMsgSize = 330;
 
     ArduinoJson::StaticJsonBuffer<statusMsgBufSize> statusMsgBuf;
     char statusMsg[statusMsgSize];
@@ -102,6 +105,7 @@ private:
     std::vector<Subscription> subscriptions;
 
     const char* getStatusMessage(bool restarted);
+    std::string getProfileMessage() const;
     void availabiltyReceiveSuccess();
     const char* currentStateDebug() const;
     void availabiltyReceiveFail();
@@ -1,11 +1,15 @@
 #include "PowerSupplyInterface.hpp"
 
+#include <limits>
+
 PowerSupplyInterface::PowerSupplyInterface(
-    std::ostream& debug, EspApi& esp, uint8_t powerSwitchPin,
-    uint8_t resetSwitchPin, uint8_t powerCheckPin, unsigned pushTime,
-    unsigned forceOffTime, unsigned checkTime, const std::string& initialState)
+    std::ostream& debug, EspApi& esp, TimerWheel& timers,
+    uint8_t powerSwitchPin, uint8_t resetSwitchPin, uint8_t powerCheckPin,
+    unsigned pushTime, unsigned forceOffTime, unsigned checkTime,
+    const std::string& initialState)
     : debug(debug)
     , esp(esp)
+    , timers(timers)
     , powerSwitchPin(powerSwitchPin)
     , resetSwitchPin(resetSwitchPin)
     , powerCheckPin(powerCheckPin)
@@ -22,6 +26,9 @@ PowerSupplyInterface::PowerSupplyInterface(
     esp.pinMode(powerSwitchPin, GpioMode::input);
     esp.pinMode(resetSwitchPin, GpioMode::input);
     esp.pinMode(powerCheckPin, GpioMode::input);
+    if (this->targetState != TargetState::Dontcare) {
+        this->timers.startAfter(this->checkTimer, 0);
+    }
 }
 
 void PowerSupplyInterface::start() {}
@@ -39,66 +46,66 @@ void PowerSupplyInterface::execute(const std::string& command) {
     if (command == "on") {
         if (this->targetState != TargetState::On) {
             this->targetState = TargetState::On;
-            this->nextCheck = 0;
+            this->timers.startAfter(this->checkTimer, 0);
         }
         return;
     }
     if (command == "off") {
         if (this->targetState != TargetState::Off) {
             this->targetState = TargetState::Off;
-            this->nextCheck = 0;
+            this->timers.startAfter(this->checkTimer, 0);
         }
         return;
     }
     if (command == "dontcare") {
         this->targetState = TargetState::Dontcare;
+        this->timers.cancel(this->checkTimer);
         return;
     }
     if (command == "forceOff") {
         this->targetState = TargetState::Off;
+        if (!this->checkTimer.isActive()) {
+            this->timers.startAfter(this->checkTimer, this->checkTime);
+        }
         if (this->esp.digitalRead(this->powerCheckPin) != 0) {
             this->pullDown(this->powerSwitchPin);
-            this->powerButtonRelease = this->esp.millis() + this->forceOffTime;
+            this->timers.startAfter(
+                this->powerButtonTimer, this->forceOffTime);
         }
         return;
     }
     if (command == "reset") {
         if (this->targetState != TargetState::Dontcare) {
             this->targetState = TargetState::On;
-            this->nextCheck = 0;
+            this->timers.startAfter(this->checkTimer, 0);
         }
         if (this->esp.digitalRead(this->powerCheckPin) != 0) {
             this->pullDown(this->resetSwitchPin);
-            this->resetButtonRelease = this->esp.millis() + this->pushTime;
+            this->timers.startAfter(this->resetButtonTimer, this->pushTime);
         }
         return;
     }
 }
 
-void PowerSupplyInterface::update(Actions /*action*/) {
-    auto now = this->esp.millis();
-    if (this->powerButtonRelease != 0 && now > this->powerButtonRelease) {
-        this->debug << "power button release" << std::endl;
-        this->release(this->powerSwitchPin);
-        this->powerButtonRelease = 0;
-    }
-    if (this->resetButtonRelease != 0 && now > this->resetButtonRelease) {
-        this->debug << "reset button release" << std::endl;
-        this->release(this->resetSwitchPin);
-        this->resetButtonRelease = 0;
-    }
+void PowerSupplyInterface::update(Actions /*action*/) {}
 
-    if (this->targetState == TargetState::Dontcare || this->nextCheck >= now) {
+void PowerSupplyInterface::check() {
+    if (this->targetState == TargetState::Dontcare) {
         return;
     }
 
     this->debug << "check" << std::endl;
     if (this->esp.digitalRead(this->powerCheckPin) !=
             (this->targetState == TargetState::On ? 1 : 0) &&
-        this->powerButtonRelease == 0) {
+        !this->powerButtonTimer.isActive()) {
         this->debug << "power button press" << std::endl;
         this->pullDown(this->powerSwitchPin);
-        this->powerButtonRelease = this->esp.millis() + this->pushTime;
+        this->timers.startAfter(this->powerButtonTimer, this->pushTime);
     }
-    this->nextCheck = now + this->checkTime;
+    this->timers.startAfter(this->checkTimer, this->checkTime);
+}
+
+unsigned long PowerSupplyInterface::getNextUpdate() const {
+    // Everything is done by the timers.
+    return std::numeric_limits<unsigned long>::max();
 }
@@ -3,15 +3,17 @@
 
 #include <ostream>
 
-#include "common/EspApi.hpp"
-#include "common/Interface.hpp"
+#include "EspApi.hpp"
+#include "Interface.hpp"
+#include "TimerWheel.hpp"
 
 class PowerSupplyInterface : public Interface {
 public:
     enum class TargetState { Off, On, Dontcare };
 
     PowerSupplyInterface(
-        std::ostream& debug, EspApi& esp, uint8_t powerSwitchPin,
+        std::ostream& debug, EspApi& esp, TimerWheel& timers,
+        uint8_t powerSwitchPin,
         uint8_t resetSwitchPin, uint8_t powerCheckPin, unsigned pushTime,
         unsigned forceOffTime, unsigned checkTime,
         const std::string& initialState);
@@ -19,10 +21,12 @@ public:
     void start() override;
     void execute(const std::string& command) override;
     void update(Actions action) override;
+    unsigned long getNextUpdate() const override;
 
 private:
     std::ostream& debug;
     EspApi& esp;
+    TimerWheel& timers;
 
     const uint8_t powerSwitchPin;
     const uint8_t resetSwitchPin;
@@ -31,12 +35,19 @@ private:
     const unsigned forceOffTime;
     const unsigned checkTime;
     TargetState targetState;
-    unsigned nextCheck = 0;
-    unsigned powerButtonRelease = 0;
-    unsigned resetButtonRelease = 0;
+    Timer checkTimer{[this]() { this->check(); }};
+    Timer powerButtonTimer{[this]() {
+        this->debug << "power button release" << std::endl;
+        this->release(this->powerSwitchPin);
+    }};
+    Timer resetButtonTimer{[this]() {
+        this->debug << "reset button release" << std::endl;
+        this->release(this->resetSwitchPin);
+    }};
 
     void pullDown(uint8_t pin);
     void release(uint8_t pin);
+    void check();
 };
 
 #endif  // POWERSUPPLYINTERFACE_HPP
@@ -0,0 +1,105 @@
+#include "PublishAction.hpp"
+
+#include "../tools/fromString.hpp"
+#include "MqttClient.hpp"
+
+PublishAction::PublishAction(
+    std::ostream& debug, EspApi& esp, TimerWheel& timers,
+    MqttClient& mqttClient, const std::string& topic,
+    std::unique_ptr<operation::Operation>&& operation, bool retain,
+    unsigned minimumSendInterval, double sendDiff, bool publishLast)
+    : debug(debug)
+    , esp(esp)
+    , timers(timers)
+    , mqttClient(mqttClient)
+    , topic(topic)
+    , operation(std::move(operation))
+    , retain(retain)
+    , minimumSendInterval(minimumSendInterval)
+    , sendDiff(sendDiff)
+    , publishLast(publishLast)
+    , keepsState(this->operation->keepsState())
+    , lastSend(0) {}
+
+void PublishAction::reset() {
+    this->lastSend = 0;
+}
+
+void PublishAction::fire(const InterfaceConfig& /*interface*/) {
+    auto now = this->esp.millis();
+    std::string value;
+    std::optional<double> valueNum;
+    // Operations that keep a state, such as avg(), take a sample each time
+    // they are evaluated, so they are evaluated on each fire even if the
+    // value is not sent.
+    if (this->sendDiff != 0.0 || this->keepsState) {
+        value = this->operation->evaluate();
+        if (value.empty()) {
+            this->debug << "No value for " + this->topic << std::endl;
+            return;
+        }
+    }
+    if (this->sendDiff != 0.0) {
+        valueNum = tools::fromString<double>(value);
+        if (!valueNum.has_value()) {
+            this->debug << "Failed to parse numerical value: " << value
+                        << std::endl;
+        }
+    }
+
+    if (this->lastSend != 0 &&
+        now - this->lastSend < this->minimumSendInterval &&
+        (!valueNum.has_value() ||
+         (this->lastSentValue.has_value() &&
+          std::abs(*this->lastSentValue - *valueNum) < this->sendDiff))) {
+        this->debug << "Too soon, not sending." << std::endl;
+        if (this->publishLast) {
+            this->holdBack(std::move(value), valueNum);
+        }
+        return;
+    }
+
+    this->publish(now, std::move(value), valueNum);
+}
+
+void PublishAction::publish(
+    unsigned long now, std::string value, std::optional<double> valueNum) {
+    if (value.empty()) {
+        value = this->operation->evaluate();
+        if (value.empty()) {
+            this->debug << "No value for " + this->topic << std::endl;
+            return;
+        }
+    }
+
+    this->timers.cancel(this->deferredTimer);
+    this->mqttClient.publish(this->topic.c_str(), value.c_str(), this->retain);
+    this->lastSend = now;
+    this->lastSentValue = valueNum;
+}
+
+void PublishAction::holdBack(
+    std::string value, std::optional<double> valueNum) {
+    // The value is kept instead of evaluated again when it is published,
+    // because evaluating would add a sample to stateful operations such as
+    // avg() or changed().
+    if (value.empty()) {
+        value = this->operation->evaluate();
+        if (value.empty()) {
+            this->debug << "No value for " + this->topic << std::endl;
+            return;
+        }
+    }
+    this->heldBackValue = std::move(value);
+    this->heldBackValueNum = valueNum;
+    if (!this->deferredTimer.isActive()) {
+        this->timers.start(this->deferredTimer,
+            this->lastSend + this->minimumSendInterval);
+    }
+}
+
+void PublishAction::publishLastValue() {
+    std::string value;
+    value.swap(this->heldBackValue);
+    this->publish(this->esp.millis(), std::move(value), this->heldBackValueNum);
+}
@@ -0,0 +1,54 @@
+#ifndef PUBLISHACTION_HPP
+#define PUBLISHACTION_HPP
+
+#include <optional>
+#include <ostream>
+#include <string>
+
+#include "../operation/Operation.hpp"
+#include "Action.hpp"
+#include "EspApi.hpp"
+#include "MqttClient.hpp"
+#include "TimerWheel.hpp"
+
+// Publishes a value when fired. Values are not sent more often than
+// minimumSendInterval, unless they differ from the last sent one by at least
+// sendDiff. If publishLast is set, the last value that was held back is
+// published when the interval expires, so it is not lost.
+class PublishAction : public Action {
+public:
+    PublishAction(
+        std::ostream& debug, EspApi& esp, TimerWheel& timers,
+        MqttClient& mqttClient, const std::string& topic,
+        std::unique_ptr<operation::Operation>&& operation, bool retain,
+        unsigned minimumSendInterval, double sendDiff, bool publishLast);
+
+    void fire(const InterfaceConfig& interface) override;
+    void reset() override;
+
+private:
+    void publish(
+        unsigned long now, std::string value, std::optional<double> valueNum);
+    void holdBack(std::string value, std::optional<double> valueNum);
+    void publishLastValue();
+
+    std::ostream& debug;
+    EspApi& esp;
+    TimerWheel& timers;
+    MqttClient& mqttClient;
+
+    std::string topic;
+    std::unique_ptr<operation::Operation> operation;
+    bool retain;
+    const unsigned minimumSendInterval;
+    const double sendDiff;
+    const bool publishLast;
+    const bool keepsState;
+    unsigned lastSend;
+    std::optional<double> lastSentValue;
+    std::string heldBackValue;
+    std::optional<double> heldBackValueNum;
+    Timer deferredTimer{[this]() { this->publishLastValue(); }};
+};
+
+#endif  // PUBLISHACTION_HPP
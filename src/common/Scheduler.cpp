@@ -0,0 +1,34 @@
+#include "Scheduler.hpp"
+
+#include <algorithm>
+
+#include "CoalescedAction.hpp"
+#include "Interface.hpp"
+
+unsigned long Scheduler::update(
+    const std::vector<std::unique_ptr<InterfaceConfig>>& interfaces) {
+    this->timers.update();
+
+    const unsigned long now = this->esp.millis();
+    unsigned long next = now + this->maxSleep;
+    for (const auto& interface : interfaces) {
+        if (interface->interface->getNextUpdate() <= now) {
+            interface->interface->update(Actions{*interface, this->esp});
+            ++this->updateCount;
+        } else {
+            ++this->skipCount;
+        }
+        next = std::min(next, interface->interface->getNextUpdate());
+    }
+    next = std::min(next, this->timers.getNextUpdate());
+
+    // The values of all interfaces are up to date now. The commands these
+    // actions give are handled in the next loop, so it comes right away.
+    if (CoalescedAction::firePending()) {
+        next = now;
+    }
+
+    // Updates may take time, so the sleep is counted from the end of them.
+    const unsigned long end = this->esp.millis();
+    return next > end ? std::min(next - end, this->maxSleep) : 1;
+}
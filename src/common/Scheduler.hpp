@@ -0,0 +1,37 @@
+#ifndef COMMON_SCHEDULER_HPP
+#define COMMON_SCHEDULER_HPP
+
+#include <memory>
+#include <vector>
+
+#include "EspApi.hpp"
+#include "InterfaceConfig.hpp"
+#include "TimerWheel.hpp"
+
+// Runs the timers that are due, updates only the interfaces that have
+// something to do and fires the coalesced actions, then tells how long the
+// main loop can sleep until the next interface has something to do. The
+// sleep is limited by maxSleep, so that the network is still served often
+// enough.
+class Scheduler {
+public:
+    Scheduler(EspApi& esp, TimerWheel& timers, unsigned long maxSleep)
+        : esp(esp), timers(timers), maxSleep(maxSleep) {}
+
+    // Returns the time to sleep in milliseconds, at least 1.
+    unsigned long update(
+        const std::vector<std::unique_ptr<InterfaceConfig>>& interfaces);
+
+    // The number of updates done and skipped so far.
+    unsigned long getUpdateCount() const { return this->updateCount; }
+    unsigned long getSkipCount() const { return this->skipCount; }
+
+private:
+    EspApi& esp;
+    TimerWheel& timers;
+    const unsigned long maxSleep;
+    unsigned long updateCount = 0;
+    unsigned long skipCount = 0;
+};
+
+#endif  // COMMON_SCHEDULER_HPP
@@ -1,10 +1,14 @@
 #include "SensorInterface.hpp"
 
+#include <limits>
+
 SensorInterface::SensorInterface(
-    std::ostream& debug, EspApi& esp, std::unique_ptr<Sensor>&& sensor,
-    std::string name, int interval, int offset, std::vector<std::string> pulse)
+    std::ostream& debug, EspApi& esp, TimerWheel& timers,
+    std::unique_ptr<Sensor>&& sensor, std::string name, int interval,
+    int offset, std::vector<std::string> pulse)
     : debug(debug)
     , esp(esp)
+    , timers(timers)
     , sensor(std::move(sensor))
     , name(std::move(name))
     , interval(interval)
@@ -21,6 +25,7 @@ void SensorInterface::start() {
     } else {
         this->nextExecution = 1;
     }
+    this->timers.start(this->executionTimer, this->nextExecution);
     this->needToReset = true;
 }
 
@@ -28,28 +33,30 @@ void SensorInterface::execute(const std::string& /*command*/) {}
 
 void SensorInterface::update(Actions action) {
     auto now = this->esp.millis();
-    if ((this->nextExecution != 0 && now >= this->nextExecution) ||
-        (this->nextRetry != 0 && now >= this->nextRetry)) {
+    if (this->executionDue || this->retryDue) {
         auto values = this->sensor->measure();
         if (!values) {
             return;
         }
-        if (now >= this->nextExecution) {
+        if (this->executionDue) {
             this->nextExecution +=
                 ((now - this->nextExecution) / this->interval + 1) *
                 this->interval;
+            this->timers.start(this->executionTimer, this->nextExecution);
+            this->executionDue = false;
         }
+        this->retryDue = false;
         this->debug << this->name;
         if (values->empty()) {
             this->debug << ": Measurement failed. Trying again." << std::endl;
-            this->nextRetry = now + 1000;
+            this->timers.start(this->retryTimer, now + 1000);
         } else {
             this->debug << ": Measurement successful:";
             for (const std::string& value : *values) {
                 this->debug << " " << value;
             }
             this->debug << std::endl;
-            this->nextRetry = 0;
+            this->timers.cancel(this->retryTimer);
 
             if (this->needToReset) {
                 action.reset();
@@ -66,3 +73,12 @@ void SensorInterface::update(Actions action) {
         }
     }
 }
+
+unsigned long SensorInterface::getNextUpdate() const {
+    // Measurements are started by the timers.
+    if (this->executionDue || this->retryDue ||
+        (!this->pulse.empty() && !this->pulseSent)) {
+        return 0;
+    }
+    return std::numeric_limits<unsigned long>::max();
+}
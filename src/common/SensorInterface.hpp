@@ -7,28 +7,36 @@
 #include "EspApi.hpp"
 #include "Interface.hpp"
 #include "Sensor.hpp"
+#include "TimerWheel.hpp"
 
 class SensorInterface : public Interface {
 public:
     SensorInterface(
-        std::ostream& debug, EspApi& esp, std::unique_ptr<Sensor>&& sensor,
-        std::string name, int interval, int offset,
-        std::vector<std::string> pulse);
+        std::ostream& debug, EspApi& esp, TimerWheel& timers,
+        std::unique_ptr<Sensor>&& sensor, std::string name, int interval,
+        int offset, std::vector<std::string> pulse);
 
     void start() override;
     void execute(const std::string& command) override;
     void update(Actions action) override;
+    unsigned long getNextUpdate() const override;
 
 private:
     std::ostream& debug;
     EspApi& esp;
+    TimerWheel& timers;
 
     std::unique_ptr<Sensor> sensor;
     std::string name;
     int interval;
     int offset;
+    // The next measurement is scheduled from this, so that the time of the
+    // measurements does not drift.
     unsigned long nextExecution = 0;
-    unsigned long nextRetry = 0;
+    bool executionDue = false;
+    bool retryDue = false;
+    Timer executionTimer{[this]() { this->executionDue = true; }};
+    Timer retryTimer{[this]() { this->retryDue = true; }};
     std::vector<std::string> pulse;
     bool pulseSent = true;
     bool needToReset = false;
@@ -0,0 +1,19 @@
+#include "TimedAction.hpp"
+
+void TimedAction::fire(const InterfaceConfig& interface) {
+    this->interface = &interface;
+    this->action->fire(interface);
+    this->schedule();
+}
+
+void TimedAction::reset() {
+    this->action->reset();
+}
+
+void TimedAction::schedule() {
+    if (auto next = this->operation.getNextChange(this->esp.millis())) {
+        this->timers.start(this->timer, *next);
+    } else {
+        this->timers.cancel(this->timer);
+    }
+}
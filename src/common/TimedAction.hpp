@@ -0,0 +1,44 @@
+#ifndef COMMON_TIMEDACTION_HPP
+#define COMMON_TIMEDACTION_HPP
+
+#include <memory>
+
+#include "../operation/Operation.hpp"
+#include "Action.hpp"
+#include "EspApi.hpp"
+#include "TimerWheel.hpp"
+
+// Fires an action again when the value of its operation may change with the
+// time alone. An action is otherwise only fired when an interface it uses
+// fires, so a rule such as "since([motion]) >= 5m" would not be evaluated
+// when the 5 minutes pass.
+class TimedAction : public Action {
+public:
+    // The operation is owned by the action.
+    TimedAction(
+        std::unique_ptr<Action> action, operation::Operation& operation,
+        EspApi& esp, TimerWheel& timers)
+        : action(std::move(action))
+        , operation(operation)
+        , esp(esp)
+        , timers(timers) {}
+
+    void fire(const InterfaceConfig& interface) override;
+    void reset() override;
+
+private:
+    void schedule();
+
+    std::unique_ptr<Action> action;
+    operation::Operation& operation;
+    EspApi& esp;
+    TimerWheel& timers;
+    // The interface that fired it last, to fire it with again.
+    const InterfaceConfig* interface = nullptr;
+    Timer timer{[this]() {
+        this->action->fire(*this->interface);
+        this->schedule();
+    }};
+};
+
+#endif  // COMMON_TIMEDACTION_HPP
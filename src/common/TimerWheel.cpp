@@ -0,0 +1,152 @@
+#include "TimerWheel.hpp"
+
+#include <limits>
+
+Timer::~Timer() {
+    if (this->wheel) {
+        this->wheel->cancel(*this);
+    }
+}
+
+TimerWheel::TimerWheel(EspApi& esp) : esp(esp), current(esp.millis()) {}
+
+TimerWheel::~TimerWheel() {
+    for (auto& level : this->slots) {
+        for (Slot& slot : level) {
+            while (slot.next != &slot) {
+                Timer& timer = static_cast<Timer&>(*slot.next);
+                unlink(timer);
+                timer.wheel = nullptr;
+            }
+        }
+    }
+}
+
+void TimerWheel::start(Timer& timer, unsigned long deadline) {
+    if (timer.wheel) {
+        this->cancel(timer);
+    }
+    const unsigned long now = this->esp.millis();
+    if (this->count == 0 && isBefore(this->current, now)) {
+        // Nothing is waiting, so the empty slots need not be stepped through.
+        this->current = now;
+    }
+    if (isBefore(deadline, this->current)) {
+        deadline = this->current;
+    }
+    timer.deadline = deadline;
+    timer.wheel = this;
+    ++this->count;
+    this->insert(timer);
+}
+
+void TimerWheel::cancel(Timer& timer) {
+    if (timer.wheel != this) {
+        return;
+    }
+    unlink(timer);
+    timer.wheel = nullptr;
+    --this->count;
+}
+
+void TimerWheel::update() {
+    const unsigned long now = this->esp.millis();
+    while (this->count != 0 && !isBefore(now, this->current)) {
+        for (unsigned level = levelCount - 1; level != 0; --level) {
+            if ((this->current & ((1ul << (level * slotBits)) - 1)) == 0) {
+                this->cascade(level);
+            }
+        }
+
+        // The timers are taken out of the slot before the callbacks are
+        // called, so a timer started again for now fires in the next update.
+        Slot due;
+        move(this->slots[0][this->current & slotMask], due);
+        ++this->current;
+        while (due.next != &due) {
+            Timer& timer = static_cast<Timer&>(*due.next);
+            this->cancel(timer);
+            timer.callback();
+        }
+    }
+    if (this->count == 0 && !isBefore(now, this->current)) {
+        this->current = now + 1;
+    }
+}
+
+unsigned long TimerWheel::getNextUpdate() const {
+    if (this->count == 0) {
+        return std::numeric_limits<unsigned long>::max();
+    }
+    // At the start of each round of the lowest level, the higher levels may
+    // have timers to move down.
+    if ((this->current & slotMask) == 0) {
+        return this->current;
+    }
+    unsigned long time = this->current;
+    for (; (time & slotMask) != 0; ++time) {
+        const Slot& slot = this->slots[0][time & slotMask];
+        if (slot.next != &slot) {
+            return time;
+        }
+    }
+    return time;
+}
+
+bool TimerWheel::isBefore(unsigned long lhs, unsigned long rhs) {
+    return static_cast<long>(lhs - rhs) < 0;
+}
+
+void TimerWheel::link(Slot& slot, Timer& timer) {
+    timer.previous = slot.previous;
+    timer.next = &slot;
+    slot.previous->next = &timer;
+    slot.previous = &timer;
+}
+
+void TimerWheel::unlink(detail::TimerNode& node) {
+    node.previous->next = node.next;
+    node.next->previous = node.previous;
+    node.previous = &node;
+    node.next = &node;
+}
+
+void TimerWheel::move(Slot& from, Slot& to) {
+    if (from.next == &from) {
+        return;
+    }
+    to.next = from.next;
+    to.previous = from.previous;
+    to.next->previous = &to;
+    to.previous->next = &to;
+    from.next = &from;
+    from.previous = &from;
+}
+
+void TimerWheel::insert(Timer& timer) {
+    unsigned long delta = timer.deadline - this->current;
+    unsigned long deadline = timer.deadline;
+    unsigned level = 0;
+    while (level < levelCount - 1 &&
+           delta >= (1ul << ((level + 1) * slotBits))) {
+        ++level;
+    }
+    if (delta >= (1ul << (levelCount * slotBits))) {
+        // Too far for the highest level. It is put in the last slot and
+        // inserted again when that slot is moved down.
+        deadline = this->current + (1ul << (levelCount * slotBits)) - 1;
+    }
+    link(this->slots[level][(deadline >> (level * slotBits)) & slotMask],
+        timer);
+}
+
+void TimerWheel::cascade(unsigned level) {
+    Slot timers;
+    move(this->slots[level][(this->current >> (level * slotBits)) & slotMask],
+        timers);
+    while (timers.next != &timers) {
+        Timer& timer = static_cast<Timer&>(*timers.next);
+        unlink(timer);
+        this->insert(timer);
+    }
+}
@@ -0,0 +1,105 @@
+#ifndef COMMON_TIMERWHEEL_HPP
+#define COMMON_TIMERWHEEL_HPP
+
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <utility>
+
+#include "EspApi.hpp"
+
+class TimerWheel;
+
+namespace detail {
+
+// An element of a circular list of timers.
+struct TimerNode {
+    TimerNode* previous = this;
+    TimerNode* next = this;
+};
+
+}  // namespace detail
+
+// A callback that a TimerWheel calls at a given time. It is usually a member
+// of the object it belongs to, and it is cancelled when destroyed.
+class Timer : private detail::TimerNode {
+public:
+    explicit Timer(std::function<void()> callback)
+        : callback(std::move(callback)) {}
+    ~Timer();
+
+    Timer(const Timer&) = delete;
+    Timer& operator=(const Timer&) = delete;
+
+    bool isActive() const { return this->wheel != nullptr; }
+    unsigned long getDeadline() const { return this->deadline; }
+
+private:
+    std::function<void()> callback;
+    TimerWheel* wheel = nullptr;
+    unsigned long deadline = 0;
+
+    friend class TimerWheel;
+};
+
+// Runs timers from the main loop with a resolution of 1 ms. Starting and
+// cancelling a timer takes constant time. Timers that are due are found by
+// stepping through the slots of the lowest level, and the higher levels are
+// moved down when the lower level wraps around, so there is no need to look
+// at every timer in every loop.
+//
+// Times are compared by their difference, so timers keep working when
+// millis() wraps around, as long as they are less than half of the range of
+// unsigned long away.
+class TimerWheel {
+public:
+    explicit TimerWheel(EspApi& esp);
+    ~TimerWheel();
+
+    TimerWheel(const TimerWheel&) = delete;
+    TimerWheel& operator=(const TimerWheel&) = delete;
+
+    // Starts the timer, or moves it if it is already running. A deadline in
+    // the past makes it fire at the next update.
+    void start(Timer& timer, unsigned long deadline);
+    void startAfter(Timer& timer, unsigned long delay) {
+        this->start(timer, this->esp.millis() + delay);
+    }
+    void cancel(Timer& timer);
+
+    // Calls the callbacks of the timers that are due. They may start and
+    // cancel timers, including themselves.
+    void update();
+
+    // The time when update() next has something to do. It may be earlier
+    // than the deadline of any timer, when a higher level needs to be moved
+    // down. If there are no timers, it is the largest possible time.
+    unsigned long getNextUpdate() const;
+
+    std::size_t size() const { return this->count; }
+
+private:
+    static constexpr unsigned slotBits = 6;
+    static constexpr unsigned slotCount = 1 << slotBits;
+    static constexpr unsigned slotMask = slotCount - 1;
+    static constexpr unsigned levelCount = 4;
+
+    using Slot = detail::TimerNode;
+
+    static bool isBefore(unsigned long lhs, unsigned long rhs);
+    static void link(Slot& slot, Timer& timer);
+    static void unlink(detail::TimerNode& node);
+    // Moves the timers of a slot to another list.
+    static void move(Slot& from, Slot& to);
+
+    void insert(Timer& timer);
+    void cascade(unsigned level);
+
+    EspApi& esp;
+    std::array<std::array<Slot, slotCount>, levelCount> slots;
+    // The next millisecond to process.
+    unsigned long current;
+    std::size_t count = 0;
+};
+
+#endif  // COMMON_TIMERWHEEL_HPP
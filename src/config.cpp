@@ -17,41 +17,52 @@
 #include "EspAnalogInput.hpp"
 #include "EspEncoder.hpp"
 #include "GpioInput.hpp"
-#include "GpioOutput.hpp"
 #include "HM3301Sensor.hpp"
 #include "Hlw8012Interface.hpp"
 #include "JsonParser.hpp"
-#include "KeepaliveInterface.hpp"
 #include "Mcp3008AnalogInput.hpp"
 #include "MqttInterface.hpp"
-#include "PowerSupplyInterface.hpp"
-#include "PublishAction.hpp"
 #include "PwmOutput.hpp"
 #include "StatusInterface.hpp"
 #include "common/AnalogInput.hpp"
 #include "common/AnalogInputWithChannel.hpp"
 #include "common/AnalogSensor.hpp"
 #include "common/ArduinoJson.hpp"
+#include "common/CoalescedAction.hpp"
 #include "common/CommandAction.hpp"
 #include "common/Cover.hpp"
+#include "common/GpioOutput.hpp"
+#include "common/KeepaliveInterface.hpp"
 #include "common/MqttClient.hpp"
+#include "common/PowerSupplyInterface.hpp"
+#include "common/PublishAction.hpp"
 #include "common/SensorInterface.hpp"
+#include "common/TimedAction.hpp"
+#include "operation/Memoized.hpp"
 #include "operation/OperationParser.hpp"
 #include "operation/OperationParser2.hpp"
+#include "operation/Precompiled.hpp"
+#include "operation/Profiled.hpp"
+#include "tools/arena.hpp"
 #include "tools/collection.hpp"
 
 using namespace ArduinoJson;
 
 namespace {
 
+// Operations and actions live until restart, so they are allocated together.
+// It is destroyed after deviceConfig.
+tools::Arena configArena{2048};
+
 class ConfigParser {
 public:
     ConfigParser(
-        std::ostream& debug, DebugStreambuf& debugStream, EspApi& esp, Rtc& rtc,
-        MqttClient& mqttClient)
+        std::ostream& debug, DebugStreambuf& debugStream, EspApi& esp,
+        TimerWheel& timers, Rtc& rtc, MqttClient& mqttClient)
         : debug(debug)
         , debugStream(debugStream)
         , esp(esp)
+        , timers(timers)
         , rtc(rtc)
         , mqttClient(mqttClient)
         , jsonParser(debug) {}
@@ -59,7 +70,14 @@ public:
     void parse() {
         SPIFFS.begin();
 
-        deviceConfig = readDeviceConfig("/device_config.json");
+        {
+            tools::Arena::Scope arenaScope{configArena};
+            deviceConfig = readDeviceConfig("/device_config.json");
+        }
+        const auto& statistics = configArena.getStatistics();
+        debug << "Configuration uses " << statistics.used << " bytes in "
+              << statistics.blocks << " blocks, " << statistics.released
+              << " bytes of them released." << std::endl;
         globalConfig = readGlobalConfig("/global_config.json");
     }
 
@@ -67,10 +85,12 @@ private:
     std::ostream& debug;
     DebugStreambuf& debugStream;
     EspApi& esp;
+    TimerWheel& timers;
     Rtc& rtc;
     MqttClient& mqttClient;
 
     JsonParser jsonParser;
+    bool profile = false;
 
     std::unordered_map<std::string, std::shared_ptr<AnalogInput>> analogInputs;
 
@@ -216,8 +236,9 @@ private:
     std::unique_ptr<Interface> createSensorInterface(
         const JsonObject& data, std::unique_ptr<Sensor>&& sensor) {
         return std::make_unique<SensorInterface>(
-            debug, esp, std::move(sensor), data.get<std::string>("name"),
-            getInterval(data), getOffset(data), getPulse(data));
+            debug, esp, timers, std::move(sensor),
+            data.get<std::string>("name"), getInterval(data), getOffset(data),
+            getPulse(data));
     }
 
     GpioInput::CycleType getCycleType(const std::string& value) {
@@ -244,7 +265,7 @@ private:
         } else if (type == "output") {
             uint8_t pin = 0;
             return getPin(data, pin) ? std::make_unique<GpioOutput>(
-                                           debug, esp, rtc, pin,
+                                           debug, esp, timers, rtc, pin,
                                            data["default"], data["invert"])
                                      : nullptr;
         } else if (type == "pwm") {
@@ -323,8 +344,8 @@ private:
             uint8_t pin = 0;
             return getPin(data, pin)
                        ? std::make_unique<CounterInterface>(
-                             debug, esp, data.get<std::string>("name"), pin,
-                             getJsonWithDefault(data["bounceTime"], 0),
+                             debug, esp, timers, data.get<std::string>("name"),
+                             pin, getJsonWithDefault(data["bounceTime"], 0),
                              getJsonWithDefault(data["multiplier"], 1.0f),
                              getInterval(data), getOffset(data), getPulse(data))
                        : nullptr;
@@ -352,7 +373,7 @@ private:
             uint8_t pin = 0;
             return getPin(data, pin)
                        ? std::make_unique<KeepaliveInterface>(
-                             esp, pin,
+                             esp, timers, pin,
                              getJsonWithDefault(data["interval"], 10000),
                              getJsonWithDefault(data["resetInterval"], 10))
                        : nullptr;
@@ -364,8 +385,8 @@ private:
                     getRequiredValue(data, "resetSwitchPin", resetSwitchPin) &&
                     getRequiredValue(data, "powerCheckPin", powerCheckPin))
                        ? std::make_unique<PowerSupplyInterface>(
-                             debug, esp, powerSwitchPin, resetSwitchPin,
-                             powerCheckPin,
+                             debug, esp, timers, powerSwitchPin,
+                             resetSwitchPin, powerCheckPin,
                              getJsonWithDefault(data["pushTime"], 200),
                              getJsonWithDefault(data["forceOffTime"], 6000),
                              getJsonWithDefault(data["checkTime"], 60000),
@@ -527,33 +548,60 @@ private:
         return result;
     }
 
-    std::pair<
-        std::unique_ptr<operation::Operation>,
-        std::unordered_set<InterfaceConfig*>>
-    parseOperation(
-        const std::vector<std::unique_ptr<InterfaceConfig>>& interfaces,
-        InterfaceConfig* defaultInterface, const ArduinoJson::JsonObject& data,
-        const char* fieldName, const char* templateFieldName) {
+    struct ParsedOperation {
+        std::unique_ptr<operation::Operation> operation;
+        std::unordered_set<InterfaceConfig*> usedInterfaces;
+        // Whether the value may change with the time alone.
+        bool readsTime = false;
+    };
+
+    ParsedOperation parseOperation(
+        const InterfaceRegistry& interfaces, InterfaceConfig* defaultInterface,
+        const ArduinoJson::JsonObject& data, const char* fieldName,
+        const char* templateFieldName, const std::string& name) {
+        std::unique_ptr<operation::Operation> operation;
+        std::unordered_set<InterfaceConfig*> usedInterfaces;
+        bool readsTime = false;
         if (data[fieldName].is<std::string>()) {
-            operation::Parser2 parser{debug, interfaces, defaultInterface};
-            auto operation = parser.parse(data.get<std::string>(fieldName));
-            auto usedInterfaces = std::move(parser).getUsedInterfaces();
-            return {std::move(operation), std::move(usedInterfaces)};
+            std::string expression = data.get<std::string>(fieldName);
+            if (auto precompiled = operation::Precompiled::find(
+                    interfaces, defaultInterface, expression)) {
+                usedInterfaces.insert(
+                    precompiled->getInterfaces().begin(),
+                    precompiled->getInterfaces().end());
+                operation = std::move(precompiled);
+            } else {
+                operation::Parser2 parser{
+                    debug, interfaces, defaultInterface, &esp};
+                operation = parser.parse(expression);
+                readsTime = parser.readsTime();
+                usedInterfaces = std::move(parser).getUsedInterfaces();
+            }
         } else {
             operation::Parser parser{interfaces, defaultInterface};
-            auto operation = parser.parse(data, fieldName, templateFieldName);
-            auto usedInterfaces = std::move(parser).getUsedInterfaces();
-            return {std::move(operation), std::move(usedInterfaces)};
+            operation = parser.parse(data, fieldName, templateFieldName);
+            usedInterfaces = std::move(parser).getUsedInterfaces();
+        }
+        if (operation) {
+            operation = operation::memoize(std::move(operation));
+            if (profile) {
+                operation = operation::profile(
+                    std::move(operation), esp, name, false);
+            }
         }
+        return {std::move(operation), std::move(usedInterfaces), readsTime};
     }
 
     std::pair<std::unique_ptr<Action>, std::unordered_set<InterfaceConfig*>>
     parseAction(
         JsonObject& data, InterfaceConfig* defaultInterface,
-        std::vector<std::unique_ptr<InterfaceConfig>>& interfaces) {
+        const InterfaceRegistry& interfaces) {
         auto type = data.get<std::string>("type");
         std::unique_ptr<Action> result;
         std::unordered_set<InterfaceConfig*> usedInterfaces;
+        // The operation of the action, if it has to be fired again as the
+        // time passes.
+        operation::Operation* timedOperation = nullptr;
         bool InterfaceConfig::* actionType = nullptr;
         if (type == "publish") {
             std::string topic = getMandatoryArgument(data, "topic");
@@ -563,14 +611,18 @@ private:
             if (!data["payload"].success() && !data["template"].success()) {
                 data.set("template", "%1");
             }
-            auto [operation, parsedInterfaces] = parseOperation(
-                interfaces, defaultInterface, data, "payload", "template");
+            auto [operation, parsedInterfaces, readsTime] = parseOperation(
+                interfaces, defaultInterface, data, "payload", "template",
+                topic);
             usedInterfaces = std::move(parsedInterfaces);
+            if (readsTime) {
+                timedOperation = operation.get();
+            }
             result = std::make_unique<PublishAction>(
-                debug, esp, mqttClient, topic, std::move(operation),
+                debug, esp, timers, mqttClient, topic, std::move(operation),
                 data.get<bool>("retain"),
                 data.get<unsigned>("minimumSendInterval"),
-                data.get<double>("sendDiff"));
+                data.get<double>("sendDiff"), data.get<bool>("publishLast"));
             actionType = &InterfaceConfig::hasExternalAction;
         } else if (type == "command") {
             const std::string targetName = data["target"];
@@ -580,9 +632,13 @@ private:
                 return {};
             }
 
-            auto [operation, parsedInterfaces] = parseOperation(
-                interfaces, defaultInterface, data, "command", "template");
+            auto [operation, parsedInterfaces, readsTime] = parseOperation(
+                interfaces, defaultInterface, data, "command", "template",
+                targetName);
             usedInterfaces = std::move(parsedInterfaces);
+            if (readsTime) {
+                timedOperation = operation.get();
+            }
             result = std::make_unique<CommandAction>(
                 *target->interface, std::move(operation));
             actionType = &InterfaceConfig::hasInternalAction;
@@ -590,6 +646,11 @@ private:
             debug << "Invalid action type: " + type << std::endl;
         }
 
+        if (result && timedOperation) {
+            result = std::make_unique<TimedAction>(
+                std::move(result), *timedOperation, esp, timers);
+        }
+
         if (actionType != nullptr) {
             defaultInterface->*actionType = true;
             for (auto& interface : usedInterfaces) {
@@ -600,13 +661,14 @@ private:
         return {std::move(result), std::move(usedInterfaces)};
     }
 
-    void parseActions(
-        JsonObject& data,
-        std::vector<std::unique_ptr<InterfaceConfig>>& interfaces) {
+    // Returns which interfaces give commands to which.
+    std::vector<InterfaceDependency> parseActions(
+        JsonObject& data, const InterfaceRegistry& interfaces) {
+        std::vector<InterfaceDependency> dependencies;
         const JsonArray& actions = data["actions"];
         if (actions == JsonArray::invalid()) {
             debug << "Could not parse actions." << std::endl;
-            return;
+            return dependencies;
         }
 
         for (JsonObject& action : actions) {
@@ -615,6 +677,10 @@ private:
 
             auto parseResult =
                 parseAction(action, defaultInterface, interfaces);
+            if (parseResult.first && action.get<bool>("coalesce")) {
+                parseResult.first = std::make_unique<CoalescedAction>(
+                    std::move(parseResult.first));
+            }
             std::shared_ptr<Action> parsedAction = std::move(parseResult.first);
             auto&& usedInterfaces = parseResult.second;
             if (!parsedAction) {
@@ -625,10 +691,19 @@ private:
             if (defaultInterface) {
                 usedInterfaces.insert(defaultInterface);
             }
+            const InterfaceConfig* target = nullptr;
+            if (action.get<std::string>("type") == "command") {
+                target = findInterface(
+                    interfaces, action.get<std::string>("target"));
+            }
             for (auto& interface : usedInterfaces) {
                 interface->actions.push_back(parsedAction);
+                if (target) {
+                    dependencies.emplace_back(interface, target);
+                }
             }
         }
+        return dependencies;
     }
 
     DeviceConfig readDeviceConfig(const char* filename) {
@@ -661,10 +736,28 @@ private:
         PARSE(jsonParser, *data.root, result, name);
         PARSE(jsonParser, *data.root, result.topics, availabilityTopic);
         PARSE(jsonParser, *data.root, result.topics, statusTopic);
+        PARSE(jsonParser, *data.root, result.topics, profileTopic);
+        profile = !result.topics.profileTopic.empty();
 
         parseAnalogInputs(*data.root);
         parseInterfaces(*data.root, result.interfaces);
-        parseActions(*data.root, result.interfaces);
+        auto dependencies =
+            parseActions(*data.root, InterfaceRegistry{result.interfaces});
+        auto unordered = sortInterfaces(result.interfaces, dependencies);
+        if (!unordered.empty()) {
+            debug << "Commands form a cycle, these interfaces may take more "
+                     "than one loop to update:";
+            for (const InterfaceConfig* interface : unordered) {
+                debug << " " << interface->name;
+            }
+            debug << std::endl;
+        }
+
+        const auto& expressions = operation::Parser2::getStatistics();
+        debug << "Expressions: " << expressions.expressions
+              << ", nodes = " << expressions.nodes
+              << ", bytes = " << expressions.bytes
+              << ", deepest = " << expressions.depth << std::endl;
 
         return result;
     }
@@ -676,7 +769,7 @@ GlobalConfig globalConfig;
 DeviceConfig deviceConfig;
 
 void initConfig(
-    std::ostream& debug, DebugStreambuf& debugStream, EspApi& esp, Rtc& rtc,
-    MqttClient& mqttClient) {
-    ConfigParser(debug, debugStream, esp, rtc, mqttClient).parse();
+    std::ostream& debug, DebugStreambuf& debugStream, EspApi& esp,
+    TimerWheel& timers, Rtc& rtc, MqttClient& mqttClient) {
+    ConfigParser(debug, debugStream, esp, timers, rtc, mqttClient).parse();
 }
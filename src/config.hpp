@@ -9,6 +9,7 @@
 #include "common/EspApi.hpp"
 #include "common/InterfaceConfig.hpp"
 #include "common/MqttClient.hpp"
+#include "common/TimerWheel.hpp"
 #include "common/rtc.hpp"
 
 class DebugStreambuf;
@@ -39,7 +40,7 @@ extern GlobalConfig globalConfig;
 extern DeviceConfig deviceConfig;
 
 void initConfig(
-    std::ostream& debug, DebugStreambuf& debugStream, EspApi& esp, Rtc& rtc,
-    MqttClient& mqttClient);
+    std::ostream& debug, DebugStreambuf& debugStream, EspApi& esp,
+    TimerWheel& timers, Rtc& rtc, MqttClient& mqttClient);
 
 #endif  // CONFIG_HPP
@@ -18,6 +18,8 @@
 #include "common/BackoffImpl.hpp"
 #include "common/Interface.hpp"
 #include "common/MqttClient.hpp"
+#include "common/Scheduler.hpp"
+#include "common/TimerWheel.hpp"
 #include "config.hpp"
 
 extern "C" {
@@ -28,6 +30,9 @@ namespace {
 
 constexpr unsigned long timeLimit =
     std::numeric_limits<unsigned long>::max() - 60000;
+// The longest time the loop sleeps when no interface has anything to do.
+// Incoming messages wait at most this long.
+constexpr unsigned long maxSleep = 20;
 
 void setDeviceName() {
     static char* name = nullptr;
@@ -64,12 +69,14 @@ MqttClient mqttClient(debug, esp, wifi, mqttBackoff, mqttConnection, []() {
 });
 std::unique_ptr<WifiStreambuf> wifiStream;
 std::unique_ptr<MqttStreambuf> mqttStream;
+TimerWheel timers(esp);
+Scheduler scheduler(esp, timers, maxSleep);
 
 }  // unnamed namespace
 
 void setup() {
     WiFi.mode(WIFI_STA);
-    initConfig(debug, debugStream, esp, rtc, mqttClient);
+    initConfig(debug, debugStream, esp, timers, rtc, mqttClient);
     mqttClient.setConfig(
         MqttConfig{
             deviceConfig.name,
@@ -112,15 +119,13 @@ void loop() {
         wifiStream.reset();
     }
 
-    for (const auto& interface : deviceConfig.interfaces) {
-        interface->interface->update(Actions{*interface});
-    }
+    const auto sleepTime = scheduler.update(deviceConfig.interfaces);
 
     const auto rush = esp.getRush();
     if (rush != 0) {
         delayMicroseconds(rush);
         esp.resetRush();
     } else {
-        delay(1);
+        delay(sleepTime);
     }
 }
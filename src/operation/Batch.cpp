@@ -0,0 +1,186 @@
+#include "Batch.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "../common/InterfaceConfig.hpp"
+#include "Operations.hpp"
+
+namespace operation {
+
+namespace detail {
+
+void roundKernel(float* values, std::size_t count) {
+    constexpr double scale = 1e6;
+    // tools::formatFloat() writes larger finite numbers as this.
+    constexpr double formatLimit = 18446744073709551616.0;
+    const double largest = std::nextafter(formatLimit, 0.0);
+    for (std::size_t i = 0; i < count; ++i) {
+        // The decimals of a float are exact in double, so the formatted
+        // number is the integer part and the first six decimals cut off, and
+        // parsing it back rounds the quotient once. Integers and infinity are
+        // written in full.
+        double magnitude = std::fabs(static_cast<double>(values[i]));
+        if (magnitude >= formatLimit && !std::isinf(magnitude)) {
+            magnitude = largest;
+        }
+        double integer = std::trunc(magnitude);
+        double decimals = std::floor((magnitude - integer) * scale);
+        float result = static_cast<float>(
+            integer == magnitude ? magnitude
+                                 : (integer * scale + decimals) / scale);
+        values[i] = values[i] < 0.0f ? -result : result;
+    }
+}
+
+}  // namespace detail
+
+void Batch::setInput(
+    InterfaceConfig& interface, std::size_t index,
+    std::vector<std::string> values) {
+    auto input = std::find_if(
+        this->inputs.begin(), this->inputs.end(),
+        [&](const Input& input) { return input.interface == &interface; });
+    if (input == this->inputs.end()) {
+        this->inputs.push_back(Input{&interface, {}});
+        input = this->inputs.end() - 1;
+    }
+    if (input->columns.size() < index) {
+        input->columns.resize(index, std::vector<std::string>(this->rows));
+    }
+    input->columns[index - 1] = std::move(values);
+}
+
+std::vector<std::string> Batch::evaluate(Operation& operation) {
+    this->add(operation);
+    Column column = this->pop();
+    if (this->rows != 0) {
+        this->storeRow(this->rows - 1);
+    }
+    std::vector<std::string> result;
+    result.reserve(this->rows);
+    switch (column.kind) {
+    case Column::Kind::numbers:
+        for (float value : column.numbers) {
+            result.push_back(TypedValue::fromNumber(value).asString());
+        }
+        break;
+    case Column::Kind::booleans:
+        for (float value : column.numbers) {
+            result.push_back(value != 0.0f ? "1" : "0");
+        }
+        break;
+    case Column::Kind::input:
+        result = *column.input;
+        break;
+    case Column::Kind::constant:
+        result.assign(this->rows, column.values.front().asString());
+        break;
+    case Column::Kind::values:
+        for (TypedValue& value : column.values) {
+            result.push_back(std::move(value).releaseString());
+        }
+        break;
+    }
+    return result;
+}
+
+void Batch::add(Operation& operation) {
+    // The operations that keep a state must see the rows in order, and only
+    // when they would be evaluated, so they are not vectorized.
+    const std::size_t size = this->stack.size();
+    if (!operation.keepsState() && operation.vectorize(*this)) {
+        return;
+    }
+    this->stack.erase(this->stack.begin() + size, this->stack.end());
+    this->evaluateRows(operation);
+}
+
+void Batch::addConstant(const TypedValue& value) {
+    this->stack.push_back(
+        Column{Column::Kind::constant, {}, nullptr, {value.toReference()}});
+}
+
+void Batch::addValue(const InterfaceConfig* interface, std::size_t index) {
+    auto input = std::find_if(
+        this->inputs.begin(), this->inputs.end(),
+        [&](const Input& input) { return input.interface == interface; });
+    if (input != this->inputs.end() && index <= input->columns.size()) {
+        this->stack.push_back(Column{
+            Column::Kind::input, {}, &input->columns[index - 1], {}});
+        return;
+    }
+    // Interfaces without an input keep their value. The ones with an input
+    // have no value with a higher index.
+    static const std::string empty;
+    this->stack.push_back(Column{
+        Column::Kind::constant, {}, nullptr,
+        {TypedValue::fromReference(
+            input == this->inputs.end() ? Value::get(interface, index)
+                                        : empty)}});
+}
+
+std::vector<float> Batch::toNumbers(const Column& column) const {
+    std::vector<float> result;
+    switch (column.kind) {
+    case Column::Kind::numbers:
+        // Reading a number rounds it to the printed precision.
+        result = column.numbers;
+        detail::roundKernel(result.data(), result.size());
+        break;
+    case Column::Kind::booleans:
+        result = column.numbers;
+        break;
+    case Column::Kind::input:
+        result.reserve(this->rows);
+        for (const std::string& value : *column.input) {
+            result.push_back(TypedValue::fromReference(value).asNumber());
+        }
+        break;
+    case Column::Kind::constant:
+        result.assign(this->rows, column.values.front().asNumber());
+        break;
+    case Column::Kind::values:
+        result.reserve(this->rows);
+        for (const TypedValue& value : column.values) {
+            result.push_back(value.asNumber());
+        }
+        break;
+    }
+    return result;
+}
+
+void Batch::evaluateRows(Operation& operation) {
+    Column result{Column::Kind::values, {}, nullptr, {}};
+    result.values.reserve(this->rows);
+    for (std::size_t row = 0; row < this->rows; ++row) {
+        this->storeRow(row);
+        // The value may refer to the stored values, which change in the next
+        // row.
+        TypedValue value = operation.evaluateValue();
+        if (value.getType() == TypedValue::Type::string) {
+            value = TypedValue::fromString(std::move(value).releaseString());
+        }
+        result.values.push_back(std::move(value));
+    }
+    this->stack.push_back(std::move(result));
+}
+
+void Batch::storeRow(std::size_t row) {
+    for (Input& input : this->inputs) {
+        auto& storedValue = input.interface->storedValue;
+        storedValue.clear();
+        for (const auto& column : input.columns) {
+            storedValue.push_back(column[row]);
+        }
+        ++input.interface->generation;
+    }
+}
+
+Batch::Column Batch::pop() {
+    Column result = std::move(this->stack.back());
+    this->stack.pop_back();
+    return result;
+}
+
+}  // namespace operation
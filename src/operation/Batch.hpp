@@ -0,0 +1,153 @@
+#ifndef OPERATION_BATCH_HPP
+#define OPERATION_BATCH_HPP
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "TypedValue.hpp"
+
+class InterfaceConfig;
+
+namespace operation {
+
+class Operation;
+
+namespace detail {
+
+// Plain loops over float arrays, which the compiler can turn into SIMD
+// instructions.
+
+template <typename Operator>
+void applyKernel(float* lhs, const float* rhs, std::size_t count) {
+    Operator operator_;
+    for (std::size_t i = 0; i < count; ++i) {
+        lhs[i] = operator_(lhs[i], rhs[i]);
+    }
+}
+
+// Clears the rows of the result where the comparison does not hold.
+template <typename Operator>
+void compareKernel(
+    float* result, const float* lhs, const float* rhs, std::size_t count) {
+    Operator operator_;
+    for (std::size_t i = 0; i < count; ++i) {
+        result[i] = operator_(lhs[i], rhs[i]) ? result[i] : 0.0f;
+    }
+}
+
+// Rounds the numbers the same way as TypedValue::asNumber(), which formats
+// them and parses them back, but without strings.
+void roundKernel(float* values, std::size_t count);
+
+}  // namespace detail
+
+// Evaluates an operation for many rows of interface values at once, such as
+// recorded sensor values. Used by operation_tester to replay CSV files.
+//
+// Arithmetic and comparisons of numbers run over whole columns. Other
+// operations, and the ones that keep a state, are evaluated row by row with
+// the values of each row stored in the interfaces. Either way, the results are
+// the same as evaluating the operation once for each row.
+class Batch {
+public:
+    explicit Batch(std::size_t rows) : rows(rows) {}
+
+    // The index-th value of the interface in each row, counted from 1 as in
+    // expressions. There must be a value for each row.
+    void setInput(
+        InterfaceConfig& interface, std::size_t index,
+        std::vector<std::string> values);
+
+    // The value of the operation in each row. The interfaces with an input
+    // keep the values of the last row.
+    std::vector<std::string> evaluate(Operation& operation);
+
+    // Pushes the column of an operand. The operations call these from
+    // Operation::vectorize().
+    void add(Operation& operation);
+    void addConstant(const TypedValue& value);
+    void addValue(const InterfaceConfig* interface, std::size_t index);
+    // Replace the columns of the operands with the result.
+    template <typename Operator>
+    void addFold(std::size_t count);
+    template <typename Operator>
+    void addComparison(std::size_t count);
+
+private:
+    struct Column {
+        enum class Kind {
+            // The results of the kernels, which are rounded when read.
+            numbers,
+            booleans,
+            // Refers to the values of an input.
+            input,
+            // The first value is in every row.
+            constant,
+            // The values of the operations evaluated row by row.
+            values,
+        };
+
+        Kind kind;
+        std::vector<float> numbers;
+        const std::vector<std::string>* input = nullptr;
+        std::vector<TypedValue> values;
+    };
+
+    struct Input {
+        InterfaceConfig* interface;
+        // The columns of the first, second etc. value.
+        std::vector<std::vector<std::string>> columns;
+    };
+
+    // The numbers that translator::Float reads from the column.
+    std::vector<float> toNumbers(const Column& column) const;
+    void evaluateRows(Operation& operation);
+    void storeRow(std::size_t row);
+    Column pop();
+
+    std::size_t rows;
+    std::vector<Input> inputs;
+    std::vector<Column> stack;
+};
+
+template <typename Operator>
+void Batch::addFold(std::size_t count) {
+    Column result{Column::Kind::numbers, {}, nullptr, {}};
+    if (count == 0) {
+        result.numbers.assign(this->rows, 0.0f);
+    } else {
+        auto first = this->stack.end() - count;
+        result.numbers = this->toNumbers(*first);
+        for (auto it = first + 1; it != this->stack.end(); ++it) {
+            std::vector<float> operand = this->toNumbers(*it);
+            detail::applyKernel<Operator>(
+                result.numbers.data(), operand.data(), this->rows);
+        }
+        this->stack.erase(first, this->stack.end());
+    }
+    this->stack.push_back(std::move(result));
+}
+
+template <typename Operator>
+void Batch::addComparison(std::size_t count) {
+    Column result{
+        Column::Kind::booleans, std::vector<float>(this->rows, 1.0f), nullptr,
+        {}};
+    if (count != 0) {
+        auto first = this->stack.end() - count;
+        std::vector<float> lhs = this->toNumbers(*first);
+        for (auto it = first + 1; it != this->stack.end(); ++it) {
+            std::vector<float> rhs = this->toNumbers(*it);
+            detail::compareKernel<Operator>(
+                result.numbers.data(), lhs.data(), rhs.data(), this->rows);
+            lhs.swap(rhs);
+        }
+        this->stack.erase(first, this->stack.end());
+    }
+    this->stack.push_back(std::move(result));
+}
+
+}  // namespace operation
+
+#endif  // OPERATION_BATCH_HPP
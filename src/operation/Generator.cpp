@@ -0,0 +1,139 @@
+#include "Generator.hpp"
+
+#include <algorithm>
+
+namespace operation {
+
+namespace {
+
+template <typename Type>
+std::size_t findOrAdd(std::vector<Type>& values, const Type& value) {
+    auto iterator = std::find(values.begin(), values.end(), value);
+    if (iterator != values.end()) {
+        return iterator - values.begin();
+    }
+    values.push_back(value);
+    return values.size() - 1;
+}
+
+}  // unnamed namespace
+
+void Generator::addConstant(const TypedValue& value) {
+    if (value.getType() == TypedValue::Type::boolean) {
+        this->line() << this->top() << ".assignBool("
+                     << (value.asBool() ? "true" : "false") << ");\n";
+    } else {
+        // Numbers are written in their printed form. Converting that back
+        // gives the same number the constant gives, while a float literal of
+        // the converted number would be rounded again.
+        this->line() << this->top() << ".assignReference(strings["
+                     << findOrAdd(this->strings, value.asString()) << "]);\n";
+    }
+    this->push();
+}
+
+void Generator::addValue(const InterfaceConfig* interface, std::size_t index) {
+    this->line() << this->top() << ".assignReference(Value::get(";
+    if (interface) {
+        this->out << "interfaces[" << findOrAdd(this->interfaces, interface)
+                  << "]";
+    } else {
+        this->out << "nullptr";
+    }
+    this->out << ", " << index << "));\n";
+    this->push();
+}
+
+void Generator::addCall(const std::string& function, std::size_t count) {
+    this->depth -= count;
+    std::string arguments =
+        "stack + " + std::to_string(this->depth) + ", " + std::to_string(count);
+    // The generated code is kept within 80 columns where possible.
+    if ((this->indentation * 4) + function.size() + arguments.size() + 3 >
+        80) {
+        this->line() << function << "(\n";
+        ++this->indentation;
+        this->line() << arguments << ");\n";
+        --this->indentation;
+    } else {
+        this->line() << function << "(" << arguments << ");\n";
+    }
+    this->push();
+}
+
+void Generator::beginIf() {
+    --this->depth;
+    this->line() << "if (" << this->top() << ".asBool()) {\n";
+    ++this->indentation;
+}
+
+void Generator::beginElse() {
+    --this->depth;
+    --this->indentation;
+    this->line() << "} else {\n";
+    ++this->indentation;
+}
+
+void Generator::endIf() {
+    --this->indentation;
+    this->line() << "}\n";
+}
+
+void Generator::beginBlock() {
+    this->line() << "do {\n";
+    ++this->indentation;
+}
+
+void Generator::addBreakIf(bool condition) {
+    --this->depth;
+    this->line() << "if (" << (condition ? "" : "!") << this->top()
+                 << ".asBool()) {\n";
+    ++this->indentation;
+    this->line() << this->top() << ".assignBool("
+                 << (condition ? "true" : "false") << ");\n";
+    this->line() << "break;\n";
+    --this->indentation;
+    this->line() << "}\n";
+}
+
+void Generator::endBlock() {
+    --this->indentation;
+    this->line() << "} while (false);\n";
+}
+
+std::ostream& Generator::line() {
+    for (std::size_t i = 0; i < this->indentation; ++i) {
+        this->out << "    ";
+    }
+    return this->out;
+}
+
+std::string Generator::top() const {
+    return "stack[" + std::to_string(this->depth) + "]";
+}
+
+void Generator::push() {
+    ++this->depth;
+    this->stackSize = std::max(this->stackSize, this->depth);
+}
+
+void writeStringLiteral(std::ostream& out, const std::string& value) {
+    constexpr const char* digits = "01234567";
+    out << '"';
+    for (char c : value) {
+        unsigned char code = static_cast<unsigned char>(c);
+        if (c == '"' || c == '\\') {
+            out << '\\' << c;
+        } else if (code < 0x20 || code >= 0x7f) {
+            // Always three digits, so that a following digit is not taken
+            // as part of the escape.
+            out << '\\' << digits[code >> 6] << digits[(code >> 3) & 7]
+                << digits[code & 7];
+        } else {
+            out << c;
+        }
+    }
+    out << '"';
+}
+
+}  // namespace operation
@@ -0,0 +1,119 @@
+#ifndef OPERATION_GENERATOR_HPP
+#define OPERATION_GENERATOR_HPP
+
+#include <cstddef>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "Translator.hpp"
+#include "TypedValue.hpp"
+
+class InterfaceConfig;
+
+namespace operation {
+
+// Writes C++ statements that leave the value of an operation tree in the
+// first element of a value stack. It works the same way as the Compiler, but
+// the instructions become code, so the operators are called directly instead
+// of through function pointers. Used by operation_compiler to build rules
+// into the firmware.
+//
+// The generated code is meant for the operation namespace. It refers to the
+// interfaces as interfaces[n] and to string constants as strings[n]. Both
+// tables are shared between the operations generated into the same file.
+class Generator {
+public:
+    Generator(
+        std::ostream& out, std::vector<const InterfaceConfig*>& interfaces,
+        std::vector<std::string>& strings)
+        : out(out), interfaces(interfaces), strings(strings) {}
+
+    void addConstant(const TypedValue& value);
+    void addValue(const InterfaceConfig* interface, std::size_t index);
+    // Calls a function with the same signature as Function.
+    void addCall(const std::string& function, std::size_t count);
+
+    // The value on the top decides which branch runs. Both branches leave one
+    // value on the stack.
+    void beginIf();
+    void beginElse();
+    void endIf();
+
+    // Within a block, the top value is replaced with the condition and the
+    // rest of the block is skipped if it converts to the condition. Otherwise
+    // it is dropped.
+    void beginBlock();
+    void addBreakIf(bool condition);
+    void endBlock();
+
+    std::size_t getStackSize() const { return this->stackSize; }
+
+private:
+    std::ostream& line();
+    std::string top() const;
+    void push();
+
+    std::ostream& out;
+    std::vector<const InterfaceConfig*>& interfaces;
+    std::vector<std::string>& strings;
+    std::size_t depth = 0;
+    std::size_t stackSize = 0;
+    std::size_t indentation = 1;
+};
+
+// Writes a string as a C++ string literal.
+void writeStringLiteral(std::ostream& out, const std::string& value);
+
+namespace detail {
+
+// The name of an operator or translator in generated code.
+template <typename Type>
+struct TypeName;
+
+#define OPERATION_TYPE_NAME(...)                          \
+    template <>                                           \
+    struct TypeName<__VA_ARGS__> {                        \
+        static constexpr const char* value = #__VA_ARGS__; \
+    }
+
+OPERATION_TYPE_NAME(std::plus<float>);
+OPERATION_TYPE_NAME(std::minus<float>);
+OPERATION_TYPE_NAME(std::multiplies<float>);
+OPERATION_TYPE_NAME(std::divides<float>);
+OPERATION_TYPE_NAME(std::plus<std::string>);
+OPERATION_TYPE_NAME(std::equal_to<float>);
+OPERATION_TYPE_NAME(std::not_equal_to<float>);
+OPERATION_TYPE_NAME(std::less<float>);
+OPERATION_TYPE_NAME(std::greater<float>);
+OPERATION_TYPE_NAME(std::less_equal<float>);
+OPERATION_TYPE_NAME(std::greater_equal<float>);
+OPERATION_TYPE_NAME(std::equal_to<std::string>);
+OPERATION_TYPE_NAME(std::not_equal_to<std::string>);
+OPERATION_TYPE_NAME(std::less<std::string>);
+OPERATION_TYPE_NAME(std::greater<std::string>);
+OPERATION_TYPE_NAME(std::less_equal<std::string>);
+OPERATION_TYPE_NAME(std::greater_equal<std::string>);
+OPERATION_TYPE_NAME(std::logical_and<bool>);
+OPERATION_TYPE_NAME(std::logical_or<bool>);
+OPERATION_TYPE_NAME(std::logical_not<bool>);
+OPERATION_TYPE_NAME(translator::Str);
+OPERATION_TYPE_NAME(translator::Float);
+OPERATION_TYPE_NAME(translator::Bool);
+
+#undef OPERATION_TYPE_NAME
+
+// The apply() function of an operation template, such as
+// FoldingOperation<std::plus<float>, translator::Float>::apply.
+template <typename Operator, typename Translator>
+std::string applyName(const char* operation) {
+    return std::string{operation} + "<" + TypeName<Operator>::value + ", " +
+           TypeName<Translator>::value + ">::apply";
+}
+
+}  // namespace detail
+
+}  // namespace operation
+
+#endif  // OPERATION_GENERATOR_HPP
@@ -0,0 +1,96 @@
+#include "Memoized.hpp"
+
+#include <algorithm>
+
+#include "../common/InterfaceConfig.hpp"
+
+namespace operation {
+
+namespace {
+
+struct Dependencies {
+    bool known = true;
+    bool hasOperands = false;
+    std::vector<const InterfaceConfig*> interfaces;
+};
+
+bool isWorthCaching(const Dependencies& dependencies) {
+    // Values and constants are cheaper to evaluate than to cache.
+    return dependencies.known && dependencies.hasOperands;
+}
+
+Dependencies memoizeOperands(Operation& operation) {
+    Dependencies result;
+    result.known = operation.getDependencies(result.interfaces);
+
+    std::vector<std::pair<std::unique_ptr<Operation>*, Dependencies>> operands;
+    operation.forEachOperand([&](std::unique_ptr<Operation>& operand) {
+        auto dependencies = memoizeOperands(*operand);
+        result.known = result.known && dependencies.known;
+        result.interfaces.insert(
+            result.interfaces.end(), dependencies.interfaces.begin(),
+            dependencies.interfaces.end());
+        operands.emplace_back(&operand, std::move(dependencies));
+    });
+    result.hasOperands = !operands.empty();
+    std::sort(result.interfaces.begin(), result.interfaces.end());
+    result.interfaces.erase(
+        std::unique(result.interfaces.begin(), result.interfaces.end()),
+        result.interfaces.end());
+
+    for (auto& [operand, dependencies] : operands) {
+        // An operand that depends on everything its user does changes
+        // whenever the user has to be evaluated again.
+        if (isWorthCaching(dependencies) &&
+            (!result.known ||
+             dependencies.interfaces.size() < result.interfaces.size())) {
+            *operand = std::make_unique<Memoized>(
+                std::move(*operand), dependencies.interfaces);
+        }
+    }
+    return result;
+}
+
+}  // unnamed namespace
+
+CacheStatistics Memoized::statistics;
+
+Memoized::Memoized(
+    std::unique_ptr<Operation> operation,
+    const std::vector<const InterfaceConfig*>& dependencies)
+    : operation(std::move(operation)) {
+    this->dependencies.reserve(dependencies.size());
+    for (const InterfaceConfig* interface : dependencies) {
+        this->dependencies.emplace_back(interface, interface->generation);
+    }
+}
+
+TypedValue Memoized::evaluateValue() {
+    bool changed = !this->valid;
+    for (auto& [interface, generation] : this->dependencies) {
+        if (interface->generation != generation) {
+            generation = interface->generation;
+            changed = true;
+        }
+    }
+
+    if (changed) {
+        ++statistics.misses;
+        this->value = this->operation->evaluateValue().toOwned();
+        this->valid = true;
+    } else {
+        ++statistics.hits;
+    }
+    return this->value.toReference();
+}
+
+std::unique_ptr<Operation> memoize(std::unique_ptr<Operation> operation) {
+    auto dependencies = memoizeOperands(*operation);
+    if (!isWorthCaching(dependencies)) {
+        return operation;
+    }
+    return std::make_unique<Memoized>(
+        std::move(operation), dependencies.interfaces);
+}
+
+}  // namespace operation
@@ -0,0 +1,55 @@
+#ifndef OPERATION_MEMOIZED_HPP
+#define OPERATION_MEMOIZED_HPP
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "Operation.hpp"
+
+namespace operation {
+
+struct CacheStatistics {
+    unsigned long hits = 0;
+    unsigned long misses = 0;
+};
+
+// Keeps the last value of an operation until one of the interfaces it depends
+// on changes.
+class Memoized : public Operation {
+public:
+    Memoized(
+        std::unique_ptr<Operation> operation,
+        const std::vector<const InterfaceConfig*>& dependencies);
+
+    TypedValue evaluateValue() override;
+    std::optional<TypedValue::Type> getResultType() const override {
+        return this->operation->getResultType();
+    }
+    bool getDependencies(
+        std::vector<const InterfaceConfig*>& /*interfaces*/) const override {
+        return true;
+    }
+    void forEachOperand(
+        const std::function<void(std::unique_ptr<Operation>&)>& function)
+        override {
+        function(this->operation);
+    }
+
+    static CacheStatistics statistics;
+
+private:
+    std::unique_ptr<Operation> operation;
+    std::vector<std::pair<const InterfaceConfig*, unsigned>> dependencies;
+    bool valid = false;
+    TypedValue value;
+};
+
+// Caches the value of the operation, and of those operands that depend on
+// fewer interfaces than the operation that uses them. Operations whose
+// dependencies are not known are evaluated every time.
+std::unique_ptr<Operation> memoize(std::unique_ptr<Operation> operation);
+
+}  // namespace operation
+
+#endif  // OPERATION_MEMOIZED_HPP
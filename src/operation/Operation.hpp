@@ -1,16 +1,78 @@
 #ifndef OPERATION_OPERATION_HPP
 #define OPERATION_OPERATION_HPP
 
+#include <functional>
+#include <memory>
+#include <optional>
 #include <string>
+#include <vector>
+
+#include "../tools/arena.hpp"
+#include "TypedValue.hpp"
+
+class InterfaceConfig;
 
 namespace operation {
 
-class Operation {
+class Batch;
+class Compiler;
+class Generator;
+
+class Operation : public tools::ArenaAllocated {
 public:
-    virtual std::string evaluate() = 0;
+    std::string evaluate() { return this->evaluateValue().releaseString(); }
+
+    virtual TypedValue evaluateValue() = 0;
+
+    // The value of the operation if it does not depend on anything.
+    virtual const TypedValue* getConstantValue() const { return nullptr; }
+    // The type evaluateValue() always returns, if known in advance.
+    virtual std::optional<TypedValue::Type> getResultType() const {
+        return std::nullopt;
+    }
+    // Returns an equivalent but cheaper operation, or nullptr if this one
+    // should be kept. Operands are optimized in place.
+    virtual std::unique_ptr<Operation> simplify() { return nullptr; }
+    // Emits the instructions that leave the value of the operation on the
+    // stack. By default the program calls evaluateValue() of this operation.
+    virtual void compile(Compiler& compiler);
+    // Writes the code that leaves the value of the operation on the stack.
+    // Returns false if the operation cannot be turned into code, for example
+    // because it keeps a state or reads the time.
+    virtual bool generate(Generator& /*generator*/) { return false; }
+    // Pushes the column of the values of the operation over a batch of rows.
+    // Returns false if there is no kernel for the operation, and the batch
+    // evaluates it row by row instead.
+    virtual bool vectorize(Batch& /*batch*/) { return false; }
+    // Adds the interfaces the operation reads, not counting its operands.
+    // Returns false if the value depends on anything else, such as time or
+    // earlier values.
+    virtual bool getDependencies(
+        std::vector<const InterfaceConfig*>& /*interfaces*/) const {
+        return false;
+    }
+    // If the value is the time elapsed since a point in time, returns that
+    // point in milliseconds since start.
+    virtual std::optional<unsigned long> getTimeOrigin() const {
+        return std::nullopt;
+    }
+    // The first time after now when the value may change even if no
+    // interface changes, such as when since() reaches a duration it is
+    // compared with. By default it is the earliest of the operands.
+    virtual std::optional<unsigned long> getNextChange(unsigned long now);
+    // Whether evaluating the operation changes its later values, such as
+    // avg() does. By default it is true if any of the operands does.
+    virtual bool keepsState();
+    // Calls the function with each operand, which may replace it.
+    virtual void forEachOperand(
+        const std::function<void(std::unique_ptr<Operation>&)>& /*function*/) {
+    }
+
     virtual ~Operation() {}
 };
 
+std::unique_ptr<Operation> optimize(std::unique_ptr<Operation> operation);
+
 }  // namespace operation
 
 #endif  // OPERATION_OPERATION_HPP
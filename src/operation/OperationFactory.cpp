@@ -0,0 +1,91 @@
+#include "OperationFactory.hpp"
+
+#include <functional>
+#include <string>
+
+#include "Operations.hpp"
+#include "Translator.hpp"
+
+namespace operation {
+
+namespace {
+
+template <typename Operator, typename Translator>
+std::unique_ptr<Operation> makeFolding(
+    std::vector<std::unique_ptr<Operation>> operands) {
+    return std::make_unique<FoldingOperation<Operator, Translator>>(
+        std::move(operands));
+}
+
+template <typename Operator, typename Translator>
+std::unique_ptr<Operation> makeComparison(
+    std::vector<std::unique_ptr<Operation>> operands) {
+    return std::make_unique<Comparison<Operator, Translator>>(
+        std::move(operands));
+}
+
+}  // unnamed namespace
+
+std::unique_ptr<Operation> makeOperation(
+    OperatorType type, std::vector<std::unique_ptr<Operation>> operands) {
+    using translator::Bool;
+    using translator::Float;
+    using translator::Str;
+
+    switch (type) {
+    case OperatorType::add:
+        return makeFolding<std::plus<float>, Float>(std::move(operands));
+    case OperatorType::subtract:
+        return makeFolding<std::minus<float>, Float>(std::move(operands));
+    case OperatorType::multiply:
+        return makeFolding<std::multiplies<float>, Float>(std::move(operands));
+    case OperatorType::divide:
+        return makeFolding<std::divides<float>, Float>(std::move(operands));
+    case OperatorType::concatenate:
+        return makeFolding<std::plus<std::string>, Str>(std::move(operands));
+    case OperatorType::equal:
+        return makeComparison<std::equal_to<float>, Float>(
+            std::move(operands));
+    case OperatorType::notEqual:
+        return makeComparison<std::not_equal_to<float>, Float>(
+            std::move(operands));
+    case OperatorType::less:
+        return makeComparison<std::less<float>, Float>(std::move(operands));
+    case OperatorType::greater:
+        return makeComparison<std::greater<float>, Float>(std::move(operands));
+    case OperatorType::lessEqual:
+        return makeComparison<std::less_equal<float>, Float>(
+            std::move(operands));
+    case OperatorType::greaterEqual:
+        return makeComparison<std::greater_equal<float>, Float>(
+            std::move(operands));
+    case OperatorType::stringEqual:
+        return makeComparison<std::equal_to<std::string>, Str>(
+            std::move(operands));
+    case OperatorType::stringNotEqual:
+        return makeComparison<std::not_equal_to<std::string>, Str>(
+            std::move(operands));
+    case OperatorType::stringLess:
+        return makeComparison<std::less<std::string>, Str>(
+            std::move(operands));
+    case OperatorType::stringGreater:
+        return makeComparison<std::greater<std::string>, Str>(
+            std::move(operands));
+    case OperatorType::stringLessEqual:
+        return makeComparison<std::less_equal<std::string>, Str>(
+            std::move(operands));
+    case OperatorType::stringGreaterEqual:
+        return makeComparison<std::greater_equal<std::string>, Str>(
+            std::move(operands));
+    case OperatorType::logicalAnd:
+        return makeFolding<std::logical_and<bool>, Bool>(std::move(operands));
+    case OperatorType::logicalOr:
+        return makeFolding<std::logical_or<bool>, Bool>(std::move(operands));
+    case OperatorType::logicalNot:
+        return std::make_unique<UnaryOperation<std::logical_not<bool>, Bool>>(
+            std::move(operands.front()));
+    }
+    return nullptr;
+}
+
+}  // namespace operation
@@ -0,0 +1,43 @@
+#ifndef OPERATION_OPERATIONFACTORY_HPP
+#define OPERATION_OPERATIONFACTORY_HPP
+
+#include <memory>
+#include <vector>
+
+#include "Operation.hpp"
+
+namespace operation {
+
+// The operators of both the expression syntax and the JSON syntax. Both
+// parsers build their operations with makeOperation(), so the same operator
+// always becomes the same kind of node, whichever syntax it came from.
+enum class OperatorType {
+    add,
+    subtract,
+    multiply,
+    divide,
+    concatenate,
+    equal,
+    notEqual,
+    less,
+    greater,
+    lessEqual,
+    greaterEqual,
+    stringEqual,
+    stringNotEqual,
+    stringLess,
+    stringGreater,
+    stringLessEqual,
+    stringGreaterEqual,
+    logicalAnd,
+    logicalOr,
+    // Uses only the first operand.
+    logicalNot,
+};
+
+std::unique_ptr<Operation> makeOperation(
+    OperatorType type, std::vector<std::unique_ptr<Operation>> operands);
+
+}  // namespace operation
+
+#endif  // OPERATION_OPERATIONFACTORY_HPP
@@ -1,9 +1,12 @@
 #include "OperationParser.hpp"
 
-#include <functional>
+#include <initializer_list>
 #include <memory>
+#include <utility>
 
 #include "../common/InterfaceConfig.hpp"
+#include "../tools/collection.hpp"
+#include "OperationFactory.hpp"
 #include "Operations.hpp"
 #include "Translator.hpp"
 
@@ -13,6 +16,28 @@ namespace operation {
 
 namespace {
 
+const std::initializer_list<std::pair<const char*, OperatorType>> operators{
+    {"+", OperatorType::add},
+    {"-", OperatorType::subtract},
+    {"*", OperatorType::multiply},
+    {"/", OperatorType::divide},
+    {"s+", OperatorType::concatenate},
+    {"=", OperatorType::equal},
+    {"s=", OperatorType::stringEqual},
+    {"!=", OperatorType::notEqual},
+    {"s!=", OperatorType::stringNotEqual},
+    {"<", OperatorType::less},
+    {"s<", OperatorType::stringLess},
+    {">", OperatorType::greater},
+    {"s>", OperatorType::stringGreater},
+    {"<=", OperatorType::lessEqual},
+    {"s<=", OperatorType::stringLessEqual},
+    {">=", OperatorType::greaterEqual},
+    {"s>=", OperatorType::stringGreaterEqual},
+    {"&", OperatorType::logicalAnd},
+    {"|", OperatorType::logicalOr},
+};
+
 std::unique_ptr<Operation> getEmptyOperation() {
     return std::make_unique<Constant>("");
 }
@@ -22,14 +47,13 @@ std::unique_ptr<Operation> getEmptyOperation() {
 Parser::Parser(
     const std::vector<std::unique_ptr<InterfaceConfig>>& interfaces,
     InterfaceConfig* defaultInterface)
-    : interfaces(interfaces.size(), nullptr)
-    , defaultInterface(defaultInterface) {
-    std::transform(
-        interfaces.begin(), interfaces.end(), this->interfaces.begin(),
-        [](const std::unique_ptr<InterfaceConfig>& interface) {
-        return interface.get();
-    });
-}
+    : ownInterfaces(interfaces)
+    , interfaces(this->ownInterfaces)
+    , defaultInterface(defaultInterface) {}
+
+Parser::Parser(
+    const InterfaceRegistry& interfaces, InterfaceConfig* defaultInterface)
+    : interfaces(interfaces), defaultInterface(defaultInterface) {}
 
 std::unique_ptr<Operation> Parser::parse(
     const JsonObject& data, const char* fieldName,
@@ -45,13 +69,11 @@ std::unique_ptr<Operation> Parser::parse(
         std::vector<std::unique_ptr<Operation>> operands;
         operands.push_back(std::make_unique<Value>(this->defaultInterface, 1));
         operands.push_back(std::make_unique<Constant>(value));
-        return std::make_unique<Conditional>(
-            std::make_unique<
-                Comparison<std::equal_to<std::string>, translator::Str>>(
-                std::move(operands)),
+        operation = std::make_unique<Conditional>(
+            makeOperation(OperatorType::stringEqual, std::move(operands)),
             std::move(operation), getEmptyOperation());
     }
-    return operation;
+    return optimize(std::move(operation));
 }
 
 std::unique_ptr<Operation> Parser::doParse(const JsonVariant& data) {
@@ -65,7 +87,7 @@ std::unique_ptr<Operation> Parser::doParse(const JsonVariant& data) {
         auto name = object.get<std::string>("interface");
         auto template_ = object.get<std::string>("template");
         auto interface = name.empty() ? this->defaultInterface
-                                      : findInterface(this->interfaces, name);
+                                      : this->interfaces.find(name);
         if (!interface) {
             return getEmptyOperation();
         }
@@ -79,86 +101,12 @@ std::unique_ptr<Operation> Parser::doParse(const JsonVariant& data) {
             }
             return std::make_unique<Value>(interface, index);
         }
-    } else if (type == "+") {
-        return std::make_unique<
-            FoldingOperation<std::plus<float>, translator::Float>>(
-            parseOperands(object));
-    } else if (type == "-") {
-        return std::make_unique<
-            FoldingOperation<std::minus<float>, translator::Float>>(
-            parseOperands(object));
-    } else if (type == "*") {
-        return std::make_unique<
-            FoldingOperation<std::multiplies<float>, translator::Float>>(
-            parseOperands(object));
-    } else if (type == "/") {
-        return std::make_unique<
-            FoldingOperation<std::divides<float>, translator::Float>>(
-            parseOperands(object));
-    } else if (type == "s+") {
-        return std::make_unique<
-            FoldingOperation<std::plus<std::string>, translator::Str>>(
-            parseOperands(object));
-    } else if (type == "=") {
-        return std::make_unique<
-            Comparison<std::equal_to<float>, translator::Float>>(
-            parseOperands(object));
-    } else if (type == "s=") {
-        return std::make_unique<
-            Comparison<std::equal_to<std::string>, translator::Str>>(
-            parseOperands(object));
-    } else if (type == "!=") {
-        return std::make_unique<
-            Comparison<std::not_equal_to<float>, translator::Float>>(
-            parseOperands(object));
-    } else if (type == "s!=") {
-        return std::make_unique<
-            Comparison<std::not_equal_to<std::string>, translator::Str>>(
-            parseOperands(object));
-    } else if (type == "<") {
-        return std::make_unique<
-            Comparison<std::less<float>, translator::Float>>(
-            parseOperands(object));
-    } else if (type == "s<") {
-        return std::make_unique<
-            Comparison<std::less<std::string>, translator::Str>>(
-            parseOperands(object));
-    } else if (type == ">") {
-        return std::make_unique<
-            Comparison<std::greater<float>, translator::Float>>(
-            parseOperands(object));
-    } else if (type == "s>") {
-        return std::make_unique<
-            Comparison<std::greater<std::string>, translator::Str>>(
-            parseOperands(object));
-    } else if (type == "<=") {
-        return std::make_unique<
-            Comparison<std::less_equal<float>, translator::Float>>(
-            parseOperands(object));
-    } else if (type == "s<=") {
-        return std::make_unique<
-            Comparison<std::less_equal<std::string>, translator::Str>>(
-            parseOperands(object));
-    } else if (type == ">=") {
-        return std::make_unique<
-            Comparison<std::greater_equal<float>, translator::Float>>(
-            parseOperands(object));
-    } else if (type == "s>=") {
-        return std::make_unique<
-            Comparison<std::greater_equal<std::string>, translator::Str>>(
-            parseOperands(object));
-    } else if (type == "&") {
-        return std::make_unique<
-            FoldingOperation<std::logical_and<bool>, translator::Bool>>(
-            parseOperands(object));
-    } else if (type == "|") {
-        return std::make_unique<
-            FoldingOperation<std::logical_or<bool>, translator::Bool>>(
-            parseOperands(object));
+    } else if (auto operatorType = tools::findValue(operators, type)) {
+        return makeOperation(*operatorType, parseOperands(object));
     } else if (type == "!") {
-        return std::make_unique<
-            UnaryOperation<std::logical_not<bool>, translator::Bool>>(
-            doParse(object["op"]));
+        std::vector<std::unique_ptr<Operation>> operands;
+        operands.push_back(doParse(object["op"]));
+        return makeOperation(OperatorType::logicalNot, std::move(operands));
     } else if (type == "if") {
         return std::make_unique<Conditional>(
             doParse(object["cond"]), doParse(object["then"]),
@@ -6,19 +6,23 @@
 #include <vector>
 
 #include "../common/ArduinoJson.hpp"
+#include "../common/InterfaceConfig.hpp"
 #include "Operation.hpp"
 
-class InterfaceConfig;
-
 namespace operation {
 
 struct MappingElement;
 
 class Parser {
 public:
+    // Builds a registry of the interfaces for this parser only.
     Parser(
         const std::vector<std::unique_ptr<InterfaceConfig>>& interfaces,
         InterfaceConfig* defaultInterface);
+    Parser(
+        const InterfaceRegistry& interfaces, InterfaceConfig* defaultInterface);
+    Parser(const Parser&) = delete;
+    Parser& operator=(const Parser&) = delete;
 
     std::unique_ptr<Operation> parse(
         const ArduinoJson::JsonObject& data, const char* fieldName,
@@ -37,7 +41,8 @@ private:
     std::vector<MappingElement> parseMappingElements(
         const ArduinoJson::JsonObject& object);
 
-    std::vector<InterfaceConfig*> interfaces;
+    InterfaceRegistry ownInterfaces;
+    const InterfaceRegistry& interfaces;
     InterfaceConfig* defaultInterface;
     std::unordered_set<InterfaceConfig*> usedInterfaces;
 };
@@ -2,19 +2,23 @@
 
 #include <algorithm>
 #include <cctype>
-#include <cerrno>
-#include <functional>
+#include <limits>
 
 #include "../common/InterfaceConfig.hpp"
+#include "../tools/arena.hpp"
+#include "../tools/number.hpp"
+#include "OperationFactory.hpp"
 #include "Operations.hpp"
-#include "Translator.hpp"
+#include "Streaming.hpp"
+#include "Timing.hpp"
 
 namespace operation {
 
 namespace {
 
-std::string unescapeString(const std::string& s) {
+std::string unescapeString(std::string_view s) {
     std::string result;
+    result.reserve(s.size());
     for (size_t i = 0; i < s.size(); ++i) {
         if (s[i] == '\\' && i + 1 < s.size()) {
             switch (s[i + 1]) {
@@ -37,6 +41,32 @@ std::string unescapeString(const std::string& s) {
     return result;
 }
 
+// In interface names a backslash makes any character literal.
+std::string unescapeName(std::string_view s) {
+    std::string result;
+    result.reserve(s.size());
+    for (size_t i = 0; i < s.size(); ++i) {
+        if (s[i] == '\\' && i + 1 < s.size()) {
+            ++i;
+        }
+        result.push_back(s[i]);
+    }
+    return result;
+}
+
+bool parseIndex(std::string_view digits, std::size_t& index) {
+    constexpr std::size_t max = std::numeric_limits<std::size_t>::max();
+    index = 0;
+    for (char c : digits) {
+        std::size_t digit = c - '0';
+        if (index > (max - digit) / 10) {
+            return false;
+        }
+        index = index * 10 + digit;
+    }
+    return true;
+}
+
 std::vector<std::unique_ptr<Operation>> makeOperands(
     std::unique_ptr<Operation> left, std::unique_ptr<Operation> right) {
     std::vector<std::unique_ptr<Operation>> operands;
@@ -45,47 +75,75 @@ std::vector<std::unique_ptr<Operation>> makeOperands(
     return operands;
 }
 
-class Impl {
-public:
-    Impl(
-        std::ostream& debug, const std::vector<InterfaceConfig*>& interfaces,
-        InterfaceConfig* defaultInterface)
-        : debug(debug)
-        , interfaces(interfaces)
-        , defaultInterface(defaultInterface) {}
+struct BinaryOperator {
+    std::string_view token;
+    OperatorType type;
+    int precedence;
+};
 
-    std::unique_ptr<Operation> parse(const std::string& data) {
-        this->pos = 0;
-        this->data = data;
-        this->skipWhitespace();
-        if (this->pos >= data.size()) {
-            this->debug << "Syntax error: Empty expression" << std::endl;
-            return nullptr;
-        }
-        auto result = this->parseExpression();
-        if (result) {
-            this->skipWhitespace();
-            if (this->pos != data.size()) {
-                this->debug << "Syntax error: Unfinished expression"
-                            << std::endl;
-                return nullptr;
-            }
-        }
-        return result;
-    }
+// Operators with a higher precedence bind stronger. Longer tokens must come
+// before their prefixes.
+constexpr BinaryOperator binaryOperators[] = {
+    {"||", OperatorType::logicalOr, 0},
+    {"&&", OperatorType::logicalAnd, 1},
+    {"==", OperatorType::equal, 2},
+    {"!=", OperatorType::notEqual, 2},
+    {"s==", OperatorType::stringEqual, 2},
+    {"s!=", OperatorType::stringNotEqual, 2},
+    {"s<=", OperatorType::stringLessEqual, 3},
+    {"s>=", OperatorType::stringGreaterEqual, 3},
+    {"s<", OperatorType::stringLess, 3},
+    {"s>", OperatorType::stringGreater, 3},
+    {"<=", OperatorType::lessEqual, 3},
+    {">=", OperatorType::greaterEqual, 3},
+    {"<", OperatorType::less, 3},
+    {">", OperatorType::greater, 3},
+    {"+", OperatorType::add, 4},
+    {"-", OperatorType::subtract, 4},
+    {"s+", OperatorType::concatenate, 4},
+    {"*", OperatorType::multiply, 5},
+    {"/", OperatorType::divide, 5},
+};
 
-    std::unordered_set<InterfaceConfig*>&& getUsedInterfaces() && {
-        return std::move(this->usedInterfaces);
-    }
+constexpr int maxPrecedence = 5;
 
-private:
-    std::ostream& debug;
-    const std::vector<InterfaceConfig*>& interfaces;
-    InterfaceConfig* const defaultInterface;
-    std::unordered_set<InterfaceConfig*> usedInterfaces;
+// Chains of these operators become one node, which gives the same result as
+// nesting them. Number operators are not merged, because nesting rounds the
+// intermediate results.
+bool canFlatten(OperatorType type) {
+    return type == OperatorType::logicalAnd ||
+           type == OperatorType::logicalOr ||
+           type == OperatorType::concatenate;
+}
 
-    std::string data;
-    size_t pos = 0;
+struct Unit {
+    std::string_view name;
+    float milliseconds;
+};
+
+// Units of durations, which are written right after a number. Durations are
+// in milliseconds, like the time functions.
+constexpr Unit units[] = {
+    {"ms", 1.0f},
+    {"s", 1000.0f},
+    {"m", 60.0f * 1000.0f},
+    {"h", 60.0f * 60.0f * 1000.0f},
+    {"d", 24.0f * 60.0f * 60.0f * 1000.0f},
+};
+
+// The number of samples the moving window functions can keep.
+constexpr std::size_t maxWindowSize = 1000;
+
+// Splits the expression into tokens. Tokens are returned as views of the
+// expression, so nothing is copied or allocated while scanning.
+class Lexer {
+public:
+    explicit Lexer(std::string_view data) : data(data) {}
+
+    bool atEnd() {
+        this->skipWhitespace();
+        return this->pos == this->data.size();
+    }
 
     void skipWhitespace() {
         while (this->pos < this->data.size() &&
@@ -103,28 +161,215 @@ private:
         return false;
     }
 
-    bool match(const std::string& s) {
+    bool match(std::string_view token) {
         this->skipWhitespace();
-        if (this->pos + s.size() <= this->data.size() &&
-            this->data.substr(this->pos, s.size()) == s) {
-            this->pos += s.size();
+        if (this->data.substr(this->pos, token.size()) == token) {
+            this->pos += token.size();
             return true;
         }
         return false;
     }
 
+    // Reads until the terminator and skips it. A backslash escapes the next
+    // character, but it is kept in the result, and escaped is set if there was
+    // one. Returns false if the terminator is missing.
+    bool readDelimited(
+        char terminator, std::string_view& result, bool& escaped) {
+        std::size_t start = this->pos;
+        escaped = false;
+        while (this->pos < this->data.size()) {
+            char c = this->data[this->pos];
+            if (c == '\\' && this->pos + 1 < this->data.size()) {
+                escaped = true;
+                this->pos += 2;
+            } else if (c == terminator) {
+                result = this->data.substr(start, this->pos - start);
+                ++this->pos;
+                return true;
+            } else {
+                ++this->pos;
+            }
+        }
+        return false;
+    }
+
+    // An optional sign followed by digits and dots. Returns an empty view if
+    // there is no digit.
+    std::string_view readNumber() {
+        this->skipWhitespace();
+        std::size_t start = this->pos;
+        if (this->pos < this->data.size() &&
+            (this->data[this->pos] == '-' || this->data[this->pos] == '+')) {
+            ++this->pos;
+        }
+        bool hasDigit = false;
+        while (this->pos < this->data.size() &&
+               (std::isdigit(this->data[this->pos]) ||
+                this->data[this->pos] == '.')) {
+            if (std::isdigit(this->data[this->pos])) {
+                hasDigit = true;
+            }
+            ++this->pos;
+        }
+        if (!hasDigit) {
+            return {};
+        }
+        return this->data.substr(start, this->pos - start);
+    }
+
+    // Letters right after a number. An "s" that starts a string operator is
+    // not read.
+    std::string_view readUnit() {
+        std::size_t start = this->pos;
+        while (this->pos < this->data.size() &&
+               std::isalpha(this->data[this->pos])) {
+            ++this->pos;
+        }
+        if (this->pos < this->data.size() && this->pos == start + 1 &&
+            this->data[start] == 's' &&
+            std::string_view{"+=!<>"}.find(this->data[this->pos]) !=
+                std::string_view::npos) {
+            this->pos = start;
+        }
+        return this->data.substr(start, this->pos - start);
+    }
+
+    // A name followed by an opening parenthesis. Returns the name and skips
+    // both, or returns an empty view and skips nothing.
+    std::string_view matchCall() {
+        this->skipWhitespace();
+        std::size_t start = this->pos;
+        while (this->pos < this->data.size() &&
+               (std::isalnum(this->data[this->pos]) ||
+                this->data[this->pos] == '_')) {
+            ++this->pos;
+        }
+        std::string_view name = this->data.substr(start, this->pos - start);
+        if (name.empty() || std::isdigit(name.front()) || !this->match('(')) {
+            this->pos = start;
+            return {};
+        }
+        return name;
+    }
+
+    std::string_view readDigits() {
+        std::size_t start = this->pos;
+        while (this->pos < this->data.size() &&
+               std::isdigit(this->data[this->pos])) {
+            ++this->pos;
+        }
+        return this->data.substr(start, this->pos - start);
+    }
+
+private:
+    std::string_view data;
+    std::size_t pos = 0;
+};
+
+// Adds the depth and the number of nodes of the tree to size. Stops
+// descending below the given depth, so that measuring a tree that is too deep
+// to evaluate does not overflow the stack either.
+//
+// The first operand is on the same level as its parent. Chains of number
+// operators such as a + b + c nest to the left, and their length is limited
+// by the number of nodes instead. Other ways of nesting to the left, such as
+// parentheses, are limited while parsing.
+void measure(
+    Operation& operation, std::size_t depth, std::size_t maxDepth,
+    Parser2::Statistics& size) {
+    ++size.nodes;
+    size.depth = std::max(size.depth, depth);
+    if (depth > maxDepth) {
+        return;
+    }
+    bool first = true;
+    operation.forEachOperand([&](std::unique_ptr<Operation>& operand) {
+        measure(*operand, first ? depth : depth + 1, maxDepth, size);
+        first = false;
+    });
+}
+
+class Impl {
+public:
+    Impl(
+        std::ostream& debug, const InterfaceRegistry& interfaces,
+        InterfaceConfig* defaultInterface, EspApi* esp, std::size_t maxDepth,
+        std::string_view data)
+        : debug(debug)
+        , interfaces(interfaces)
+        , defaultInterface(defaultInterface)
+        , esp(esp)
+        , maxDepth(maxDepth)
+        , lexer(data) {}
+
+    std::unique_ptr<Operation> parse() {
+        if (this->lexer.atEnd()) {
+            this->debug << "Syntax error: Empty expression" << std::endl;
+            return nullptr;
+        }
+        auto result = this->parseExpression();
+        if (result && !this->lexer.atEnd()) {
+            this->debug << "Syntax error: Unfinished expression" << std::endl;
+            return nullptr;
+        }
+        return result;
+    }
+
+    std::unordered_set<InterfaceConfig*>&& getUsedInterfaces() && {
+        return std::move(this->usedInterfaces);
+    }
+
+    bool readsTime() const { return this->timeRead; }
+
+private:
+    std::ostream& debug;
+    const InterfaceRegistry& interfaces;
+    InterfaceConfig* const defaultInterface;
+    EspApi* const esp;
+    const std::size_t maxDepth;
+    std::size_t depth = 0;
+    std::unordered_set<InterfaceConfig*> usedInterfaces;
+    bool timeRead = false;
+    Lexer lexer;
+
+    // Held by the parsing functions that call themselves, so that the parser
+    // does not run out of stack either.
+    class Nesting {
+    public:
+        explicit Nesting(Impl& impl) : impl(impl) { ++impl.depth; }
+        ~Nesting() { --impl.depth; }
+
+        Nesting(const Nesting&) = delete;
+        Nesting& operator=(const Nesting&) = delete;
+
+        bool check() {
+            if (this->impl.depth > this->impl.maxDepth) {
+                this->impl.debug << "Error: Expression is nested too deeply"
+                                 << std::endl;
+                return false;
+            }
+            return true;
+        }
+
+    private:
+        Impl& impl;
+    };
+
     std::unique_ptr<Operation> parseExpression() {
-        auto condition = this->parseOr();
+        Nesting nesting{*this};
+        if (!nesting.check()) {
+            return nullptr;
+        }
+        auto condition = this->parseBinary(0);
         if (!condition) {
             return nullptr;
         }
-        this->skipWhitespace();
-        if (this->match('?')) {
+        if (this->lexer.match('?')) {
             auto then = this->parseExpression();
             if (!then) {
                 return nullptr;
             }
-            if (!this->match(':')) {
+            if (!this->lexer.match(':')) {
                 this->debug
                     << "Syntax error: Expected ':' in conditional expression"
                     << std::endl;
@@ -140,281 +385,86 @@ private:
         return condition;
     }
 
-    std::unique_ptr<Operation> parseOr() {
-        auto left = this->parseAnd();
-        if (!left) {
-            return nullptr;
-        }
-        while (true) {
-            this->skipWhitespace();
-            if (this->match("||")) {
-                auto right = this->parseAnd();
-                if (!right) {
-                    return nullptr;
-                }
-                left = std::make_unique<
-                    FoldingOperation<std::logical_or<bool>, translator::Bool>>(
-                    makeOperands(std::move(left), std::move(right)));
-            } else {
-                break;
-            }
+    std::unique_ptr<Operation> parseBinary(int precedence) {
+        if (precedence > maxPrecedence) {
+            return this->parseUnary();
         }
-        return left;
-    }
-
-    std::unique_ptr<Operation> parseAnd() {
-        auto left = this->parseEquality();
+        auto left = this->parseBinary(precedence + 1);
         if (!left) {
             return nullptr;
         }
-        while (true) {
-            this->skipWhitespace();
-            if (this->match("&&")) {
-                auto right = this->parseEquality();
-                if (!right) {
-                    return nullptr;
-                }
-                left = std::make_unique<
-                    FoldingOperation<std::logical_and<bool>, translator::Bool>>(
-                    makeOperands(std::move(left), std::move(right)));
-            } else {
-                break;
+        // The operands of the last operator, which is not made into a node
+        // until it is known whether the next one can be merged into it.
+        std::vector<std::unique_ptr<Operation>> operands;
+        const BinaryOperator* last = nullptr;
+        while (const BinaryOperator* op = this->matchOperator(precedence)) {
+            auto right = this->parseBinary(precedence + 1);
+            if (!right) {
+                return nullptr;
             }
-        }
-        return left;
-    }
-
-    std::unique_ptr<Operation> parseEquality() {
-        auto left = this->parseComparison();
-        if (!left) {
-            return nullptr;
-        }
-        while (true) {
-            this->skipWhitespace();
-            std::unique_ptr<Operation> right;
-            if (this->match("==")) {
-                right = this->parseComparison();
-                if (!right) {
-                    return nullptr;
-                }
-                left = std::make_unique<
-                    Comparison<std::equal_to<float>, translator::Float>>(
-                    makeOperands(std::move(left), std::move(right)));
-            } else if (this->match("!=")) {
-                right = this->parseComparison();
-                if (!right) {
-                    return nullptr;
-                }
-                left = std::make_unique<
-                    Comparison<std::not_equal_to<float>, translator::Float>>(
-                    makeOperands(std::move(left), std::move(right)));
-            } else if (this->match("s==")) {
-                right = this->parseComparison();
-                if (!right) {
-                    return nullptr;
-                }
-                left = std::make_unique<
-                    Comparison<std::equal_to<std::string>, translator::Str>>(
-                    makeOperands(std::move(left), std::move(right)));
-            } else if (this->match("s!=")) {
-                right = this->parseComparison();
-                if (!right) {
-                    return nullptr;
-                }
-                left = std::make_unique<Comparison<
-                    std::not_equal_to<std::string>, translator::Str>>(
-                    makeOperands(std::move(left), std::move(right)));
-            } else {
-                break;
+            if (last && (op->type != last->type || !canFlatten(op->type))) {
+                left = makeOperation(last->type, std::move(operands));
+                operands.clear();
             }
-        }
-        return left;
-    }
-
-    std::unique_ptr<Operation> parseComparison() {
-        auto left = this->parseTerm();
-        if (!left) {
-            return nullptr;
-        }
-        while (true) {
-            this->skipWhitespace();
-            std::unique_ptr<Operation> right;
-            if (this->match("s<=")) {
-                right = this->parseTerm();
-                if (!right) {
-                    return nullptr;
-                }
-                left = std::make_unique<
-                    Comparison<std::less_equal<std::string>, translator::Str>>(
-                    makeOperands(std::move(left), std::move(right)));
-            } else if (this->match("s>=")) {
-                right = this->parseTerm();
-                if (!right) {
-                    return nullptr;
-                }
-                left = std::make_unique<Comparison<
-                    std::greater_equal<std::string>, translator::Str>>(
-                    makeOperands(std::move(left), std::move(right)));
-            } else if (this->match("s<")) {
-                right = this->parseTerm();
-                if (!right) {
-                    return nullptr;
-                }
-                left = std::make_unique<
-                    Comparison<std::less<std::string>, translator::Str>>(
-                    makeOperands(std::move(left), std::move(right)));
-            } else if (this->match("s>")) {
-                right = this->parseTerm();
-                if (!right) {
-                    return nullptr;
-                }
-                left = std::make_unique<
-                    Comparison<std::greater<std::string>, translator::Str>>(
-                    makeOperands(std::move(left), std::move(right)));
-            } else if (this->match("<=")) {
-                right = this->parseTerm();
-                if (!right) {
-                    return nullptr;
-                }
-                left = std::make_unique<
-                    Comparison<std::less_equal<float>, translator::Float>>(
-                    makeOperands(std::move(left), std::move(right)));
-            } else if (this->match(">=")) {
-                right = this->parseTerm();
-                if (!right) {
-                    return nullptr;
-                }
-                left = std::make_unique<
-                    Comparison<std::greater_equal<float>, translator::Float>>(
-                    makeOperands(std::move(left), std::move(right)));
-            } else if (this->match('<')) {
-                right = this->parseTerm();
-                if (!right) {
-                    return nullptr;
-                }
-                left = std::make_unique<
-                    Comparison<std::less<float>, translator::Float>>(
-                    makeOperands(std::move(left), std::move(right)));
-            } else if (this->match('>')) {
-                right = this->parseTerm();
-                if (!right) {
-                    return nullptr;
-                }
-                left = std::make_unique<
-                    Comparison<std::greater<float>, translator::Float>>(
-                    makeOperands(std::move(left), std::move(right)));
-            } else {
-                break;
+            if (operands.empty()) {
+                operands.push_back(std::move(left));
             }
+            operands.push_back(std::move(right));
+            last = op;
         }
-        return left;
-    }
-
-    std::unique_ptr<Operation> parseTerm() {
-        auto left = this->parseFactor();
-        if (!left) {
-            return nullptr;
-        }
-        while (true) {
-            this->skipWhitespace();
-            std::unique_ptr<Operation> right;
-            if (this->match('+')) {
-                right = this->parseFactor();
-                if (!right) {
-                    return nullptr;
-                }
-                left = std::make_unique<
-                    FoldingOperation<std::plus<float>, translator::Float>>(
-                    makeOperands(std::move(left), std::move(right)));
-            } else if (this->match('-')) {
-                right = this->parseFactor();
-                if (!right) {
-                    return nullptr;
-                }
-                left = std::make_unique<
-                    FoldingOperation<std::minus<float>, translator::Float>>(
-                    makeOperands(std::move(left), std::move(right)));
-            } else if (this->match("s+")) {
-                right = this->parseFactor();
-                if (!right) {
-                    return nullptr;
-                }
-                left = std::make_unique<
-                    FoldingOperation<std::plus<std::string>, translator::Str>>(
-                    makeOperands(std::move(left), std::move(right)));
-            } else {
-                break;
-            }
+        if (last) {
+            return makeOperation(last->type, std::move(operands));
         }
         return left;
     }
 
-    std::unique_ptr<Operation> parseFactor() {
-        auto left = this->parseUnary();
-        if (!left) {
-            return nullptr;
-        }
-        while (true) {
-            this->skipWhitespace();
-            std::unique_ptr<Operation> right;
-            if (this->match('*')) {
-                right = this->parseUnary();
-                if (!right) {
-                    return nullptr;
-                }
-                left = std::make_unique<FoldingOperation<
-                    std::multiplies<float>, translator::Float>>(
-                    makeOperands(std::move(left), std::move(right)));
-            } else if (this->match('/')) {
-                right = this->parseUnary();
-                if (!right) {
-                    return nullptr;
-                }
-                left = std::make_unique<
-                    FoldingOperation<std::divides<float>, translator::Float>>(
-                    makeOperands(std::move(left), std::move(right)));
-            } else {
-                break;
+    const BinaryOperator* matchOperator(int precedence) {
+        for (const BinaryOperator& op : binaryOperators) {
+            if (op.precedence == precedence && this->lexer.match(op.token)) {
+                return &op;
             }
         }
-        return left;
+        return nullptr;
     }
 
     std::unique_ptr<Operation> parseUnary() {
-        this->skipWhitespace();
-        if (this->match('!')) {
+        if (this->lexer.match('!')) {
+            Nesting nesting{*this};
+            if (!nesting.check()) {
+                return nullptr;
+            }
             auto operand = this->parseUnary();
             if (!operand) {
                 return nullptr;
             }
-            return std::make_unique<
-                UnaryOperation<std::logical_not<bool>, translator::Bool>>(
-                std::move(operand));
+            std::vector<std::unique_ptr<Operation>> operands;
+            operands.push_back(std::move(operand));
+            return makeOperation(OperatorType::logicalNot, std::move(operands));
         }
-        if (this->match('-')) {
+        if (this->lexer.match('-')) {
+            Nesting nesting{*this};
+            if (!nesting.check()) {
+                return nullptr;
+            }
             auto operand = this->parseUnary();
             if (!operand) {
                 return nullptr;
             }
-            std::vector<std::unique_ptr<Operation>> operands;
-            operands.push_back(std::make_unique<Constant>("0"));
-            operands.push_back(std::move(operand));
-            return std::make_unique<
-                FoldingOperation<std::minus<float>, translator::Float>>(
-                std::move(operands));
+            return makeOperation(
+                OperatorType::subtract,
+                makeOperands(
+                    std::make_unique<Constant>("0"), std::move(operand)));
         }
         return this->parsePrimary();
     }
 
     std::unique_ptr<Operation> parsePrimary() {
-        this->skipWhitespace();
-        if (this->match('(')) {
+        if (this->lexer.match('(')) {
             auto expr = this->parseExpression();
             if (!expr) {
                 return nullptr;
             }
-            this->skipWhitespace();
-            if (!this->match(')')) {
+            if (!this->lexer.match(')')) {
                 this->debug << "Syntax error: Unmatched closing parenthesis"
                             << std::endl;
                 return nullptr;
@@ -422,155 +472,302 @@ private:
             return expr;
         }
 
-        if (this->match('\'')) {
+        if (this->lexer.match('\'')) {
             return this->parseStringLiteral();
         }
 
-        if (this->match("true") || this->match("on")) {
+        std::string_view function = this->lexer.matchCall();
+        if (function == "since") {
+            return this->parseSince();
+        }
+        if (!function.empty()) {
+            return this->parseCall(function);
+        }
+
+        if (this->lexer.match("true") || this->lexer.match("on")) {
             return std::make_unique<Constant>("1");
         }
 
-        if (this->match("false") || this->match("off")) {
+        if (this->lexer.match("false") || this->lexer.match("off")) {
             return std::make_unique<Constant>("0");
         }
 
-        if (this->match('[')) {
+        if (this->lexer.match('[')) {
             return this->parseInterfaceValue();
         }
 
-        if (this->match('%')) {
+        if (this->lexer.match('%')) {
             return this->parseDefaultInterfaceValue();
         }
 
         return this->parseNumber();
     }
 
-    std::unique_ptr<Operation> parseStringLiteral() {
-        std::string value;
-        while (this->pos < this->data.size()) {
-            if (this->data[this->pos] == '\\' &&
-                this->pos + 1 < this->data.size()) {
-                value += this->data[this->pos];
-                ++this->pos;
-                if (this->pos < this->data.size()) {
-                    value += this->data[this->pos];
-                    ++this->pos;
+    std::unique_ptr<Operation> parseCall(std::string_view name) {
+        std::vector<std::unique_ptr<Operation>> arguments;
+        if (!this->lexer.match(')')) {
+            do {
+                auto argument = this->parseExpression();
+                if (!argument) {
+                    return nullptr;
                 }
-            } else if (this->data[this->pos] == '\'') {
-                ++this->pos;
-                return std::make_unique<Constant>(unescapeString(value));
-            } else {
-                value += this->data[this->pos];
-                ++this->pos;
+                arguments.push_back(std::move(argument));
+            } while (this->lexer.match(','));
+            if (!this->lexer.match(')')) {
+                this->debug << "Syntax error: Expected ')' after arguments"
+                            << std::endl;
+                return nullptr;
             }
         }
-        this->debug << "Syntax error: Unmatched quote" << std::endl;
-        return nullptr;
+        return this->makeFunction(name, std::move(arguments));
     }
 
-    std::unique_ptr<Operation> parseNumber() {
-        this->skipWhitespace();
-        size_t start = this->pos;
-        if (this->pos < this->data.size() &&
-            (this->data[this->pos] == '-' || this->data[this->pos] == '+')) {
-            ++this->pos;
+    std::unique_ptr<Operation> makeFunction(
+        std::string_view name,
+        std::vector<std::unique_ptr<Operation>> arguments) {
+        if (name == "avg" || name == "min" || name == "max") {
+            std::size_t size = 0;
+            if (!this->checkArgumentCount(name, arguments, 2) ||
+                !this->getWindowSize(name, arguments[1], size)) {
+                return nullptr;
+            }
+            auto& operand = arguments[0];
+            if (name == "avg") {
+                return std::make_unique<MovingAverage>(
+                    std::move(operand), size);
+            }
+            if (name == "min") {
+                return std::make_unique<MovingMinimum>(
+                    std::move(operand), size);
+            }
+            return std::make_unique<MovingMaximum>(std::move(operand), size);
         }
-        bool hasDigit = false;
-        while (this->pos < this->data.size() &&
-               (std::isdigit(this->data[this->pos]) ||
-                this->data[this->pos] == '.')) {
-            if (std::isdigit(this->data[this->pos])) {
-                hasDigit = true;
+        if (name == "ema") {
+            float alpha = 0.0f;
+            if (!this->checkArgumentCount(name, arguments, 2) ||
+                !this->getConstantNumber(name, arguments[1], alpha)) {
+                return nullptr;
             }
-            ++this->pos;
+            if (!(alpha > 0.0f && alpha <= 1.0f)) {
+                this->debug << "Error: " << name
+                            << "(): Factor must be above 0 and at most 1"
+                            << std::endl;
+                return nullptr;
+            }
+            return std::make_unique<ExponentialAverage>(
+                std::move(arguments[0]), alpha);
         }
-        if (!hasDigit) {
-            this->debug << "Syntax error: Expected number" << std::endl;
+        if (name == "rate") {
+            if (!this->checkArgumentCount(name, arguments, 1) ||
+                !this->checkTime(name)) {
+                return nullptr;
+            }
+            return std::make_unique<Rate>(std::move(arguments[0]), *this->esp);
+        }
+        if (name == "now") {
+            if (!this->checkArgumentCount(name, arguments, 0) ||
+                !this->checkTime(name)) {
+                return nullptr;
+            }
+            return std::make_unique<Now>(*this->esp);
+        }
+        if (name == "hyst") {
+            if (!this->checkArgumentCount(name, arguments, 3)) {
+                return nullptr;
+            }
+            return std::make_unique<Hysteresis>(
+                std::move(arguments[0]), std::move(arguments[1]),
+                std::move(arguments[2]));
+        }
+        if (name == "changed") {
+            if (!this->checkArgumentCount(name, arguments, 1)) {
+                return nullptr;
+            }
+            return std::make_unique<Changed>(std::move(arguments[0]));
+        }
+        this->debug << "Error: Unknown function: " << name << std::endl;
+        return nullptr;
+    }
+
+    // since() takes an interface instead of a value, or nothing for the
+    // default interface.
+    std::unique_ptr<Operation> parseSince() {
+        InterfaceConfig* interface = nullptr;
+        if (this->lexer.match('[')) {
+            std::string storage;
+            std::string_view name;
+            if (!this->readInterfaceName(storage, name)) {
+                return nullptr;
+            }
+            interface = this->findInterface(name);
+            if (!interface) {
+                return nullptr;
+            }
+        } else if (!this->defaultInterface) {
+            this->debug << "Error: No default interface" << std::endl;
+            return nullptr;
+        } else {
+            interface = this->defaultInterface;
+            this->usedInterfaces.insert(interface);
+        }
+        if (!this->lexer.match(')')) {
+            this->debug << "Syntax error: Expected ')' after arguments"
+                        << std::endl;
+            return nullptr;
+        }
+        if (!this->checkTime("since")) {
+            return nullptr;
+        }
+        return std::make_unique<Since>(interface, *this->esp);
+    }
+
+    bool checkTime(std::string_view name) {
+        if (!this->esp) {
+            this->debug << "Error: " << name << "(): Time is not available"
+                        << std::endl;
+            return false;
+        }
+        this->timeRead = true;
+        return true;
+    }
+
+    bool checkArgumentCount(
+        std::string_view name,
+        const std::vector<std::unique_ptr<Operation>>& arguments,
+        std::size_t count) {
+        if (arguments.size() != count) {
+            this->debug << "Error: " << name << "() takes " << count
+                        << " arguments, got " << arguments.size()
+                        << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    bool getConstantNumber(
+        std::string_view name, std::unique_ptr<Operation>& argument,
+        float& result) {
+        argument = optimize(std::move(argument));
+        const TypedValue* value = argument->getConstantValue();
+        if (!value) {
+            this->debug << "Error: " << name
+                        << "(): Argument must be constant" << std::endl;
+            return false;
+        }
+        result = value->asNumber();
+        return true;
+    }
+
+    bool getWindowSize(
+        std::string_view name, std::unique_ptr<Operation>& argument,
+        std::size_t& result) {
+        float size = 0.0f;
+        if (!this->getConstantNumber(name, argument, size)) {
+            return false;
+        }
+        if (!(size >= 1.0f && size <= maxWindowSize) ||
+            size != static_cast<std::size_t>(size)) {
+            this->debug << "Error: " << name
+                        << "(): Window size must be a whole number from 1 to "
+                        << maxWindowSize << std::endl;
+            return false;
+        }
+        result = static_cast<std::size_t>(size);
+        return true;
+    }
+
+    std::unique_ptr<Operation> parseStringLiteral() {
+        std::string_view value;
+        bool escaped = false;
+        if (!this->lexer.readDelimited('\'', value, escaped)) {
+            this->debug << "Syntax error: Unmatched quote" << std::endl;
             return nullptr;
         }
         return std::make_unique<Constant>(
-            this->data.substr(start, this->pos - start));
+            escaped ? unescapeString(value) : std::string{value});
     }
 
-    std::unique_ptr<Operation> parseInterfaceValue() {
-        std::string name;
-        while (this->pos < this->data.size() && this->data[this->pos] != ']') {
-            if (this->data[this->pos] == '\\' &&
-                this->pos + 1 < this->data.size()) {
-                ++this->pos;
-                if (this->pos < this->data.size()) {
-                    name += this->data[this->pos];
-                    ++this->pos;
-                }
-            } else {
-                name += this->data[this->pos];
-                ++this->pos;
+    std::unique_ptr<Operation> parseNumber() {
+        std::string_view number = this->lexer.readNumber();
+        if (number.empty()) {
+            this->debug << "Syntax error: Expected number" << std::endl;
+            return nullptr;
+        }
+        std::string_view unitName = this->lexer.readUnit();
+        if (unitName.empty()) {
+            return std::make_unique<Constant>(std::string{number});
+        }
+        for (const Unit& unit : units) {
+            if (unit.name == unitName) {
+                return std::make_unique<Constant>(TypedValue::fromNumber(
+                    tools::parseDouble(std::string{number}.c_str()) *
+                    unit.milliseconds));
             }
         }
+        this->debug << "Syntax error: Unknown unit: " << unitName << std::endl;
+        return nullptr;
+    }
 
-        if (!this->match(']')) {
+    // Reads the name after the opening bracket. Escaped names are stored in
+    // storage.
+    bool readInterfaceName(std::string& storage, std::string_view& name) {
+        bool escaped = false;
+        if (!this->lexer.readDelimited(']', name, escaped)) {
             this->debug << "Syntax error: Unmatched closing bracket"
                         << std::endl;
+            return false;
+        }
+        if (escaped) {
+            storage = unescapeName(name);
+            name = storage;
+        }
+        return true;
+    }
+
+    InterfaceConfig* findInterface(std::string_view name) {
+        InterfaceConfig* interface = this->interfaces.find(name);
+        if (!interface) {
+            this->debug << "Error: Interface not found: " << name << std::endl;
+            return nullptr;
+        }
+        this->usedInterfaces.insert(interface);
+        return interface;
+    }
+
+    std::unique_ptr<Operation> parseInterfaceValue() {
+        std::string unescaped;
+        std::string_view name;
+        if (!this->readInterfaceName(unescaped, name)) {
             return nullptr;
         }
 
         std::size_t index = 1;
-        if (this->match('.')) {
-            this->skipWhitespace();
-            size_t indexStart = this->pos;
-            while (this->pos < this->data.size() &&
-                   std::isdigit(this->data[this->pos])) {
-                ++this->pos;
-            }
-            if (indexStart == this->pos) {
-                this->debug << "Syntax error: Bad value number" << std::endl;
-                return nullptr;
-            }
-            std::string indexStr =
-                this->data.substr(indexStart, this->pos - indexStart);
-            char* endPtr;
-            errno = 0;
-            index = std::strtoul(indexStr.c_str(), &endPtr, 10);
-            if (errno != 0 || endPtr != indexStr.c_str() + indexStr.size()) {
+        if (this->lexer.match('.')) {
+            this->lexer.skipWhitespace();
+            std::string_view digits = this->lexer.readDigits();
+            if (digits.empty() || !parseIndex(digits, index)) {
                 this->debug << "Syntax error: Bad value number" << std::endl;
                 return nullptr;
             }
         }
 
-        InterfaceConfig* interface = nullptr;
-        for (const auto& itf : this->interfaces) {
-            if (itf && itf->name == name) {
-                interface = itf;
-                break;
-            }
-        }
-
+        InterfaceConfig* interface = this->findInterface(name);
         if (!interface) {
-            this->debug << "Error: Interface not found: " << name << std::endl;
             return nullptr;
         }
-
-        this->usedInterfaces.insert(interface);
         return std::make_unique<Value>(interface, index);
     }
 
     std::unique_ptr<Operation> parseDefaultInterfaceValue() {
-        size_t start = this->pos;
-        while (this->pos < this->data.size() &&
-               std::isdigit(this->data[this->pos])) {
-            ++this->pos;
-        }
-        if (start == this->pos) {
+        std::string_view digits = this->lexer.readDigits();
+        if (digits.empty()) {
             this->debug << "Syntax error: Expected digit after '%'"
                         << std::endl;
             return nullptr;
         }
 
-        std::string indexStr = this->data.substr(start, this->pos - start);
-        char* endPtr;
-        errno = 0;
-        std::size_t index = std::strtoul(indexStr.c_str(), &endPtr, 10);
-        if (errno != 0 || endPtr != indexStr.c_str() + indexStr.size()) {
+        std::size_t index = 0;
+        if (!parseIndex(digits, index)) {
             this->debug << "Syntax error: Bad value number" << std::endl;
             return nullptr;
         }
@@ -588,21 +785,63 @@ private:
 Parser2::Parser2(
     std::ostream& debug,
     const std::vector<std::unique_ptr<InterfaceConfig>>& interfaces,
-    InterfaceConfig* defaultInterface)
+    InterfaceConfig* defaultInterface, EspApi* esp)
     : debug(debug)
-    , interfaces(interfaces.size(), nullptr)
-    , defaultInterface(defaultInterface) {
-    std::transform(
-        interfaces.begin(), interfaces.end(), this->interfaces.begin(),
-        [](const std::unique_ptr<InterfaceConfig>& interface) {
-        return interface.get();
-    });
-}
+    , ownInterfaces(interfaces)
+    , interfaces(this->ownInterfaces)
+    , defaultInterface(defaultInterface)
+    , esp(esp) {}
 
-std::unique_ptr<Operation> Parser2::parse(const std::string& data) {
-    Impl parser(this->debug, this->interfaces, this->defaultInterface);
-    auto result = parser.parse(data);
+Parser2::Parser2(
+    std::ostream& debug, const InterfaceRegistry& interfaces,
+    InterfaceConfig* defaultInterface, EspApi* esp)
+    : debug(debug)
+    , interfaces(interfaces)
+    , defaultInterface(defaultInterface)
+    , esp(esp) {}
+
+Parser2::Statistics Parser2::statistics;
+
+std::unique_ptr<Operation> Parser2::parse(std::string_view data) {
+    std::size_t bytesBefore = tools::ArenaAllocated::getLiveBytes();
+    Impl parser(
+        this->debug, this->interfaces, this->defaultInterface, this->esp,
+        this->limits.depth, data);
+    auto result = parser.parse();
     this->usedInterfaces = std::move(parser).getUsedInterfaces();
+    this->timeRead = parser.readsTime();
+    if (!result) {
+        return nullptr;
+    }
+    result = optimize(std::move(result));
+
+    Statistics size;
+    measure(*result, 1, this->limits.depth, size);
+    size.bytes = tools::ArenaAllocated::getLiveBytes() - bytesBefore;
+    if (size.depth > this->limits.depth) {
+        this->debug << "Error: Expression is too deep, at most "
+                    << this->limits.depth << " levels are allowed"
+                    << std::endl;
+        return nullptr;
+    }
+    if (size.nodes > this->limits.nodes) {
+        this->debug << "Error: Expression has " << size.nodes
+                    << " nodes, at most " << this->limits.nodes
+                    << " are allowed" << std::endl;
+        return nullptr;
+    }
+    if (size.bytes > this->limits.bytes) {
+        this->debug << "Error: Expression takes " << size.bytes
+                    << " bytes, at most " << this->limits.bytes
+                    << " are allowed" << std::endl;
+        return nullptr;
+    }
+
+    ++Parser2::statistics.expressions;
+    Parser2::statistics.nodes += size.nodes;
+    Parser2::statistics.bytes += size.bytes;
+    Parser2::statistics.depth =
+        std::max(Parser2::statistics.depth, size.depth);
     return result;
 }
 
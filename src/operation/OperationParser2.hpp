@@ -1,25 +1,58 @@
 #ifndef OPERATIONPARSER2_HPP
 #define OPERATIONPARSER2_HPP
 
+#include <cstddef>
 #include <memory>
 #include <ostream>
+#include <string_view>
 #include <unordered_set>
 #include <vector>
 
+#include "../common/InterfaceConfig.hpp"
 #include "Operation.hpp"
 
-class InterfaceConfig;
+class EspApi;
 
 namespace operation {
 
 class Parser2 {
 public:
+    // Evaluating an operation recurses once for each level of its tree and
+    // the stack of the device is small, so expressions that go over any of
+    // these are rejected.
+    struct Limits {
+        std::size_t depth = 16;
+        std::size_t nodes = 128;
+        // The size of the nodes, not counting the strings and vectors they
+        // own.
+        std::size_t bytes = 4096;
+    };
+
+    // The totals of the expressions parsed so far, to see how close the
+    // configuration gets to running out of memory.
+    struct Statistics {
+        std::size_t expressions = 0;
+        std::size_t nodes = 0;
+        std::size_t bytes = 0;
+        // The deepest expression.
+        std::size_t depth = 0;
+    };
+
+    // Builds a registry of the interfaces for this parser only. Functions that
+    // depend on the time can only be used if esp is given.
     Parser2(
         std::ostream& debug,
         const std::vector<std::unique_ptr<InterfaceConfig>>& interfaces,
-        InterfaceConfig* defaultInterface);
+        InterfaceConfig* defaultInterface, EspApi* esp = nullptr);
+    Parser2(
+        std::ostream& debug, const InterfaceRegistry& interfaces,
+        InterfaceConfig* defaultInterface, EspApi* esp = nullptr);
+    Parser2(const Parser2&) = delete;
+    Parser2& operator=(const Parser2&) = delete;
 
-    std::unique_ptr<Operation> parse(const std::string& data);
+    void setLimits(const Limits& limits) { this->limits = limits; }
+
+    std::unique_ptr<Operation> parse(std::string_view data);
 
     const std::unordered_set<InterfaceConfig*>& getUsedInterfaces() const& {
         return usedInterfaces;
@@ -27,12 +60,23 @@ public:
     std::unordered_set<InterfaceConfig*>&& getUsedInterfaces() && {
         return std::move(usedInterfaces);
     }
+    // Whether the last expression uses functions that read the time, so its
+    // value may change without any interface changing.
+    bool readsTime() const { return this->timeRead; }
+
+    static const Statistics& getStatistics() { return Parser2::statistics; }
 
 private:
     std::ostream& debug;
-    std::vector<InterfaceConfig*> interfaces;
+    InterfaceRegistry ownInterfaces;
+    const InterfaceRegistry& interfaces;
     InterfaceConfig* defaultInterface;
+    EspApi* esp;
+    Limits limits;
     std::unordered_set<InterfaceConfig*> usedInterfaces;
+    bool timeRead = false;
+
+    static Statistics statistics;
 };
 
 }  // namespace operation
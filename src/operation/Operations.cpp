@@ -1,35 +1,206 @@
 #include "Operations.hpp"
 
-#include "../tools/string.hpp"
+#include <limits>
 
 namespace operation {
 
-std::string Constant::evaluate() {
-    return this->value;
+TypedValue Constant::evaluateValue() {
+    return this->value.toReference();
 }
 
-std::string Value::evaluate() {
-    if (!this->interface) {
-        return {};
+TypedValue Value::evaluateValue() {
+    return TypedValue::fromReference(Value::get(this->interface, this->index));
+}
+
+bool Value::getDependencies(
+    std::vector<const InterfaceConfig*>& interfaces) const {
+    if (this->interface) {
+        interfaces.push_back(this->interface);
     }
-    if (this->index > this->interface->storedValue.size()) {
-        return {};
+    return true;
+}
+
+const std::string& Value::get(
+    const InterfaceConfig* interface, std::size_t index) {
+    static const std::string empty;
+    if (!interface) {
+        return empty;
+    }
+    if (index > interface->storedValue.size()) {
+        return empty;
     }
-    return this->interface->storedValue[this->index - 1];
+    return interface->storedValue[index - 1];
 }
 
-std::string Template::evaluate() {
+TypedValue Template::evaluateValue() {
     if (!this->interface) {
-        return this->template_;
+        return TypedValue::fromReference(this->template_);
+    }
+    return TypedValue::fromString(
+        this->compiled.substitute(this->interface->storedValue));
+}
+
+bool Template::getDependencies(
+    std::vector<const InterfaceConfig*>& interfaces) const {
+    if (this->interface) {
+        interfaces.push_back(this->interface);
+    }
+    return true;
+}
+
+TypedValue Conditional::evaluateValue() {
+    return this->condition->evaluateValue().asBool()
+               ? this->then->evaluateValue()
+               : this->else_->evaluateValue();
+}
+
+std::optional<TypedValue::Type> Conditional::getResultType() const {
+    auto type = this->then->getResultType();
+    return type == this->else_->getResultType() ? type : std::nullopt;
+}
+
+std::unique_ptr<Operation> Conditional::simplify() {
+    this->condition = optimize(std::move(this->condition));
+    this->then = optimize(std::move(this->then));
+    this->else_ = optimize(std::move(this->else_));
+    if (const TypedValue* value = this->condition->getConstantValue()) {
+        return std::move(value->asBool() ? this->then : this->else_);
     }
-    return tools::substitute(this->template_, this->interface->storedValue);
+    return nullptr;
 }
 
-std::string Conditional::evaluate() {
-    bool value = false;
-    auto valueStr = this->condition->evaluate();
-    tools::getBoolValue(valueStr.c_str(), value, valueStr.size());
-    return value ? this->then->evaluate() : this->else_->evaluate();
+void Conditional::compile(Compiler& compiler) {
+    this->condition->compile(compiler);
+    auto jumpToElse = compiler.addJumpIfFalse();
+    this->then->compile(compiler);
+    auto jumpToEnd = compiler.addJump();
+    compiler.dropValue();
+    compiler.setJumpTarget(jumpToElse);
+    this->else_->compile(compiler);
+    compiler.setJumpTarget(jumpToEnd);
+}
+
+bool Conditional::generate(Generator& generator) {
+    if (!this->condition->generate(generator)) {
+        return false;
+    }
+    generator.beginIf();
+    if (!this->then->generate(generator)) {
+        return false;
+    }
+    generator.beginElse();
+    if (!this->else_->generate(generator)) {
+        return false;
+    }
+    generator.endIf();
+    return true;
+}
+
+void Conditional::forEachOperand(
+    const std::function<void(std::unique_ptr<Operation>&)>& function) {
+    function(this->condition);
+    function(this->then);
+    function(this->else_);
+}
+
+void Operation::compile(Compiler& compiler) {
+    compiler.addEvaluate(*this);
+}
+
+std::optional<unsigned long> Operation::getNextChange(unsigned long now) {
+    std::optional<unsigned long> result;
+    this->forEachOperand([&](std::unique_ptr<Operation>& operand) {
+        result = detail::earliest(now, result, operand->getNextChange(now));
+    });
+    return result;
+}
+
+bool Operation::keepsState() {
+    bool result = false;
+    this->forEachOperand([&](std::unique_ptr<Operation>& operand) {
+        result = result || operand->keepsState();
+    });
+    return result;
+}
+
+namespace detail {
+
+void optimizeAll(std::vector<std::unique_ptr<Operation>>& operations) {
+    for (auto& operation : operations) {
+        operation = optimize(std::move(operation));
+    }
+}
+
+bool areConstant(const std::vector<std::unique_ptr<Operation>>& operations) {
+    return std::all_of(
+        operations.begin(), operations.end(),
+        [](const std::unique_ptr<Operation>& operation) {
+        return operation->getConstantValue() != nullptr;
+    });
+}
+
+bool generateAll(
+    Generator& generator,
+    const std::vector<std::unique_ptr<Operation>>& operations) {
+    return std::all_of(
+        operations.begin(), operations.end(),
+        [&](const std::unique_ptr<Operation>& operation) {
+        return operation->generate(generator);
+    });
+}
+
+std::optional<unsigned long> earliest(
+    unsigned long now, std::optional<unsigned long> lhs,
+    std::optional<unsigned long> rhs) {
+    if (!lhs || !rhs) {
+        return lhs ? lhs : rhs;
+    }
+    // Counted from now, so that it works when millis() wraps around.
+    return *lhs - now < *rhs - now ? lhs : rhs;
+}
+
+std::optional<TimeLimit> getTimeLimit(
+    const Operation& lhs, const Operation& rhs) {
+    if (auto origin = lhs.getTimeOrigin()) {
+        if (const TypedValue* limit = rhs.getConstantValue()) {
+            return TimeLimit{*origin, limit->asNumber(), true};
+        }
+    } else if (auto origin = rhs.getTimeOrigin()) {
+        if (const TypedValue* limit = lhs.getConstantValue()) {
+            return TimeLimit{*origin, limit->asNumber(), false};
+        }
+    }
+    return std::nullopt;
+}
+
+std::optional<unsigned long> firstElapsed(float limit, bool inclusive) {
+    auto reached = [&](unsigned long elapsed) {
+        const float value = static_cast<float>(elapsed);
+        return inclusive ? value >= limit : value > limit;
+    };
+    unsigned long low = 0;
+    unsigned long high = std::numeric_limits<unsigned long>::max();
+    if (!reached(high)) {
+        return std::nullopt;
+    }
+    while (low < high) {
+        const unsigned long middle = low + (high - low) / 2;
+        if (reached(middle)) {
+            high = middle;
+        } else {
+            low = middle + 1;
+        }
+    }
+    return low;
+}
+
+}  // namespace detail
+
+std::unique_ptr<Operation> optimize(std::unique_ptr<Operation> operation) {
+    while (auto simplified = operation->simplify()) {
+        operation = std::move(simplified);
+    }
+    return operation;
 }
 
 }  // namespace operation
@@ -2,22 +2,56 @@
 #define OPERATION_OPERATIONS_HPP
 
 #include <algorithm>
+#include <cmath>
+#include <functional>
 #include <numeric>
+#include <optional>
 #include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 #include "../common/InterfaceConfig.hpp"
+#include "../tools/string.hpp"
+#include "Batch.hpp"
+#include "Generator.hpp"
 #include "Operation.hpp"
+#include "Program.hpp"
 #include "Translator.hpp"
 
 namespace operation {
 
 class Constant : public Operation {
 public:
-    explicit Constant(const std::string& value) : value(value) {}
-    std::string evaluate() override;
+    explicit Constant(const std::string& value)
+        : value(TypedValue::fromString(value)) {}
+    explicit Constant(const TypedValue& value) : value(value.toOwned()) {}
+
+    TypedValue evaluateValue() override;
+    const TypedValue* getConstantValue() const override {
+        return &this->value;
+    }
+    std::optional<TypedValue::Type> getResultType() const override {
+        return this->value.getType();
+    }
+    void compile(Compiler& compiler) override {
+        compiler.addConstant(this->value);
+    }
+    bool generate(Generator& generator) override {
+        generator.addConstant(this->value);
+        return true;
+    }
+    bool vectorize(Batch& batch) override {
+        batch.addConstant(this->value);
+        return true;
+    }
+    bool getDependencies(
+        std::vector<const InterfaceConfig*>& /*interfaces*/) const override {
+        return true;
+    }
 
 private:
-    std::string value;
+    TypedValue value;
 };
 
 class Value : public Operation {
@@ -25,7 +59,26 @@ public:
     Value(const InterfaceConfig* interface, std::size_t index)
         : interface(interface), index(index) {}
 
-    std::string evaluate() override;
+    TypedValue evaluateValue() override;
+    std::optional<TypedValue::Type> getResultType() const override {
+        return TypedValue::Type::string;
+    }
+    void compile(Compiler& compiler) override {
+        compiler.addValue(this->interface, this->index);
+    }
+    bool generate(Generator& generator) override {
+        generator.addValue(this->interface, this->index);
+        return true;
+    }
+    bool vectorize(Batch& batch) override {
+        batch.addValue(this->interface, this->index);
+        return true;
+    }
+    bool getDependencies(
+        std::vector<const InterfaceConfig*>& interfaces) const override;
+
+    static const std::string& get(
+        const InterfaceConfig* interface, std::size_t index);
 
 private:
     const InterfaceConfig* interface;
@@ -35,13 +88,19 @@ private:
 class Template : public Operation {
 public:
     Template(const InterfaceConfig* interface, const std::string& template_)
-        : interface(interface), template_(template_) {}
+        : interface(interface), template_(template_), compiled(template_) {}
 
-    std::string evaluate() override;
+    TypedValue evaluateValue() override;
+    std::optional<TypedValue::Type> getResultType() const override {
+        return TypedValue::Type::string;
+    }
+    bool getDependencies(
+        std::vector<const InterfaceConfig*>& interfaces) const override;
 
 private:
     const InterfaceConfig* interface;
     std::string template_;
+    tools::ValueTemplate compiled;
 };
 
 class Conditional : public Operation {
@@ -53,7 +112,18 @@ public:
         , then(std::move(then))
         , else_(std::move(else_)) {}
 
-    std::string evaluate() override;
+    TypedValue evaluateValue() override;
+    std::optional<TypedValue::Type> getResultType() const override;
+    std::unique_ptr<Operation> simplify() override;
+    void compile(Compiler& compiler) override;
+    bool generate(Generator& generator) override;
+    bool getDependencies(
+        std::vector<const InterfaceConfig*>& /*interfaces*/) const override {
+        return true;
+    }
+    void forEachOperand(
+        const std::function<void(std::unique_ptr<Operation>&)>& function)
+        override;
 
 private:
     std::unique_ptr<Operation> condition;
@@ -61,6 +131,121 @@ private:
     std::unique_ptr<Operation> else_;
 };
 
+namespace detail {
+
+void optimizeAll(std::vector<std::unique_ptr<Operation>>& operations);
+bool areConstant(const std::vector<std::unique_ptr<Operation>>& operations);
+bool generateAll(
+    Generator& generator,
+    const std::vector<std::unique_ptr<Operation>>& operations);
+// The earlier of two times after now.
+std::optional<unsigned long> earliest(
+    unsigned long now, std::optional<unsigned long> lhs,
+    std::optional<unsigned long> rhs);
+
+// A time elapsed since origin, compared with a constant.
+struct TimeLimit {
+    unsigned long origin;
+    float limit;
+    // Whether the time is the left operand.
+    bool timeFirst;
+};
+
+std::optional<TimeLimit> getTimeLimit(
+    const Operation& lhs, const Operation& rhs);
+// The smallest elapsed time in milliseconds that is at least, or if
+// inclusive is false above, the limit once converted to float, the way
+// since() and now() give it.
+std::optional<unsigned long> firstElapsed(float limit, bool inclusive);
+
+// Operands that can be left out of a fold without changing its result. The
+// first operand of a non-commutative operation cannot be left out.
+template <typename Operator>
+struct Neutral {
+    template <typename Type>
+    static bool is(const Type& /*value*/, bool /*first*/) {
+        return false;
+    }
+};
+
+template <>
+struct Neutral<std::plus<float>> {
+    static bool is(float value, bool /*first*/) { return value == 0.0f; }
+};
+
+template <>
+struct Neutral<std::minus<float>> {
+    static bool is(float value, bool first) { return !first && value == 0.0f; }
+};
+
+template <>
+struct Neutral<std::multiplies<float>> {
+    static bool is(float value, bool /*first*/) { return value == 1.0f; }
+};
+
+template <>
+struct Neutral<std::divides<float>> {
+    static bool is(float value, bool first) { return !first && value == 1.0f; }
+};
+
+template <>
+struct Neutral<std::plus<std::string>> {
+    static bool is(const std::string& value, bool /*first*/) {
+        return value.empty();
+    }
+};
+
+template <>
+struct Neutral<std::logical_and<bool>> {
+    static bool is(bool value, bool /*first*/) { return value; }
+};
+
+template <>
+struct Neutral<std::logical_or<bool>> {
+    static bool is(bool value, bool /*first*/) { return !value; }
+};
+
+// Operands that determine the result of a fold regardless of the others.
+template <typename Operator>
+struct Absorbing {
+    template <typename Type>
+    static bool is(const Type& /*value*/) {
+        return false;
+    }
+};
+
+template <>
+struct Absorbing<std::logical_and<bool>> {
+    static bool is(bool value) { return !value; }
+};
+
+template <>
+struct Absorbing<std::logical_or<bool>> {
+    static bool is(bool value) { return value; }
+};
+
+// Logical operators whose compiled form jumps to the end as soon as an
+// operand converts to the given result.
+template <typename Operator>
+struct ShortCircuit {
+    static constexpr bool enabled = false;
+    static constexpr bool result = false;
+};
+
+template <>
+struct ShortCircuit<std::logical_and<bool>> {
+    static constexpr bool enabled = true;
+    static constexpr bool result = false;
+};
+
+template <>
+struct ShortCircuit<std::logical_or<bool>> {
+    static constexpr bool enabled = true;
+    static constexpr bool result = true;
+};
+
+}  // namespace detail
+
 template <typename Operator, typename Translator>
 class FoldingOperation : public Operation {
 public:
@@ -71,21 +256,153 @@ public:
         , operator_(std::move(operator_))
         , translator(std::move(translator)) {}
 
-    std::string evaluate() override {
-        using Type =
-            decltype(translator.fromString(std::declval<std::string>()));
+    TypedValue evaluateValue() override {
+        using Type = std::decay_t<decltype(translator.fromValue(
+            std::declval<const TypedValue&>()))>;
         if (operands.empty()) {
-            return translator.toString(Type{});
+            return translator.toValue(Type{});
+        }
+        Type result{translator.fromValue(operands.front()->evaluateValue())};
+        for (auto it = operands.begin() + 1; it != operands.end(); ++it) {
+            // The remaining operands cannot change the result.
+            if (detail::Absorbing<Operator>::is(result)) {
+                break;
+            }
+            result =
+                operator_(result, translator.fromValue((*it)->evaluateValue()));
+        }
+        return translator.toValue(std::move(result));
+    }
+
+    std::optional<TypedValue::Type> getResultType() const override {
+        return Translator::type;
+    }
+
+    std::unique_ptr<Operation> simplify() override {
+        detail::optimizeAll(operands);
+        if (detail::areConstant(operands)) {
+            return std::make_unique<Constant>(this->evaluateValue());
         }
-        return translator.toString(
+
+        for (auto it = operands.begin(); it != operands.end();) {
+            if (const TypedValue* constant = (*it)->getConstantValue()) {
+                auto&& value = translator.fromValue(*constant);
+                if (detail::Absorbing<Operator>::is(value)) {
+                    return std::make_unique<Constant>(
+                        translator.toValue(value));
+                }
+                if (detail::Neutral<Operator>::is(
+                        value, it == operands.begin())) {
+                    it = operands.erase(it);
+                    continue;
+                }
+            }
+            ++it;
+        }
+
+        // A single operand is only converted. Numbers are kept converted
+        // because the conversion rounds them to the printed precision.
+        if (operands.size() == 1 &&
+            Translator::type != TypedValue::Type::number &&
+            operands.front()->getResultType() == Translator::type) {
+            return std::move(operands.front());
+        }
+        return nullptr;
+    }
+
+    void compile(Compiler& compiler) override {
+        if constexpr (detail::ShortCircuit<Operator>::enabled) {
+            if (!operands.empty()) {
+                // Only the last operand is left to convert when no jump was
+                // taken.
+                std::vector<std::size_t> jumps;
+                for (auto it = operands.begin(); it != operands.end() - 1;
+                     ++it) {
+                    (*it)->compile(compiler);
+                    jumps.push_back(compiler.addJumpOrPop(
+                        detail::ShortCircuit<Operator>::result));
+                }
+                operands.back()->compile(compiler);
+                compiler.addCall(&FoldingOperation::apply, 1);
+                for (auto jump : jumps) {
+                    compiler.setJumpTarget(jump);
+                }
+                return;
+            }
+        }
+        for (const auto& operand : operands) {
+            operand->compile(compiler);
+        }
+        compiler.addCall(&FoldingOperation::apply, operands.size());
+    }
+
+    bool generate(Generator& generator) override {
+        const std::string function =
+            detail::applyName<Operator, Translator>("FoldingOperation");
+        if constexpr (detail::ShortCircuit<Operator>::enabled) {
+            if (!operands.empty()) {
+                generator.beginBlock();
+                for (auto it = operands.begin(); it != operands.end() - 1;
+                     ++it) {
+                    if (!(*it)->generate(generator)) {
+                        return false;
+                    }
+                    generator.addBreakIf(
+                        detail::ShortCircuit<Operator>::result);
+                }
+                if (!operands.back()->generate(generator)) {
+                    return false;
+                }
+                generator.addCall(function, 1);
+                generator.endBlock();
+                return true;
+            }
+        }
+        if (!detail::generateAll(generator, operands)) {
+            return false;
+        }
+        generator.addCall(function, operands.size());
+        return true;
+    }
+
+    bool vectorize(Batch& batch) override {
+        if constexpr (std::is_same_v<Translator, translator::Float>) {
+            for (const auto& operand : operands) {
+                batch.add(*operand);
+            }
+            batch.addFold<Operator>(operands.size());
+            return true;
+        }
+        return false;
+    }
+
+    bool getDependencies(
+        std::vector<const InterfaceConfig*>& /*interfaces*/) const override {
+        return true;
+    }
+
+    void forEachOperand(
+        const std::function<void(std::unique_ptr<Operation>&)>& function)
+        override {
+        std::for_each(operands.begin(), operands.end(), function);
+    }
+
+    static void apply(TypedValue* operands, std::size_t count) {
+        Operator operator_;
+        Translator translator;
+        using Type = std::decay_t<decltype(translator.fromValue(
+            std::declval<const TypedValue&>()))>;
+        if (count == 0) {
+            translator.assign(operands[0], Type{});
+            return;
+        }
+        translator.assign(
+            operands[0],
             std::accumulate(
-                operands.begin() + 1, operands.end(),
-                translator.fromString(operands.front()->evaluate()),
-                [this](const Type& lhs, const std::unique_ptr<Operation>& rhs) {
-            std::string value = rhs->evaluate();
-            auto translated = translator.fromString(value);
-            auto result = operator_(lhs, translated);
-            return result;
+                operands + 1, operands + count,
+                Type{translator.fromValue(operands[0])},
+                [&](const Type& lhs, const TypedValue& rhs) {
+            return operator_(lhs, translator.fromValue(rhs));
         }));
     }
 
@@ -105,20 +422,129 @@ public:
         , operator_(std::move(operator_))
         , translator(std::move(translator)) {}
 
-    std::string evaluate() override {
-        return translator::Bool{}.toString(
+    TypedValue evaluateValue() override {
+        if (operands.empty()) {
+            return TypedValue::fromBool(true);
+        }
+        // Each operand is evaluated once and the chain stops at the first
+        // pair that does not hold.
+        TypedValue lhs = operands.front()->evaluateValue();
+        for (auto it = operands.begin() + 1; it != operands.end(); ++it) {
+            TypedValue rhs = (*it)->evaluateValue();
+            if (!operator_(
+                    translator.fromValue(lhs), translator.fromValue(rhs))) {
+                return TypedValue::fromBool(false);
+            }
+            lhs = std::move(rhs);
+        }
+        return TypedValue::fromBool(true);
+    }
+
+    std::optional<TypedValue::Type> getResultType() const override {
+        return TypedValue::Type::boolean;
+    }
+
+    std::unique_ptr<Operation> simplify() override {
+        detail::optimizeAll(operands);
+        if (detail::areConstant(operands)) {
+            return std::make_unique<Constant>(this->evaluateValue());
+        }
+        return nullptr;
+    }
+
+    void compile(Compiler& compiler) override {
+        for (const auto& operand : operands) {
+            operand->compile(compiler);
+        }
+        compiler.addCall(&Comparison::apply, operands.size());
+    }
+
+    bool generate(Generator& generator) override {
+        if (!detail::generateAll(generator, operands)) {
+            return false;
+        }
+        generator.addCall(
+            detail::applyName<Operator, Translator>("Comparison"),
+            operands.size());
+        return true;
+    }
+
+    bool vectorize(Batch& batch) override {
+        if constexpr (std::is_same_v<Translator, translator::Float>) {
+            for (const auto& operand : operands) {
+                batch.add(*operand);
+            }
+            batch.addComparison<Operator>(operands.size());
+            return true;
+        }
+        return false;
+    }
+
+    bool getDependencies(
+        std::vector<const InterfaceConfig*>& /*interfaces*/) const override {
+        return true;
+    }
+
+    void forEachOperand(
+        const std::function<void(std::unique_ptr<Operation>&)>& function)
+        override {
+        std::for_each(operands.begin(), operands.end(), function);
+    }
+
+    std::optional<unsigned long> getNextChange(unsigned long now) override {
+        auto result = Operation::getNextChange(now);
+        if constexpr (std::is_same_v<Translator, translator::Float>) {
+            for (std::size_t i = 1; i < operands.size(); ++i) {
+                result = detail::earliest(
+                    now, result,
+                    this->getCrossing(now, *operands[i - 1], *operands[i]));
+            }
+        }
+        return result;
+    }
+
+    static void apply(TypedValue* operands, std::size_t count) {
+        Operator operator_;
+        Translator translator;
+        operands[0].assignBool(
             std::adjacent_find(
-                operands.begin(), operands.end(),
-                [this](
-                    const std::unique_ptr<Operation>& lhs,
-                    const std::unique_ptr<Operation>& rhs) {
+                operands, operands + count,
+                [&](const TypedValue& lhs, const TypedValue& rhs) {
             return !operator_(
-                translator.fromString(lhs->evaluate()),
-                translator.fromString(rhs->evaluate()));
-        }) == operands.end());
+                translator.fromValue(lhs), translator.fromValue(rhs));
+        }) == operands + count);
     }
 
 private:
+    // When the comparison of an elapsed time with a constant changes.
+    std::optional<unsigned long> getCrossing(
+        unsigned long now, const Operation& lhs, const Operation& rhs) const {
+        auto limit = detail::getTimeLimit(lhs, rhs);
+        if (!limit || !(limit->limit >= 0.0f)) {
+            return std::nullopt;
+        }
+        auto holds = [&](unsigned long elapsed) {
+            const float value = static_cast<float>(elapsed);
+            return limit->timeFirst ? operator_(value, limit->limit)
+                                    : operator_(limit->limit, value);
+        };
+        // The result can only change where the elapsed time reaches the limit
+        // or goes above it.
+        std::optional<unsigned long> result;
+        for (bool inclusive : {true, false}) {
+            auto elapsed = detail::firstElapsed(limit->limit, inclusive);
+            if (!elapsed || *elapsed == 0 ||
+                holds(*elapsed - 1) == holds(*elapsed)) {
+                continue;
+            }
+            const unsigned long time = limit->origin + *elapsed;
+            if (static_cast<long>(time - now) > 0) {
+                result = detail::earliest(now, result, time);
+            }
+        }
+        return result;
+    }
+
     std::vector<std::unique_ptr<Operation>> operands;
     Operator operator_;
     Translator translator;
@@ -134,9 +560,53 @@ public:
         , operator_(std::move(operator_))
         , translator(std::move(translator)) {}
 
-    std::string evaluate() override {
-        return translator.toString(
-            operator_(translator.fromString(operand->evaluate())));
+    TypedValue evaluateValue() override {
+        return translator.toValue(
+            operator_(translator.fromValue(operand->evaluateValue())));
+    }
+
+    std::optional<TypedValue::Type> getResultType() const override {
+        return Translator::type;
+    }
+
+    std::unique_ptr<Operation> simplify() override {
+        operand = optimize(std::move(operand));
+        if (operand->getConstantValue()) {
+            return std::make_unique<Constant>(this->evaluateValue());
+        }
+        return nullptr;
+    }
+
+    void compile(Compiler& compiler) override {
+        operand->compile(compiler);
+        compiler.addCall(&UnaryOperation::apply, 1);
+    }
+
+    bool generate(Generator& generator) override {
+        if (!operand->generate(generator)) {
+            return false;
+        }
+        generator.addCall(
+            detail::applyName<Operator, Translator>("UnaryOperation"), 1);
+        return true;
+    }
+
+    bool getDependencies(
+        std::vector<const InterfaceConfig*>& /*interfaces*/) const override {
+        return true;
+    }
+
+    void forEachOperand(
+        const std::function<void(std::unique_ptr<Operation>&)>& function)
+        override {
+        function(operand);
+    }
+
+    static void apply(TypedValue* operands, std::size_t /*count*/) {
+        Operator operator_;
+        Translator translator;
+        translator.assign(
+            operands[0], operator_(translator.fromValue(operands[0])));
     }
 
 private:
@@ -162,22 +632,119 @@ public:
         , operation(std::move(operation))
         , translator(std::move(translator)) {}
 
-    std::string evaluate() override {
-        auto value = translator.fromString(operation->evaluate());
+    TypedValue evaluateValue() override {
+        TypedValue operand = operation->evaluateValue();
+        const auto& value = translator.fromValue(operand);
+        if (sorted) {
+            auto range = std::upper_bound(
+                ranges.begin(), ranges.end(), value,
+                [](const auto& lhs, const Range& range) {
+                return lhs < range.min;
+            });
+            if (range != ranges.begin() && value < (--range)->max) {
+                return elements[range - ranges.begin()].value->evaluateValue();
+            }
+            return TypedValue{};
+        }
         for (const auto& element : elements) {
-            auto min = translator.fromString(element.min->evaluate());
-            auto max = translator.fromString(element.max->evaluate());
+            auto min = translator.fromValue(element.min->evaluateValue());
+            auto max = translator.fromValue(element.max->evaluateValue());
             if (value >= min && value < max) {
-                return element.value->evaluate();
+                return element.value->evaluateValue();
             }
         }
-        return "";
+        return TypedValue{};
+    }
+
+    std::unique_ptr<Operation> simplify() override {
+        operation = optimize(std::move(operation));
+        bool constant = operation->getConstantValue() != nullptr;
+        for (auto& element : elements) {
+            element.min = optimize(std::move(element.min));
+            element.max = optimize(std::move(element.max));
+            element.value = optimize(std::move(element.value));
+            constant = constant && element.min->getConstantValue() &&
+                       element.max->getConstantValue() &&
+                       element.value->getConstantValue();
+        }
+        if (constant) {
+            return std::make_unique<Constant>(this->evaluateValue());
+        }
+        sortRanges();
+        return nullptr;
+    }
+
+    bool getDependencies(
+        std::vector<const InterfaceConfig*>& /*interfaces*/) const override {
+        return true;
+    }
+
+    void forEachOperand(
+        const std::function<void(std::unique_ptr<Operation>&)>& function)
+        override {
+        function(operation);
+        for (auto& element : elements) {
+            function(element.min);
+            function(element.max);
+            function(element.value);
+        }
     }
 
 private:
+    using Bound = std::decay_t<decltype(std::declval<Translator&>().fromValue(
+        std::declval<const TypedValue&>()))>;
+
+    struct Range {
+        Bound min;
+        Bound max;
+    };
+
+    // If all bounds are constant and the ranges do not overlap, the first
+    // matching element is the only one, so the elements can be sorted and
+    // searched. Otherwise they are checked one by one in the original order.
+    void sortRanges() {
+        std::vector<std::pair<Range, std::size_t>> sortedRanges;
+        for (std::size_t i = 0; i < elements.size(); ++i) {
+            const TypedValue* min = elements[i].min->getConstantValue();
+            const TypedValue* max = elements[i].max->getConstantValue();
+            if (!min || !max) {
+                return;
+            }
+            Range range{translator.fromValue(*min), translator.fromValue(*max)};
+            // Empty ranges never match.
+            if (range.min < range.max) {
+                sortedRanges.emplace_back(std::move(range), i);
+            }
+        }
+        std::sort(
+            sortedRanges.begin(), sortedRanges.end(),
+            [](const auto& lhs, const auto& rhs) {
+            return lhs.first.min < rhs.first.min;
+        });
+        for (std::size_t i = 1; i < sortedRanges.size(); ++i) {
+            if (sortedRanges[i].first.min < sortedRanges[i - 1].first.max) {
+                return;
+            }
+        }
+
+        std::vector<MappingElement> sortedElements;
+        sortedElements.reserve(sortedRanges.size());
+        ranges.clear();
+        ranges.reserve(sortedRanges.size());
+        for (auto& [range, index] : sortedRanges) {
+            sortedElements.push_back(std::move(elements[index]));
+            ranges.push_back(std::move(range));
+        }
+        elements = std::move(sortedElements);
+        sorted = true;
+    }
+
     std::vector<MappingElement> elements;
     std::unique_ptr<Operation> operation;
     Translator translator;
+    // The bounds of the elements in the same order, if they are sorted.
+    std::vector<Range> ranges;
+    bool sorted = false;
 };
 
 }  // namespace operation
@@ -0,0 +1,54 @@
+#include "Precompiled.hpp"
+
+namespace operation {
+
+Precompiled::Registration* Precompiled::first = nullptr;
+
+Precompiled::Registration::Registration(const Rule* rules, std::size_t count)
+    : rules(rules), count(count), next(Precompiled::first) {
+    Precompiled::first = this;
+}
+
+std::unique_ptr<Precompiled> Precompiled::find(
+    const InterfaceRegistry& interfaces, InterfaceConfig* defaultInterface,
+    std::string_view expression) {
+    std::string_view defaultName =
+        defaultInterface ? std::string_view{defaultInterface->name} : "";
+    for (const Registration* registration = Precompiled::first; registration;
+         registration = registration->next) {
+        for (std::size_t i = 0; i < registration->count; ++i) {
+            const Rule& rule = registration->rules[i];
+            if (rule.expression != expression ||
+                rule.defaultInterface != defaultName) {
+                continue;
+            }
+
+            std::vector<InterfaceConfig*> used;
+            used.reserve(rule.interfaceCount);
+            for (std::size_t j = 0; j < rule.interfaceCount; ++j) {
+                InterfaceConfig* interface =
+                    interfaces.find(rule.interfaces[j]);
+                if (!interface) {
+                    return nullptr;
+                }
+                used.push_back(interface);
+            }
+            return std::make_unique<Precompiled>(rule, std::move(used));
+        }
+    }
+    return nullptr;
+}
+
+TypedValue Precompiled::evaluateValue() {
+    this->rule.function(this->interfaces.data(), this->stack.data());
+    return this->stack.front().toReference();
+}
+
+bool Precompiled::getDependencies(
+    std::vector<const InterfaceConfig*>& interfaces) const {
+    interfaces.insert(
+        interfaces.end(), this->interfaces.begin(), this->interfaces.end());
+    return true;
+}
+
+}  // namespace operation
@@ -0,0 +1,79 @@
+#ifndef OPERATION_PRECOMPILED_HPP
+#define OPERATION_PRECOMPILED_HPP
+
+#include <cstddef>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+#include "../common/InterfaceConfig.hpp"
+#include "Operation.hpp"
+
+namespace operation {
+
+// An operation that was turned into C++ by operation_compiler and built into
+// the firmware, so it does not need to be parsed at boot.
+class Precompiled : public Operation {
+public:
+    using Function =
+        void (*)(const InterfaceConfig* const* interfaces, TypedValue* stack);
+
+    struct Rule {
+        // The expression the rule was generated from.
+        const char* expression;
+        // The name of the default interface of the action, or empty if it
+        // has none.
+        const char* defaultInterface;
+        // The interfaces the expression uses, in the order the function
+        // refers to them.
+        const char* const* interfaces;
+        std::size_t interfaceCount;
+        std::size_t stackSize;
+        Function function;
+    };
+
+    // Makes the rules of a generated file available to find(). The generated
+    // file has one static instance.
+    class Registration {
+    public:
+        Registration(const Rule* rules, std::size_t count);
+
+    private:
+        const Rule* rules;
+        std::size_t count;
+        Registration* next;
+
+        friend class Precompiled;
+    };
+
+    Precompiled(const Rule& rule, std::vector<InterfaceConfig*> interfaces)
+        : rule(rule)
+        , interfaces(std::move(interfaces))
+        , stack(rule.stackSize) {}
+
+    // Returns the rule generated from the same expression and default
+    // interface, or nullptr if there is none or an interface it uses does
+    // not exist.
+    static std::unique_ptr<Precompiled> find(
+        const InterfaceRegistry& interfaces, InterfaceConfig* defaultInterface,
+        std::string_view expression);
+
+    TypedValue evaluateValue() override;
+    bool getDependencies(
+        std::vector<const InterfaceConfig*>& interfaces) const override;
+
+    const std::vector<InterfaceConfig*>& getInterfaces() const {
+        return this->interfaces;
+    }
+
+private:
+    const Rule& rule;
+    std::vector<InterfaceConfig*> interfaces;
+    std::vector<TypedValue> stack;
+
+    static Registration* first;
+};
+
+}  // namespace operation
+
+#endif  // OPERATION_PRECOMPILED_HPP
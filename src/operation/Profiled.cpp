@@ -0,0 +1,91 @@
+#include "Profiled.hpp"
+
+#include <algorithm>
+
+#include "../common/EspApi.hpp"
+#include "../tools/number.hpp"
+
+namespace operation {
+
+namespace {
+
+void profileOperands(
+    Operation& operation, EspApi& esp, const std::string& name) {
+    std::size_t index = 0;
+    operation.forEachOperand([&](std::unique_ptr<Operation>& operand) {
+        char buffer[tools::maxIntLength];
+        std::string operandName =
+            name + '/' +
+            std::string(buffer, tools::formatInt(buffer, index++));
+        profileOperands(*operand, esp, operandName);
+        operand = std::make_unique<Profiled>(
+            std::move(operand), esp, std::move(operandName), true);
+    });
+}
+
+}  // unnamed namespace
+
+Profiled* Profiled::first = nullptr;
+Profiled* Profiled::last = nullptr;
+
+Profiled::Profiled(
+    std::unique_ptr<Operation> operation, EspApi& esp, std::string name,
+    bool isNode)
+    : operation(std::move(operation))
+    , esp(esp)
+    , name(std::move(name))
+    , node(isNode)
+    , previous(Profiled::last) {
+    (this->previous ? this->previous->next : Profiled::first) = this;
+    Profiled::last = this;
+}
+
+Profiled::~Profiled() {
+    (this->previous ? this->previous->next : Profiled::first) = this->next;
+    (this->next ? this->next->previous : Profiled::last) = this->previous;
+}
+
+TypedValue Profiled::evaluateValue() {
+    unsigned long start = this->esp.micros();
+    TypedValue result = this->operation->evaluateValue();
+    this->micros += this->esp.micros() - start;
+    ++this->count;
+    return result;
+}
+
+std::vector<const Profiled*> Profiled::getAll() {
+    std::vector<const Profiled*> result;
+    for (const Profiled* profiled = Profiled::first; profiled;
+         profiled = profiled->next) {
+        result.push_back(profiled);
+    }
+    return result;
+}
+
+std::vector<const Profiled*> Profiled::getTop(std::size_t count) {
+    std::vector<const Profiled*> result = Profiled::getAll();
+    result.erase(
+        std::remove_if(
+            result.begin(), result.end(),
+            [](const Profiled* profiled) { return profiled->isNode(); }),
+        result.end());
+    auto end = result.begin() + std::min(count, result.size());
+    std::partial_sort(
+        result.begin(), end, result.end(),
+        [](const Profiled* lhs, const Profiled* rhs) {
+        return lhs->getMicros() > rhs->getMicros();
+    });
+    result.erase(end, result.end());
+    return result;
+}
+
+std::unique_ptr<Operation> profile(
+    std::unique_ptr<Operation> operation, EspApi& esp, const std::string& name,
+    bool nodes) {
+    if (nodes) {
+        profileOperands(*operation, esp, name);
+    }
+    return std::make_unique<Profiled>(std::move(operation), esp, name, false);
+}
+
+}  // namespace operation
@@ -0,0 +1,72 @@
+#ifndef OPERATION_PROFILED_HPP
+#define OPERATION_PROFILED_HPP
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Operation.hpp"
+
+class EspApi;
+
+namespace operation {
+
+// Counts the evaluations of an operation and the time they take, including
+// the time of the operands.
+class Profiled : public Operation {
+public:
+    Profiled(
+        std::unique_ptr<Operation> operation, EspApi& esp, std::string name,
+        bool isNode);
+    ~Profiled();
+
+    TypedValue evaluateValue() override;
+    std::optional<TypedValue::Type> getResultType() const override {
+        return this->operation->getResultType();
+    }
+    bool getDependencies(
+        std::vector<const InterfaceConfig*>& /*interfaces*/) const override {
+        return true;
+    }
+    void forEachOperand(
+        const std::function<void(std::unique_ptr<Operation>&)>& function)
+        override {
+        function(this->operation);
+    }
+
+    const std::string& getName() const { return this->name; }
+    // Whether it measures a part of an action instead of a whole one.
+    bool isNode() const { return this->node; }
+    unsigned long getCount() const { return this->count; }
+    unsigned long getMicros() const { return this->micros; }
+
+    // All profiled operations in the order they were created.
+    static std::vector<const Profiled*> getAll();
+    // The actions that took the most time, the slowest first.
+    static std::vector<const Profiled*> getTop(std::size_t count);
+
+private:
+    std::unique_ptr<Operation> operation;
+    EspApi& esp;
+    std::string name;
+    bool node;
+    unsigned long count = 0;
+    unsigned long micros = 0;
+    Profiled* previous;
+    Profiled* next = nullptr;
+
+    static Profiled* first;
+    static Profiled* last;
+};
+
+// Profiles the operation under the given name. If nodes is true, each of its
+// operands is profiled too, named after the path that leads to it. The device
+// only reports whole actions, so it does not profile the nodes, which would
+// only add to the time of the actions.
+std::unique_ptr<Operation> profile(
+    std::unique_ptr<Operation> operation, EspApi& esp, const std::string& name,
+    bool nodes);
+
+}  // namespace operation
+
+#endif  // OPERATION_PROFILED_HPP
@@ -0,0 +1,138 @@
+#include "Program.hpp"
+
+#include <utility>
+
+#include "Operations.hpp"
+
+namespace operation {
+
+Program Program::compile(Operation& operation) {
+    Program result;
+    Compiler compiler{result};
+    operation.compile(compiler);
+    return result;
+}
+
+const TypedValue& Program::evaluate() {
+    const Instruction* const code = this->code.data();
+    const Instruction* const end = code + this->code.size();
+    TypedValue* top = this->stack.data();
+    for (const Instruction* next = code; next != end;) {
+        const Instruction& instruction = *next++;
+        switch (instruction.code) {
+        case Instruction::Code::constant: {
+            const TypedValue& value = this->constants[instruction.argument];
+            if (value.getType() == TypedValue::Type::string) {
+                top->assignReference(value.asString());
+            } else {
+                *top = value;
+            }
+            ++top;
+            break;
+        }
+        case Instruction::Code::value: {
+            const ValueReference& value = this->values[instruction.argument];
+            top->assignReference(Value::get(value.interface, value.index));
+            ++top;
+            break;
+        }
+        case Instruction::Code::call:
+            top -= instruction.count;
+            this->functions[instruction.argument](top, instruction.count);
+            ++top;
+            break;
+        case Instruction::Code::evaluate:
+            *top++ = this->operations[instruction.argument]->evaluateValue();
+            break;
+        case Instruction::Code::jump:
+            next = code + instruction.argument;
+            break;
+        case Instruction::Code::jumpIfFalse:
+            --top;
+            if (!top->asBool()) {
+                next = code + instruction.argument;
+            }
+            break;
+        case Instruction::Code::jumpIfFalseOrPop:
+        case Instruction::Code::jumpIfTrueOrPop: {
+            bool condition = (top - 1)->asBool();
+            if (condition ==
+                (instruction.code == Instruction::Code::jumpIfTrueOrPop)) {
+                (top - 1)->assignBool(condition);
+                next = code + instruction.argument;
+            } else {
+                --top;
+            }
+            break;
+        }
+        }
+    }
+    return this->stack.front();
+}
+
+void Compiler::addConstant(const TypedValue& value) {
+    this->add(
+        Instruction::Code::constant, 0, this->program.constants.size());
+    this->program.constants.push_back(value.toOwned());
+    this->push();
+}
+
+void Compiler::addValue(const InterfaceConfig* interface, std::size_t index) {
+    this->add(Instruction::Code::value, 0, this->program.values.size());
+    this->program.values.push_back(Program::ValueReference{interface, index});
+    this->push();
+}
+
+void Compiler::addCall(Function function, std::size_t count) {
+    this->add(Instruction::Code::call, count, this->program.functions.size());
+    this->program.functions.push_back(function);
+    this->depth -= count;
+    this->push();
+}
+
+void Compiler::addEvaluate(Operation& operation) {
+    this->add(
+        Instruction::Code::evaluate, 0, this->program.operations.size());
+    this->program.operations.push_back(&operation);
+    this->push();
+}
+
+std::size_t Compiler::addJump() {
+    this->add(Instruction::Code::jump, 0, 0);
+    return this->program.code.size() - 1;
+}
+
+std::size_t Compiler::addJumpIfFalse() {
+    this->add(Instruction::Code::jumpIfFalse, 0, 0);
+    --this->depth;
+    return this->program.code.size() - 1;
+}
+
+std::size_t Compiler::addJumpOrPop(bool condition) {
+    this->add(
+        condition ? Instruction::Code::jumpIfTrueOrPop
+                  : Instruction::Code::jumpIfFalseOrPop,
+        0, 0);
+    --this->depth;
+    return this->program.code.size() - 1;
+}
+
+void Compiler::setJumpTarget(std::size_t jump) {
+    this->program.code[jump].argument = this->program.code.size();
+}
+
+void Compiler::add(
+    Instruction::Code code, std::size_t count, std::size_t argument) {
+    this->program.code.push_back(Instruction{
+        code, static_cast<std::uint16_t>(count),
+        static_cast<std::uint32_t>(argument)});
+}
+
+void Compiler::push() {
+    ++this->depth;
+    if (this->program.stack.size() < this->depth) {
+        this->program.stack.resize(this->depth);
+    }
+}
+
+}  // namespace operation
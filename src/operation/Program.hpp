@@ -0,0 +1,106 @@
+#ifndef OPERATION_PROGRAM_HPP
+#define OPERATION_PROGRAM_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "TypedValue.hpp"
+
+class InterfaceConfig;
+
+namespace operation {
+
+class Operation;
+
+// Applies an operator to the topmost count values of the stack and replaces
+// the first of them with the result.
+using Function = void (*)(TypedValue* operands, std::size_t count);
+
+struct Instruction {
+    enum class Code : std::uint8_t {
+        constant,
+        value,
+        call,
+        evaluate,
+        jump,
+        jumpIfFalse,
+        // Replace the value with false and jump if it is false, otherwise
+        // drop it. The other one is the same with true.
+        jumpIfFalseOrPop,
+        jumpIfTrueOrPop,
+    };
+
+    Code code;
+    std::uint16_t count;
+    std::uint32_t argument;
+};
+
+// An operation tree compiled into a flat list of instructions that are
+// executed on a value stack. Gives the same results as evaluating the tree.
+class Program {
+public:
+    Program() = default;
+    Program(const Program&) = delete;
+    Program& operator=(const Program&) = delete;
+    Program(Program&&) = default;
+    Program& operator=(Program&&) = default;
+
+    // Operations that cannot be compiled are called from the program, so the
+    // compiled tree must outlive it.
+    static Program compile(Operation& operation);
+
+    // The result is valid until the next evaluation.
+    const TypedValue& evaluate();
+    std::string evaluateString() { return this->evaluate().asString(); }
+
+    const std::vector<Instruction>& getCode() const { return this->code; }
+
+private:
+    struct ValueReference {
+        const InterfaceConfig* interface;
+        std::size_t index;
+    };
+
+    friend class Compiler;
+
+    std::vector<Instruction> code;
+    std::vector<TypedValue> constants;
+    std::vector<ValueReference> values;
+    std::vector<Function> functions;
+    std::vector<Operation*> operations;
+    // Slots are assigned instead of pushed and popped, so that evaluation does
+    // not construct and destroy values.
+    std::vector<TypedValue> stack;
+};
+
+class Compiler {
+public:
+    explicit Compiler(Program& program) : program(program) {}
+
+    void addConstant(const TypedValue& value);
+    void addValue(const InterfaceConfig* interface, std::size_t index);
+    void addCall(Function function, std::size_t count);
+    void addEvaluate(Operation& operation);
+
+    // Returns the position of the jump. Call setJumpTarget() with it when the
+    // code to jump to comes next.
+    std::size_t addJump();
+    std::size_t addJumpIfFalse();
+    std::size_t addJumpOrPop(bool condition);
+    void setJumpTarget(std::size_t jump);
+
+    // The two branches of a conditional leave only one value on the stack.
+    void dropValue() { --this->depth; }
+
+private:
+    void add(Instruction::Code code, std::size_t count, std::size_t argument);
+    void push();
+
+    Program& program;
+    std::size_t depth = 0;
+};
+
+}  // namespace operation
+
+#endif  // OPERATION_PROGRAM_HPP
@@ -0,0 +1,84 @@
+#include "Streaming.hpp"
+
+#include "../common/EspApi.hpp"
+
+namespace operation {
+
+TypedValue StreamingOperation::evaluateValue() {
+    TypedValue sample = this->operand->evaluateValue();
+    if (sample.getType() != TypedValue::Type::string ||
+        !sample.asString().empty()) {
+        this->result = this->update(sample).toOwned();
+    }
+    return this->result.toReference();
+}
+
+std::unique_ptr<Operation> StreamingOperation::simplify() {
+    this->operand = optimize(std::move(this->operand));
+    return nullptr;
+}
+
+TypedValue MovingAverage::update(const TypedValue& sample) {
+    float value = sample.asNumber();
+    if (this->count == this->samples.size()) {
+        this->sum -= this->samples[this->next];
+    } else {
+        ++this->count;
+    }
+    this->samples[this->next] = value;
+    this->sum += value;
+    this->next = (this->next + 1) % this->samples.size();
+    return TypedValue::fromNumber(this->sum / this->count);
+}
+
+TypedValue ExponentialAverage::update(const TypedValue& sample) {
+    float value = sample.asNumber();
+    if (this->hasValue) {
+        this->value += this->alpha * (value - this->value);
+    } else {
+        this->value = value;
+        this->hasValue = true;
+    }
+    return TypedValue::fromNumber(this->value);
+}
+
+TypedValue Rate::update(const TypedValue& sample) {
+    float value = sample.asNumber();
+    unsigned long now = this->esp.millis();
+    if (this->hasValue && now != this->time) {
+        this->rate = TypedValue::fromNumber(
+            (value - this->value) * 1000.0f / (now - this->time));
+    }
+    this->hasValue = true;
+    this->value = value;
+    this->time = now;
+    return this->rate;
+}
+
+std::unique_ptr<Operation> Hysteresis::simplify() {
+    this->low = optimize(std::move(this->low));
+    this->high = optimize(std::move(this->high));
+    return StreamingOperation::simplify();
+}
+
+TypedValue Hysteresis::update(const TypedValue& sample) {
+    float value = sample.asNumber();
+    if (value >= this->high->evaluateValue().asNumber()) {
+        this->state = true;
+    } else if (value <= this->low->evaluateValue().asNumber()) {
+        this->state = false;
+    }
+    return TypedValue::fromBool(this->state);
+}
+
+TypedValue Changed::update(const TypedValue& sample) {
+    const std::string& value = sample.asString();
+    bool changed = this->hasValue && value != this->value;
+    if (!this->hasValue || changed) {
+        this->value = value;
+        this->hasValue = true;
+    }
+    return TypedValue::fromBool(changed);
+}
+
+}  // namespace operation
@@ -0,0 +1,183 @@
+#ifndef OPERATION_STREAMING_HPP
+#define OPERATION_STREAMING_HPP
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Operation.hpp"
+
+class EspApi;
+
+namespace operation {
+
+// An operation that remembers earlier values of its operand. It takes a sample
+// each time it is evaluated and updates its state in constant time. Samples
+// without a value are skipped and the previous result is returned for them.
+// The result depends on the earlier evaluations, so it is never cached or
+// folded into a constant.
+class StreamingOperation : public Operation {
+public:
+    explicit StreamingOperation(std::unique_ptr<Operation> operand)
+        : operand(std::move(operand)) {}
+
+    TypedValue evaluateValue() override;
+    std::unique_ptr<Operation> simplify() override;
+    bool keepsState() override { return true; }
+    void forEachOperand(
+        const std::function<void(std::unique_ptr<Operation>&)>& function)
+        override {
+        function(this->operand);
+    }
+
+protected:
+    // Returns the new result, or an empty value if there is none yet.
+    virtual TypedValue update(const TypedValue& sample) = 0;
+
+private:
+    std::unique_ptr<Operation> operand;
+    TypedValue result;
+};
+
+// The average of the last size samples.
+class MovingAverage : public StreamingOperation {
+public:
+    MovingAverage(std::unique_ptr<Operation> operand, std::size_t size)
+        : StreamingOperation(std::move(operand)), samples(size) {}
+
+protected:
+    TypedValue update(const TypedValue& sample) override;
+
+private:
+    std::vector<float> samples;
+    std::size_t next = 0;
+    std::size_t count = 0;
+    double sum = 0.0;
+};
+
+// The smallest or largest of the last size samples, depending on Compare.
+// Keeps the samples that can still become the result in a monotonic queue, so
+// each sample is added and removed only once.
+template <typename Compare>
+class MovingExtremum : public StreamingOperation {
+public:
+    MovingExtremum(std::unique_ptr<Operation> operand, std::size_t size)
+        : StreamingOperation(std::move(operand)), queue(size) {}
+
+protected:
+    TypedValue update(const TypedValue& sample) override {
+        float value = sample.asNumber();
+        ++this->count;
+        while (this->length != 0 &&
+               !this->compare(this->at(this->length - 1).value, value)) {
+            --this->length;
+        }
+        if (this->length != 0 &&
+            this->at(0).count + this->queue.size() <= this->count) {
+            this->first = (this->first + 1) % this->queue.size();
+            --this->length;
+        }
+        ++this->length;
+        this->at(this->length - 1) = Entry{this->count, value};
+        return TypedValue::fromNumber(this->at(0).value);
+    }
+
+private:
+    struct Entry {
+        unsigned long count;
+        float value;
+    };
+
+    Entry& at(std::size_t index) {
+        return this->queue[(this->first + index) % this->queue.size()];
+    }
+
+    std::vector<Entry> queue;
+    std::size_t first = 0;
+    std::size_t length = 0;
+    unsigned long count = 0;
+    Compare compare;
+};
+
+using MovingMinimum = MovingExtremum<std::less<float>>;
+using MovingMaximum = MovingExtremum<std::greater<float>>;
+
+// Each sample moves the result by alpha times its distance from the sample.
+class ExponentialAverage : public StreamingOperation {
+public:
+    ExponentialAverage(std::unique_ptr<Operation> operand, float alpha)
+        : StreamingOperation(std::move(operand)), alpha(alpha) {}
+
+protected:
+    TypedValue update(const TypedValue& sample) override;
+
+private:
+    float alpha;
+    bool hasValue = false;
+    float value = 0.0f;
+};
+
+// The change of the operand per second between the last two samples.
+class Rate : public StreamingOperation {
+public:
+    Rate(std::unique_ptr<Operation> operand, EspApi& esp)
+        : StreamingOperation(std::move(operand)), esp(esp) {}
+
+protected:
+    TypedValue update(const TypedValue& sample) override;
+
+private:
+    EspApi& esp;
+    bool hasValue = false;
+    float value = 0.0f;
+    unsigned long time = 0;
+    TypedValue rate;
+};
+
+// Becomes true when the operand reaches high and false when it falls to low.
+// Keeps its state in between.
+class Hysteresis : public StreamingOperation {
+public:
+    Hysteresis(
+        std::unique_ptr<Operation> operand, std::unique_ptr<Operation> low,
+        std::unique_ptr<Operation> high)
+        : StreamingOperation(std::move(operand))
+        , low(std::move(low))
+        , high(std::move(high)) {}
+
+    std::unique_ptr<Operation> simplify() override;
+    void forEachOperand(
+        const std::function<void(std::unique_ptr<Operation>&)>& function)
+        override {
+        StreamingOperation::forEachOperand(function);
+        function(this->low);
+        function(this->high);
+    }
+
+protected:
+    TypedValue update(const TypedValue& sample) override;
+
+private:
+    std::unique_ptr<Operation> low;
+    std::unique_ptr<Operation> high;
+    bool state = false;
+};
+
+// True if the operand is different from the previous sample.
+class Changed : public StreamingOperation {
+public:
+    using StreamingOperation::StreamingOperation;
+
+protected:
+    TypedValue update(const TypedValue& sample) override;
+
+private:
+    bool hasValue = false;
+    std::string value;
+};
+
+}  // namespace operation
+
+#endif  // OPERATION_STREAMING_HPP
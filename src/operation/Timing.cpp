@@ -0,0 +1,24 @@
+#include "Timing.hpp"
+
+#include "../common/EspApi.hpp"
+#include "../common/InterfaceConfig.hpp"
+
+namespace operation {
+
+TypedValue Now::evaluateValue() {
+    return TypedValue::fromNumber(this->esp.millis());
+}
+
+TypedValue Since::evaluateValue() {
+    if (!this->interface->lastFired) {
+        return TypedValue{};
+    }
+    return TypedValue::fromNumber(
+        this->esp.millis() - *this->interface->lastFired);
+}
+
+std::optional<unsigned long> Since::getTimeOrigin() const {
+    return this->interface->lastFired;
+}
+
+}  // namespace operation
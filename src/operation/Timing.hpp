@@ -0,0 +1,46 @@
+#ifndef OPERATION_TIMING_HPP
+#define OPERATION_TIMING_HPP
+
+#include "Operation.hpp"
+
+class EspApi;
+
+namespace operation {
+
+// Operations that depend on the time. The time is in milliseconds since start.
+// Numbers are floats, so it is only exact to the millisecond up to 2^24 ms,
+// about 4.66 hours. Above that it is rounded to the nearest float, which is
+// 256 ms apart after 2^31 ms, about 24.8 days.
+
+class Now : public Operation {
+public:
+    explicit Now(EspApi& esp) : esp(esp) {}
+
+    TypedValue evaluateValue() override;
+    std::optional<TypedValue::Type> getResultType() const override {
+        return TypedValue::Type::number;
+    }
+    std::optional<unsigned long> getTimeOrigin() const override { return 0; }
+
+private:
+    EspApi& esp;
+};
+
+// The time since the interface last fired with a value, or no value if it
+// has not fired yet.
+class Since : public Operation {
+public:
+    Since(const InterfaceConfig* interface, EspApi& esp)
+        : interface(interface), esp(esp) {}
+
+    TypedValue evaluateValue() override;
+    std::optional<unsigned long> getTimeOrigin() const override;
+
+private:
+    const InterfaceConfig* interface;
+    EspApi& esp;
+};
+
+}  // namespace operation
+
+#endif  // OPERATION_TIMING_HPP
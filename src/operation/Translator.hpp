@@ -1,30 +1,51 @@
 #ifndef OPERATION_TRANSLATOR_HPP
 #define OPERATION_TRANSLATOR_HPP
 
-#include <cstdlib>
 #include <string>
 
-#include "../tools/string.hpp"
+#include "TypedValue.hpp"
 
 namespace translator {
 
 struct Str {
-    const std::string& toString(const std::string& s) { return s; }
-    const std::string& fromString(const std::string& s) { return s; }
+    static constexpr auto type = operation::TypedValue::Type::string;
+
+    operation::TypedValue toValue(std::string s) {
+        return operation::TypedValue::fromString(std::move(s));
+    }
+    void assign(operation::TypedValue& target, std::string s) {
+        target.assignString(std::move(s));
+    }
+    const std::string& fromValue(const operation::TypedValue& value) {
+        return value.asString();
+    }
 };
 
 struct Float {
-    std::string toString(float i) { return tools::floatToString(i, 6); }
-    float fromString(const std::string& s) { return std::atof(s.c_str()); }
+    static constexpr auto type = operation::TypedValue::Type::number;
+
+    operation::TypedValue toValue(float f) {
+        return operation::TypedValue::fromNumber(f);
+    }
+    void assign(operation::TypedValue& target, float f) {
+        target.assignNumber(f);
+    }
+    float fromValue(const operation::TypedValue& value) {
+        return value.asNumber();
+    }
 };
 
 struct Bool {
-    std::string toString(bool b) { return b ? "1" : "0"; }
+    static constexpr auto type = operation::TypedValue::Type::boolean;
 
-    bool fromString(const std::string& s) {
-        bool result = false;
-        tools::getBoolValue(s.c_str(), result, s.size());
-        return result;
+    operation::TypedValue toValue(bool b) {
+        return operation::TypedValue::fromBool(b);
+    }
+    void assign(operation::TypedValue& target, bool b) {
+        target.assignBool(b);
+    }
+    bool fromValue(const operation::TypedValue& value) {
+        return value.asBool();
     }
 };
 
@@ -0,0 +1,155 @@
+#include "TypedValue.hpp"
+
+#include <cmath>
+
+#include "../tools/number.hpp"
+#include "../tools/string.hpp"
+
+namespace operation {
+
+namespace {
+
+constexpr int floatDecimals = 6;
+
+// Integers in this range survive the string round trip unchanged.
+constexpr float exactIntegerLimit = 16777216.0f;
+
+float parseFloat(const char* value) {
+    return tools::parseDouble(value);
+}
+
+float roundTrip(float value) {
+    if (std::fabs(value) < exactIntegerLimit && std::trunc(value) == value) {
+        // Adding zero turns -0 into 0, the same as formatting does.
+        return value + 0.0f;
+    }
+    char buffer[tools::maxFloatLength(floatDecimals) + 1];
+    *tools::formatFloat(buffer, value, floatDecimals) = '\0';
+    return parseFloat(buffer);
+}
+
+}  // unnamed namespace
+
+TypedValue TypedValue::fromString(std::string value) {
+    TypedValue result;
+    result.buffer = std::move(value);
+    return result;
+}
+
+TypedValue TypedValue::fromReference(const std::string& value) {
+    TypedValue result;
+    result.reference = &value;
+    return result;
+}
+
+TypedValue TypedValue::fromNumber(float value) {
+    TypedValue result;
+    result.type = Type::number;
+    result.number = value;
+    return result;
+}
+
+TypedValue TypedValue::fromBool(bool value) {
+    TypedValue result;
+    result.type = Type::boolean;
+    result.boolean = value;
+    return result;
+}
+
+void TypedValue::assignString(std::string value) {
+    this->type = Type::string;
+    this->reference = nullptr;
+    this->buffer = std::move(value);
+}
+
+void TypedValue::assignReference(const std::string& value) {
+    this->type = Type::string;
+    this->reference = &value;
+}
+
+void TypedValue::assignNumber(float value) {
+    this->type = Type::number;
+    this->number = value;
+    this->formatted = false;
+}
+
+void TypedValue::assignBool(bool value) {
+    this->type = Type::boolean;
+    this->boolean = value;
+    this->formatted = false;
+}
+
+const std::string& TypedValue::asString() const {
+    switch (this->type) {
+    case Type::string:
+        return this->reference ? *this->reference : this->buffer;
+    case Type::number:
+        if (!this->formatted) {
+            char digits[tools::maxFloatLength(floatDecimals)];
+            char* end = tools::formatFloat(digits, this->number, floatDecimals);
+            this->buffer.assign(digits, end);
+            this->formatted = true;
+        }
+        return this->buffer;
+    case Type::boolean:
+        if (!this->formatted) {
+            this->buffer = this->boolean ? "1" : "0";
+            this->formatted = true;
+        }
+        return this->buffer;
+    }
+    return this->buffer;
+}
+
+float TypedValue::asNumber() const {
+    switch (this->type) {
+    case Type::string:
+        return parseFloat(this->asString().c_str());
+    case Type::number:
+        return roundTrip(this->number);
+    case Type::boolean:
+        return this->boolean ? 1.0f : 0.0f;
+    }
+    return 0.0f;
+}
+
+bool TypedValue::asBool() const {
+    switch (this->type) {
+    case Type::string: {
+        const std::string& value = this->asString();
+        bool result = false;
+        tools::getBoolValue(value.c_str(), result, value.size());
+        return result;
+    }
+    case Type::number:
+        // Only "1" is true among the formatted numbers.
+        return this->number == 1.0f;
+    case Type::boolean:
+        return this->boolean;
+    }
+    return false;
+}
+
+std::string TypedValue::releaseString() && {
+    const std::string& value = this->asString();
+    if (&value == &this->buffer) {
+        return std::move(this->buffer);
+    }
+    return value;
+}
+
+TypedValue TypedValue::toOwned() const {
+    if (this->type == Type::string) {
+        return TypedValue::fromString(this->asString());
+    }
+    return *this;
+}
+
+TypedValue TypedValue::toReference() const {
+    if (this->type == Type::string) {
+        return TypedValue::fromReference(this->asString());
+    }
+    return *this;
+}
+
+}  // namespace operation
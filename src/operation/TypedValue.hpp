@@ -0,0 +1,55 @@
+#ifndef OPERATION_TYPEDVALUE_HPP
+#define OPERATION_TYPEDVALUE_HPP
+
+#include <string>
+
+namespace operation {
+
+// The result of evaluating an operation. Numbers and booleans stay in their
+// native form until someone needs them as a string. Conversions between the
+// types give exactly the same results as formatting the value to a string and
+// parsing it back would.
+class TypedValue {
+public:
+    enum class Type { string, number, boolean };
+
+    TypedValue() = default;
+
+    static TypedValue fromString(std::string value);
+    // The referenced string must outlive the returned value.
+    static TypedValue fromReference(const std::string& value);
+    static TypedValue fromNumber(float value);
+    static TypedValue fromBool(bool value);
+
+    // Change the value in place, which is cheaper than assigning a new one.
+    void assignString(std::string value);
+    void assignReference(const std::string& value);
+    void assignNumber(float value);
+    void assignBool(bool value);
+
+    Type getType() const { return this->type; }
+
+    const std::string& asString() const;
+    float asNumber() const;
+    bool asBool() const;
+
+    std::string releaseString() &&;
+
+    // A copy with its own string, which does not depend on where this one
+    // came from.
+    TypedValue toOwned() const;
+    // A copy that refers to the string of this one. This one must outlive it.
+    TypedValue toReference() const;
+
+private:
+    Type type = Type::string;
+    float number = 0.0f;
+    bool boolean = false;
+    const std::string* reference = nullptr;
+    mutable bool formatted = false;
+    mutable std::string buffer;
+};
+
+}  // namespace operation
+
+#endif  // OPERATION_TYPEDVALUE_HPP
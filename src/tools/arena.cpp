@@ -0,0 +1,107 @@
+#include "arena.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <new>
+
+namespace tools {
+
+namespace {
+
+constexpr std::size_t alignment = alignof(std::max_align_t);
+
+std::size_t align(std::size_t size) {
+    return (size + alignment - 1) / alignment * alignment;
+}
+
+}  // unnamed namespace
+
+Arena* Arena::current = nullptr;
+Arena* Arena::first = nullptr;
+
+Arena::Arena(std::size_t blockSize)
+    : blockSize(align(blockSize)), next(Arena::first) {
+    Arena::first = this;
+}
+
+Arena::~Arena() {
+    Arena** arena = &Arena::first;
+    while (*arena != this) {
+        arena = &(*arena)->next;
+    }
+    *arena = this->next;
+}
+
+void* Arena::allocate(std::size_t size) {
+    size = align(size);
+    if (this->blocks.empty() ||
+        this->blocks.back().size - this->position < size) {
+        // Objects larger than a block get their own block, the rest of the
+        // current block can still be used afterwards.
+        std::size_t blockSize = std::max(size, this->blockSize);
+        Block block{std::make_unique<char[]>(blockSize), blockSize};
+        ++this->statistics.blocks;
+        this->statistics.capacity += blockSize;
+        if (size > this->blockSize && !this->blocks.empty()) {
+            this->statistics.used += size;
+            char* result = block.data.get();
+            this->blocks.insert(this->blocks.end() - 1, std::move(block));
+            return result;
+        }
+        this->blocks.push_back(std::move(block));
+        this->position = 0;
+    }
+    this->statistics.used += size;
+    char* result = this->blocks.back().data.get() + this->position;
+    this->position += size;
+    return result;
+}
+
+Arena* Arena::find(const void* pointer) {
+    for (Arena* arena = Arena::first; arena; arena = arena->next) {
+        if (arena->contains(pointer)) {
+            return arena;
+        }
+    }
+    return nullptr;
+}
+
+Arena::Statistics Arena::getTotalStatistics() {
+    Statistics result;
+    for (Arena* arena = Arena::first; arena; arena = arena->next) {
+        result.blocks += arena->statistics.blocks;
+        result.capacity += arena->statistics.capacity;
+        result.used += arena->statistics.used;
+        result.released += arena->statistics.released;
+    }
+    return result;
+}
+
+bool Arena::contains(const void* pointer) const {
+    const char* p = static_cast<const char*>(pointer);
+    return std::any_of(
+        this->blocks.begin(), this->blocks.end(), [p](const Block& block) {
+        return p >= block.data.get() && p < block.data.get() + block.size;
+    });
+}
+
+std::size_t ArenaAllocated::liveBytes = 0;
+
+void* ArenaAllocated::operator new(std::size_t size) {
+    ArenaAllocated::liveBytes += size;
+    if (Arena* arena = Arena::getCurrent()) {
+        return arena->allocate(size);
+    }
+    return ::operator new(size);
+}
+
+void ArenaAllocated::operator delete(void* pointer, std::size_t size) {
+    ArenaAllocated::liveBytes -= size;
+    if (Arena* arena = Arena::find(pointer)) {
+        arena->statistics.released += align(size);
+        return;
+    }
+    ::operator delete(pointer);
+}
+
+}  // namespace tools
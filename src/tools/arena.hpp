@@ -0,0 +1,92 @@
+#ifndef TOOLS_ARENA_HPP
+#define TOOLS_ARENA_HPP
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace tools {
+
+// Allocates objects that live as long as the configuration from a few large
+// blocks instead of many small heap allocations, so that loading the
+// configuration does not fragment the heap. Deleted objects only count as
+// released, their memory is given back when the arena is destroyed. Objects
+// must not outlive their arena.
+class Arena {
+public:
+    struct Statistics {
+        std::size_t blocks = 0;
+        // Bytes in the blocks.
+        std::size_t capacity = 0;
+        // Bytes handed out, including the ones since released.
+        std::size_t used = 0;
+        std::size_t released = 0;
+    };
+
+    // While a scope is alive, ArenaAllocated objects are created in its arena.
+    class Scope {
+    public:
+        explicit Scope(Arena& arena) : previous(Arena::current) {
+            Arena::current = &arena;
+        }
+        ~Scope() { Arena::current = this->previous; }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        Arena* previous;
+    };
+
+    explicit Arena(std::size_t blockSize = 1024);
+    ~Arena();
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    void* allocate(std::size_t size);
+    const Statistics& getStatistics() const { return this->statistics; }
+
+    static Arena* getCurrent() { return Arena::current; }
+    // The arena that the pointer was allocated from, if any.
+    static Arena* find(const void* pointer);
+    static Statistics getTotalStatistics();
+
+private:
+    struct Block {
+        std::unique_ptr<char[]> data;
+        std::size_t size;
+    };
+
+    friend class ArenaAllocated;
+
+    bool contains(const void* pointer) const;
+
+    std::size_t blockSize;
+    std::vector<Block> blocks;
+    // Free space in the last block.
+    std::size_t position = 0;
+    Statistics statistics;
+    Arena* next;
+
+    static Arena* current;
+    static Arena* first;
+};
+
+// Objects of derived classes are created in the current arena, if there is
+// one, and on the heap otherwise.
+class ArenaAllocated {
+public:
+    static void* operator new(std::size_t size);
+    static void operator delete(void* pointer, std::size_t size);
+
+    // The size of the objects alive, wherever they were created.
+    static std::size_t getLiveBytes() { return ArenaAllocated::liveBytes; }
+
+private:
+    static std::size_t liveBytes;
+};
+
+}  // namespace tools
+
+#endif  // TOOLS_ARENA_HPP
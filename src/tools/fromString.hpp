@@ -1,14 +1,28 @@
 #include <optional>
+#include <type_traits>
 
 #include "../common/ArduinoJson.hpp"
+#include "number.hpp"
 
 namespace tools {
 
+// Numbers are read the same way as ArduinoJson would, but without a buffer.
 template <typename T>
 std::optional<T> fromString(const std::string& s) {
-    ArduinoJson::StaticJsonBuffer<20> buf;
-    auto json = buf.parse(s);
-    return json.is<T>() ? std::make_optional<T>(json.as<T>()) : std::nullopt;
+    if constexpr (std::is_same_v<T, int>) {
+        int result = 0;
+        return parseInt(s, result) ? std::make_optional(result) : std::nullopt;
+    } else if constexpr (std::is_floating_point_v<T>) {
+        double result = 0.0;
+        return parseFloat(s, result)
+                   ? std::make_optional(static_cast<T>(result))
+                   : std::nullopt;
+    } else {
+        ArduinoJson::StaticJsonBuffer<20> buf;
+        auto json = buf.parse(s);
+        return json.is<T>() ? std::make_optional<T>(json.as<T>())
+                            : std::nullopt;
+    }
 }
 
 }  // namespace tools
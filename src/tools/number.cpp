@@ -0,0 +1,315 @@
+#include "number.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+
+namespace tools {
+
+namespace {
+
+constexpr double powersOfTen[] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+constexpr int maxExactPower = 22;
+
+// Every integer up to this is exactly representable as a double.
+constexpr std::uint64_t maxExactMantissa = std::uint64_t{1} << 53;
+
+// The integer part of smaller magnitudes fits in 64 bits.
+constexpr double formatLimit = 18446744073709551616.0;
+
+// Longer numbers are not valid. Only checked when the C library is needed.
+constexpr std::size_t maxNumberLength = 64;
+
+bool isDigit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+bool isSpace(char c) {
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+// The characters that ArduinoJson reads as part of a value without quotes.
+bool isLiteralCharacter(char c) {
+    return isDigit(c) || (c >= '_' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+           c == '+' || c == '-' || c == '.';
+}
+
+bool isJsonSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+bool isSign(char c) {
+    return c == '+' || c == '-';
+}
+
+// Converts digits with an optional fraction and exponent, without a sign.
+// Only succeeds if the result is exactly rounded: the digits fit in the
+// mantissa, and a power of ten that is itself exact scales them with one
+// correctly rounded operation. Otherwise position is not changed.
+bool parseSimpleDecimal(
+    const char*& position, const char* end, double& result) {
+    const char* s = position;
+    std::uint64_t mantissa = 0;
+    int exponent = 0;
+    bool hasDigit = false;
+    auto addDigit = [&](char c) {
+        std::uint64_t digit = c - '0';
+        if (mantissa > (maxExactMantissa - digit) / 10) {
+            return false;
+        }
+        mantissa = mantissa * 10 + digit;
+        hasDigit = true;
+        return true;
+    };
+
+    for (; s != end && isDigit(*s); ++s) {
+        if (!addDigit(*s)) {
+            return false;
+        }
+    }
+    if (s != end && *s == '.') {
+        for (++s; s != end && isDigit(*s); ++s) {
+            if (!addDigit(*s)) {
+                return false;
+            }
+            --exponent;
+        }
+    }
+    if (!hasDigit) {
+        return false;
+    }
+
+    if (s != end && (*s == 'e' || *s == 'E')) {
+        const char* e = s + 1;
+        bool negative = false;
+        if (e != end && isSign(*e)) {
+            negative = *e == '-';
+            ++e;
+        }
+        if (e != end && isDigit(*e)) {
+            int value = 0;
+            for (; e != end && isDigit(*e); ++e) {
+                if (value > maxExactPower * 2) {
+                    return false;
+                }
+                value = value * 10 + (*e - '0');
+            }
+            exponent += negative ? -value : value;
+            s = e;
+        }
+    }
+
+    if (mantissa == 0) {
+        result = 0.0;
+    } else if (exponent < -maxExactPower || exponent > maxExactPower) {
+        return false;
+    } else {
+        double value = static_cast<double>(mantissa);
+        result = exponent < 0 ? value / powersOfTen[-exponent]
+                              : value * powersOfTen[exponent];
+    }
+    position = s;
+    return true;
+}
+
+// The same rules as ArduinoJson uses to tell whether a value is a number.
+bool isDecimal(std::string_view s) {
+    std::size_t i = 0;
+    while (i < s.size() && isDigit(s[i])) {
+        ++i;
+    }
+    if (i < s.size() && s[i] == '.') {
+        ++i;
+        while (i < s.size() && isDigit(s[i])) {
+            ++i;
+        }
+    }
+    if (i < s.size() && (s[i] == 'e' || s[i] == 'E')) {
+        ++i;
+        if (i < s.size() && isSign(s[i])) {
+            ++i;
+        }
+        if (i == s.size() || !isDigit(s[i])) {
+            return false;
+        }
+        while (i < s.size() && isDigit(s[i])) {
+            ++i;
+        }
+    }
+    return !s.empty() && i == s.size();
+}
+
+std::string_view getLiteral(std::string_view s) {
+    std::size_t begin = 0;
+    while (begin < s.size() && isJsonSpace(s[begin])) {
+        ++begin;
+    }
+    std::size_t end = begin;
+    while (end < s.size() && isLiteralCharacter(s[end])) {
+        ++end;
+    }
+    return s.substr(begin, end - begin);
+}
+
+char* formatUnsigned(char* buffer, std::uint64_t value) {
+    char digits[20];
+    char* begin = digits + sizeof(digits);
+    do {
+        *--begin = static_cast<char>('0' + value % 10);
+        value /= 10;
+    } while (value != 0);
+    std::size_t length = digits + sizeof(digits) - begin;
+    std::memcpy(buffer, begin, length);
+    return buffer + length;
+}
+
+bool removeSign(std::string_view& s) {
+    bool negative = !s.empty() && s[0] == '-';
+    if (!s.empty() && isSign(s[0])) {
+        s.remove_prefix(1);
+    }
+    return negative;
+}
+
+}  // unnamed namespace
+
+char* formatInt(char* buffer, int value, unsigned radix) {
+    constexpr const char* characters = "0123456789ABCDEF";
+
+    if (radix < 2 || radix > 16) {
+        return buffer;
+    }
+
+    unsigned magnitude = static_cast<unsigned>(value);
+    if (value < 0) {
+        *buffer++ = '-';
+        magnitude = 0u - magnitude;
+    }
+
+    char digits[maxIntLength];
+    char* begin = digits + maxIntLength;
+    do {
+        *--begin = characters[magnitude % radix];
+        magnitude /= radix;
+    } while (magnitude != 0);
+    std::size_t length = digits + maxIntLength - begin;
+    std::memcpy(buffer, begin, length);
+    return buffer + length;
+}
+
+char* formatFloat(char* buffer, double value, int decimals) {
+    if (std::isnan(value)) {
+        std::memcpy(buffer, "nan", 3);
+        return buffer + 3;
+    }
+    if (value < 0) {
+        *buffer++ = '-';
+        value *= -1;
+    }
+    if (std::isinf(value)) {
+        std::memcpy(buffer, "inf", 3);
+        return buffer + 3;
+    }
+    if (!(value < formatLimit)) {
+        value = std::nextafter(formatLimit, 0.0);
+    }
+    auto intpart = static_cast<std::uint64_t>(value);
+    buffer = formatUnsigned(buffer, intpart);
+    value -= static_cast<double>(intpart);
+    if (value == 0) {
+        return buffer;
+    }
+    *buffer++ = '.';
+    for (int i = 0; i < decimals; ++i) {
+        if (value == 0) {
+            break;
+        }
+        value *= 10;
+        int digit = static_cast<int>(value);
+        *buffer++ = static_cast<char>(digit + '0');
+        value -= digit;
+    }
+    return buffer;
+}
+
+double parseDouble(const char* s) {
+    const char* position = s;
+    while (isSpace(*position)) {
+        ++position;
+    }
+    bool negative = *position == '-';
+    if (isSign(*position)) {
+        ++position;
+    }
+    // Hexadecimal numbers are left to the C library.
+    if (position[0] != '0' || (position[1] != 'x' && position[1] != 'X')) {
+        double result = 0.0;
+        if (parseSimpleDecimal(
+                position, position + std::strlen(position), result)) {
+            return negative ? -result : result;
+        }
+    }
+    return std::strtod(s, nullptr);
+}
+
+bool parseInt(std::string_view s, int& result) {
+    std::string_view literal = getLiteral(s);
+    bool negative = removeSign(literal);
+    if (literal.empty()) {
+        return false;
+    }
+
+    // The magnitude of the smallest int is one more than the largest.
+    const std::uint64_t limit =
+        static_cast<std::uint64_t>(std::numeric_limits<int>::max()) +
+        (negative ? 1 : 0);
+    std::uint64_t value = 0;
+    for (char c : literal) {
+        if (!isDigit(c)) {
+            return false;
+        }
+        value = value * 10 + (c - '0');
+        if (value > limit) {
+            return false;
+        }
+    }
+    auto signedValue = static_cast<std::int64_t>(value);
+    result = static_cast<int>(negative ? -signedValue : signedValue);
+    return true;
+}
+
+bool parseFloat(std::string_view s, double& result) {
+    std::string_view literal = getLiteral(s);
+    if (literal == "NaN") {
+        result = std::numeric_limits<double>::quiet_NaN();
+        return true;
+    }
+    bool negative = removeSign(literal);
+    double value = 0.0;
+    if (literal == "Infinity") {
+        value = std::numeric_limits<double>::infinity();
+    } else if (!isDecimal(literal)) {
+        return false;
+    } else {
+        const char* position = literal.data();
+        if (!parseSimpleDecimal(
+                position, literal.data() + literal.size(), value)) {
+            if (literal.size() >= maxNumberLength) {
+                return false;
+            }
+            char buffer[maxNumberLength];
+            std::memcpy(buffer, literal.data(), literal.size());
+            buffer[literal.size()] = '\0';
+            value = std::strtod(buffer, nullptr);
+        }
+    }
+    result = negative ? -value : value;
+    return true;
+}
+
+}  // namespace tools
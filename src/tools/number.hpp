@@ -0,0 +1,43 @@
+#ifndef TOOLS_NUMBER_HPP
+#define TOOLS_NUMBER_HPP
+
+#include <cstddef>
+#include <string_view>
+
+namespace tools {
+
+// Number formatting and parsing that does not allocate memory. The format
+// functions write into a buffer given by the caller and return the end of what
+// they wrote. They do not write a terminating zero.
+
+// The sign and 32 binary digits.
+constexpr std::size_t maxIntLength = 33;
+
+// The sign, 20 digits of the integer part, the decimal point and the
+// decimals.
+constexpr std::size_t maxFloatLength(int decimals) {
+    return 22 + (decimals > 0 ? decimals : 0);
+}
+
+// Writes nothing if the radix is not between 2 and 16.
+char* formatInt(char* buffer, int value, unsigned radix = 10);
+
+// Decimals after the given number are cut off, not rounded. Stops earlier
+// when the remaining fraction is zero. NaN and infinity are written as "nan"
+// and "inf", which parseDouble() reads back. Other magnitudes of 2^64 and
+// above are written as the largest double below it.
+char* formatFloat(char* buffer, double value, int decimals);
+
+// Gives the same result as std::atof(). Simple decimal numbers are converted
+// directly, and only the rest is left to the C library.
+double parseDouble(const char* s);
+
+// Whitespace before the number is skipped. The number ends at the first
+// character that cannot be part of a JSON literal, and the rest is ignored.
+// Returns false if there is no valid number, or if it does not fit.
+bool parseInt(std::string_view s, int& result);
+bool parseFloat(std::string_view s, double& result);
+
+}  // namespace tools
+
+#endif  // TOOLS_NUMBER_HPP
@@ -0,0 +1,120 @@
+#ifndef TOOLS_SLOTVECTOR_HPP
+#define TOOLS_SLOTVECTOR_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <initializer_list>
+#include <utility>
+#include <vector>
+
+namespace tools {
+
+// A sequence of values that keeps up to N of them inline. Removing values
+// does not destroy them, so a value assigned later reuses the storage of the
+// one that was there before. Once it holds the same number of values as
+// before, assigning to it does not allocate memory.
+//
+// If it ever holds more than N values, all of them are moved to the heap and
+// stay there, so the values are always contiguous.
+template <typename T, std::size_t N>
+class SlotVector {
+public:
+    using value_type = T;
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    SlotVector() = default;
+    SlotVector(std::initializer_list<T> values) {
+        this->assign(values.begin(), values.end());
+    }
+    SlotVector(const std::vector<T>& values) {
+        this->assign(values.begin(), values.end());
+    }
+
+    SlotVector& operator=(std::initializer_list<T> values) {
+        this->assign(values.begin(), values.end());
+        return *this;
+    }
+    SlotVector& operator=(const std::vector<T>& values) {
+        this->assign(values.begin(), values.end());
+        return *this;
+    }
+
+    // Replaces the values. The elements of the range are assigned to the
+    // existing slots.
+    template <typename Iterator>
+    void assign(Iterator first, Iterator last) {
+        this->count = 0;
+        for (; first != last; ++first) {
+            this->push_back(*first);
+        }
+    }
+
+    // Adds a value. It accepts anything that can be assigned to T.
+    template <typename Value>
+    void push_back(Value&& value) {
+        if (this->count == this->capacity()) {
+            this->grow();
+            this->heap.emplace_back(std::forward<Value>(value));
+        } else {
+            this->data()[this->count] = std::forward<Value>(value);
+        }
+        ++this->count;
+    }
+
+    void clear() { this->count = 0; }
+
+    std::size_t size() const { return this->count; }
+    bool empty() const { return this->count == 0; }
+    std::size_t capacity() const {
+        return this->onHeap ? this->heap.size() : N;
+    }
+
+    T* data() { return this->onHeap ? this->heap.data() : this->slots.data(); }
+    const T* data() const {
+        return this->onHeap ? this->heap.data() : this->slots.data();
+    }
+
+    T& operator[](std::size_t index) { return this->data()[index]; }
+    const T& operator[](std::size_t index) const {
+        return this->data()[index];
+    }
+
+    T* begin() { return this->data(); }
+    T* end() { return this->data() + this->count; }
+    const T* begin() const { return this->data(); }
+    const T* end() const { return this->data() + this->count; }
+
+private:
+    // Called when all the slots are used. The new slot is added by the
+    // caller.
+    void grow() {
+        if (!this->onHeap) {
+            this->heap.reserve(N * 2);
+            for (T& value : this->slots) {
+                this->heap.push_back(std::move(value));
+            }
+            this->onHeap = true;
+        }
+    }
+
+    std::array<T, N> slots;
+    std::vector<T> heap;
+    std::size_t count = 0;
+    bool onHeap = false;
+};
+
+template <typename T, std::size_t N, typename Range>
+bool operator==(const SlotVector<T, N>& lhs, const Range& rhs) {
+    return std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+}
+
+template <typename T, std::size_t N, typename Range>
+bool operator!=(const SlotVector<T, N>& lhs, const Range& rhs) {
+    return !(lhs == rhs);
+}
+
+}  // namespace tools
+
+#endif  // TOOLS_SLOTVECTOR_HPP
@@ -2,6 +2,9 @@
 
 #include <algorithm>
 #include <cctype>
+#include <limits>
+
+#include "number.hpp"
 
 namespace tools {
 
@@ -20,54 +23,43 @@ std::string nextToken(
 }
 
 std::string intToString(int value, unsigned radix) {
-    constexpr const char* characters = "0123456789ABCDEF";
-
-    if (radix > 16) {
-        return "";
-    }
-
-    if (value == 0) {
-        return "0";
-    }
+    char buffer[maxIntLength];
+    return std::string(buffer, formatInt(buffer, value, radix));
+}
 
-    std::string result;
-    bool negative = value < 0;
-    if (negative) {
-        value *= -1;
-    }
-    while (value != 0) {
-        result += characters[value % radix];
-        value /= radix;
-    }
-    if (negative) {
-        result += '-';
-    }
-    std::reverse(result.begin(), result.end());
+std::string floatToString(double value, int decimals) {
+    std::string result(maxFloatLength(decimals), '\0');
+    result.resize(formatFloat(&result[0], value, decimals) - result.data());
     return result;
 }
 
-std::string floatToString(double value, int decimals) {
-    int intpart = static_cast<int>(value);
-    std::string result =
-        intpart == 0 && value < 0 ? "-0" : intToString(intpart);
-    value -= intpart;
-    if (value == 0) {
-        return result;
-    }
-    if (value < 0) {
-        value *= -1;
-    }
-    result += '.';
-    for (int i = 0; i < decimals; ++i) {
-        if (value == 0) {
-            break;
+ValueTemplate::ValueTemplate(const std::string& valueTemplate) {
+    constexpr std::size_t maxIndex = std::numeric_limits<std::size_t>::max();
+    for (std::size_t i = 0; i < valueTemplate.length(); ++i) {
+        if (valueTemplate[i] != '%') {
+            this->literals += valueTemplate[i];
+            continue;
         }
-        value *= 10;
-        intpart = static_cast<int>(value);
-        result += intpart + '0';
-        value -= intpart;
+
+        std::size_t start = ++i;
+        std::size_t index = 0;
+        for (; i < valueTemplate.length() && valueTemplate[i] >= '0' &&
+               valueTemplate[i] <= '9';
+             ++i) {
+            // Too large indices never refer to a value.
+            std::size_t digit = valueTemplate[i] - '0';
+            index = index < maxIndex / 10 ? index * 10 + digit : maxIndex;
+        }
+        if (i == start) {
+            // The character after a stray '%' is kept, even if it is '%'.
+            if (i < valueTemplate.length()) {
+                this->literals += valueTemplate[i];
+            }
+            continue;
+        }
+        this->segments.push_back(Segment{this->literals.size(), index});
+        --i;
     }
-    return result;
 }
 
 bool getBoolValue(const char* input, bool& output, int length) {
@@ -5,6 +5,7 @@
 #include <cstring>
 #include <memory>
 #include <string>
+#include <vector>
 
 namespace tools {
 
@@ -35,50 +36,60 @@ private:
     bool first = true;
 };
 
-namespace detail {
+// A template with %N references to values. It is parsed once into literal
+// parts and value indices, so that substituting only needs one pass.
+class ValueTemplate {
+public:
+    explicit ValueTemplate(const std::string& valueTemplate);
 
-template <typename Range>
-void addValue(
-    std::string& result, const std::string& reference, const Range& elements) {
-    std::size_t value = std::atol(reference.c_str());
-    if (value > 0 && value <= elements.size()) {
-        result += elements[value - 1];
+    template <typename Range>
+    std::string substitute(const Range& elements) const {
+        std::size_t length = this->literals.size();
+        for (const auto& segment : this->segments) {
+            if (const auto* element = getElement(elements, segment.index)) {
+                length += element->size();
+            }
+        }
+
+        std::string result;
+        result.reserve(length);
+        std::size_t position = 0;
+        for (const auto& segment : this->segments) {
+            result.append(
+                this->literals, position, segment.literalEnd - position);
+            position = segment.literalEnd;
+            if (const auto* element = getElement(elements, segment.index)) {
+                result += *element;
+            }
+        }
+        result.append(this->literals, position, std::string::npos);
+        return result;
     }
-}
 
-}  // namespace detail
+private:
+    // A value reference that comes after the literals up to literalEnd.
+    struct Segment {
+        std::size_t literalEnd;
+        std::size_t index;
+    };
+
+    template <typename Range>
+    static const std::string* getElement(
+        const Range& elements, std::size_t index) {
+        if (index == 0 || index > elements.size()) {
+            return nullptr;
+        }
+        return &elements[index - 1];
+    }
+
+    std::string literals;
+    std::vector<Segment> segments;
+};
 
 template <typename Range>
 std::string substitute(
     const std::string& valueTemplate, const Range& elements) {
-    std::string result;
-    std::string reference;
-    bool inReference = false;
-    for (std::size_t i = 0; i < valueTemplate.length(); ++i) {
-        if (inReference) {
-            if (valueTemplate[i] >= '0' && valueTemplate[i] <= '9') {
-                reference += valueTemplate[i];
-            } else {
-                inReference = false;
-                if (reference.length() == 0) {
-                    result += valueTemplate[i];
-                    reference = "";
-                    continue;
-                }
-                detail::addValue(result, reference, elements);
-                reference = "";
-            }
-        }
-        if (!inReference) {
-            if (valueTemplate[i] == '%') {
-                inReference = true;
-            } else {
-                result += valueTemplate[i];
-            }
-        }
-    }
-    detail::addValue(result, reference, elements);
-    return result;
+    return ValueTemplate{valueTemplate}.substitute(elements);
 }
 
 bool getBoolValue(const char* input, bool& output, int length = -1);
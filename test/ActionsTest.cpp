@@ -0,0 +1,107 @@
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "EspTestBase.hpp"
+#include "common/Actions.hpp"
+#include "common/InterfaceConfig.hpp"
+#include "tools/string.hpp"
+
+namespace {
+
+// Counts the allocations of the whole test program.
+std::size_t allocationCount = 0;
+
+class CountingAction : public Action {
+public:
+    void fire(const InterfaceConfig& /*interface*/) override { ++this->count; }
+    void reset() override {}
+
+    int count = 0;
+};
+
+}  // unnamed namespace
+
+void* operator new(std::size_t size) {
+    ++allocationCount;
+    if (void* result = std::malloc(size == 0 ? 1 : size)) {
+        return result;
+    }
+    throw std::bad_alloc{};
+}
+
+void operator delete(void* pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t /*size*/) noexcept {
+    std::free(pointer);
+}
+
+struct ActionsTest : EspTestBase {
+    InterfaceConfig interface;
+    std::shared_ptr<CountingAction> action =
+        std::make_shared<CountingAction>();
+
+    ActionsTest() { this->interface.actions.push_back(this->action); }
+
+    Actions actions() { return Actions{this->interface, this->esp}; }
+};
+
+TEST_F(ActionsTest, StoresValues) {
+    this->esp.delay(100);
+    this->actions().fire({"1", "foo"});
+    ASSERT_EQ(this->interface.storedValue.size(), 2);
+    EXPECT_EQ(this->interface.storedValue[0], "1");
+    EXPECT_EQ(this->interface.storedValue[1], "foo");
+    EXPECT_EQ(this->interface.generation, 1);
+    EXPECT_EQ(this->interface.lastFired, 100);
+    EXPECT_EQ(this->action->count, 1);
+
+    this->actions().fire(std::vector<std::string>{"1", "foo"});
+    EXPECT_EQ(this->interface.generation, 1);
+    EXPECT_EQ(this->action->count, 2);
+
+    this->actions().fire({"2"});
+    ASSERT_EQ(this->interface.storedValue.size(), 1);
+    EXPECT_EQ(this->interface.storedValue[0], "2");
+    EXPECT_EQ(this->interface.generation, 2);
+    EXPECT_EQ(this->action->count, 3);
+}
+
+TEST_F(ActionsTest, EmptyValuesDoNotFire) {
+    this->actions().fire({"1"});
+    this->esp.delay(100);
+    this->actions().fire({});
+    EXPECT_TRUE(this->interface.storedValue.empty());
+    EXPECT_EQ(this->interface.generation, 2);
+    EXPECT_EQ(this->interface.lastFired, 0);
+    EXPECT_EQ(this->action->count, 1);
+}
+
+TEST_F(ActionsTest, FiringDoesNotAllocate) {
+    const std::string longValue(100, 'a');
+    const std::string otherLongValue(90, 'b');
+    const std::vector<std::string> values{"1", longValue, "3"};
+    this->actions().fire({"0", longValue, "0"});
+
+    std::size_t allocations = allocationCount;
+    // Check that allocations are counted at all.
+    std::make_unique<int>();
+    EXPECT_EQ(allocationCount, allocations + 1);
+    allocations = allocationCount;
+    for (int i = 0; i < 100; ++i) {
+        this->actions().fire(
+            {tools::intToString(i), i % 2 == 0 ? longValue : otherLongValue,
+             tools::intToString(i * 1000)});
+        this->actions().fire({tools::intToString(i)});
+        this->actions().fire(values);
+    }
+    EXPECT_EQ(allocationCount, allocations);
+    EXPECT_EQ(this->action->count, 301);
+    EXPECT_EQ(this->interface.storedValue[1], longValue);
+}
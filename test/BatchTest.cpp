@@ -0,0 +1,206 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "Benchmark.hpp"
+#include "common/InterfaceConfig.hpp"
+#include "operation/Batch.hpp"
+#include "operation/OperationParser2.hpp"
+#include "operation/Operations.hpp"
+
+struct BatchTest : ::testing::Test {
+    std::vector<std::unique_ptr<InterfaceConfig>> interfaces;
+    std::stringstream debug;
+    std::mt19937 random{42};
+
+    BatchTest() {
+        for (const char* name : {"a", "b", "c"}) {
+            this->interfaces.emplace_back(std::make_unique<InterfaceConfig>());
+            this->interfaces.back()->name = name;
+        }
+        // Has no input, so it keeps its value in every row.
+        this->interfaces.back()->storedValue = {"7", "1.5"};
+    }
+
+    std::unique_ptr<operation::Operation> parse(const std::string& expression) {
+        operation::Parser2 parser{
+            this->debug, this->interfaces, this->interfaces[0].get()};
+        return parser.parse(expression);
+    }
+
+    // Numbers of different magnitudes and precision, and some values that
+    // are not numbers.
+    std::vector<std::string> createValues(std::size_t rows) {
+        static const std::vector<std::string> special{
+            "", "x", "0", "-0", "16777217", "0.1234567", "1e3", "-2.5"};
+        std::uniform_int_distribution<int> kind{0, 3};
+        std::uniform_int_distribution<std::size_t> index{
+            0, special.size() - 1};
+        std::uniform_real_distribution<float> number{-100.0f, 100.0f};
+        std::vector<std::string> result;
+        for (std::size_t row = 0; row < rows; ++row) {
+            switch (kind(this->random)) {
+            case 0:
+                result.push_back(special[index(this->random)]);
+                break;
+            case 1:
+                result.push_back(std::to_string(
+                    static_cast<int>(number(this->random))));
+                break;
+            default:
+                result.push_back(std::to_string(number(this->random)));
+            }
+        }
+        return result;
+    }
+
+    void expectSameAsRowByRow(const std::string& expression) {
+        constexpr std::size_t rows = 200;
+        std::vector<std::vector<std::string>> inputs{
+            this->createValues(rows), this->createValues(rows),
+            this->createValues(rows)};
+
+        auto operation = this->parse(expression);
+        ASSERT_NE(operation, nullptr) << expression;
+        std::vector<std::string> expected;
+        for (std::size_t row = 0; row < rows; ++row) {
+            this->interfaces[0]->storedValue = {inputs[0][row], inputs[1][row]};
+            this->interfaces[1]->storedValue = {inputs[2][row]};
+            expected.push_back(operation->evaluate());
+        }
+
+        operation = this->parse(expression);
+        operation::Batch batch{rows};
+        batch.setInput(*this->interfaces[0], 1, inputs[0]);
+        batch.setInput(*this->interfaces[0], 2, inputs[1]);
+        batch.setInput(*this->interfaces[1], 1, inputs[2]);
+        EXPECT_EQ(batch.evaluate(*operation), expected) << expression;
+    }
+};
+
+TEST_F(BatchTest, Arithmetic) {
+    this->expectSameAsRowByRow("[a] + [b]");
+    this->expectSameAsRowByRow("[a] - [b] - 1.5");
+    this->expectSameAsRowByRow("[a] * [b] / [a].2");
+    this->expectSameAsRowByRow("([a] + 0.1) * 3 - [b] / 7");
+    this->expectSameAsRowByRow("%1 + %2 * [c] + [c].2");
+}
+
+TEST_F(BatchTest, Comparisons) {
+    this->expectSameAsRowByRow("[a] == [b]");
+    this->expectSameAsRowByRow("[a] != 0");
+    this->expectSameAsRowByRow("[a] < [b]");
+    this->expectSameAsRowByRow("[a] <= [b] * 2");
+    this->expectSameAsRowByRow("-10 < [a] < [b] <= 50");
+    this->expectSameAsRowByRow("[a] >= [a].2 > [c]");
+}
+
+TEST_F(BatchTest, MixedWithRowByRow) {
+    this->expectSameAsRowByRow("([a] > [b]) + 1");
+    this->expectSameAsRowByRow("[a] > 0 && [b] > 0");
+    this->expectSameAsRowByRow("[a] < [b] ? [a] * 2 : 'low'");
+    this->expectSameAsRowByRow("([a] s+ [b]) + 1");
+    this->expectSameAsRowByRow("[a] s== 'x' ? 0 : [a] + [b]");
+}
+
+TEST_F(BatchTest, StatefulOperations) {
+    this->expectSameAsRowByRow("avg([a], 5) + [b]");
+    this->expectSameAsRowByRow("[a] > 10 ? avg([b], 3) : 0");
+    this->expectSameAsRowByRow("changed([a] > [b])");
+    this->expectSameAsRowByRow("min([a] + [b], 3) * 2");
+}
+
+TEST_F(BatchTest, RoundKernel) {
+    std::vector<float> values{
+        0.0f, -0.0f, 1.0f, -1.5f, 0.1f, 0.1234567f, -0.0000001f, 16777217.0f,
+        1e20f, -1e30f, std::numeric_limits<float>::infinity(),
+        -std::numeric_limits<float>::infinity(),
+        std::numeric_limits<float>::min(),
+        std::numeric_limits<float>::denorm_min()};
+    std::uniform_int_distribution<std::uint32_t> bits;
+    for (int i = 0; i < 100000; ++i) {
+        std::uint32_t value = bits(this->random);
+        values.push_back(0.0f);
+        std::memcpy(&values.back(), &value, sizeof(value));
+        if (std::isnan(values.back())) {
+            values.pop_back();
+        }
+    }
+
+    std::vector<float> rounded = values;
+    operation::detail::roundKernel(rounded.data(), rounded.size());
+    for (std::size_t i = 0; i < values.size(); ++i) {
+        float expected =
+            operation::TypedValue::fromNumber(values[i]).asNumber();
+        EXPECT_EQ(std::signbit(rounded[i]), std::signbit(expected))
+            << values[i];
+        EXPECT_EQ(rounded[i], expected) << values[i];
+    }
+}
+
+TEST_F(BatchTest, HigherIndexThanInput) {
+    auto operation = this->parse("[b].2 s+ [c].2");
+    ASSERT_NE(operation, nullptr);
+    operation::Batch batch{2};
+    batch.setInput(*this->interfaces[1], 1, {"1", "2"});
+    EXPECT_EQ(batch.evaluate(*operation),
+              (std::vector<std::string>{"1.5", "1.5"}));
+}
+
+TEST_F(BatchTest, KeepsLastRow) {
+    auto operation = this->parse("[a] + 1");
+    ASSERT_NE(operation, nullptr);
+    operation::Batch batch{3};
+    batch.setInput(*this->interfaces[0], 1, {"1", "2", "3"});
+    EXPECT_EQ(batch.evaluate(*operation),
+              (std::vector<std::string>{"2", "3", "4"}));
+
+    auto rowByRow = this->parse("[a] s+ ''");
+    ASSERT_NE(rowByRow, nullptr);
+    EXPECT_EQ(batch.evaluate(*rowByRow),
+              (std::vector<std::string>{"1", "2", "3"}));
+    EXPECT_EQ(this->interfaces[0]->storedValue,
+              (std::vector<std::string>{"3"}));
+}
+
+TEST_F(BatchTest, DISABLED_Benchmark) {
+    constexpr std::size_t rows = 10000;
+    constexpr int iterations = 100;
+    auto a = this->createValues(rows);
+    auto b = this->createValues(rows);
+    for (const char* expression :
+         {"[a] + [b] * 2 - 1", "0 < [a] + [b] < 50", "[a] s+ [b]"}) {
+        auto operation = this->parse(expression);
+        ASSERT_NE(operation, nullptr);
+        std::size_t length = 0;
+        double rowByRow = measure(iterations, [&](int) {
+            std::vector<std::string> result;
+            result.reserve(rows);
+            for (std::size_t row = 0; row < rows; ++row) {
+                this->interfaces[0]->storedValue = {a[row]};
+                this->interfaces[1]->storedValue = {b[row]};
+                result.push_back(operation->evaluate());
+            }
+            length += result.size();
+        });
+        double batch = measure(iterations, [&](int) {
+            operation::Batch batch{rows};
+            batch.setInput(*this->interfaces[0], 1, a);
+            batch.setInput(*this->interfaces[1], 1, b);
+            length += batch.evaluate(*operation).size();
+        });
+        std::cout << expression << ": row by row " << rowByRow / rows
+                  << " ns/row, batch " << batch / rows << " ns/row"
+                  << std::endl;
+        EXPECT_NE(length, 0);
+    }
+}
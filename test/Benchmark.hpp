@@ -0,0 +1,22 @@
+#ifndef TEST_BENCHMARK_HPP
+#define TEST_BENCHMARK_HPP
+
+#include <chrono>
+
+// The benchmarks are disabled tests, so they do not slow down the unit tests.
+// Run them with --gtest_also_run_disabled_tests --gtest_filter='*Benchmark*'.
+
+// Calls the function with the numbers from 0 to iterations - 1, and returns
+// the average time of a call in nanoseconds.
+template <typename Function>
+double measure(int iterations, Function function) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        function(i);
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() /
+           iterations;
+}
+
+#endif  // TEST_BENCHMARK_HPP
@@ -0,0 +1,159 @@
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "EspTestBase.hpp"
+#include "common/Actions.hpp"
+#include "common/CoalescedAction.hpp"
+#include "common/Interface.hpp"
+#include "common/InterfaceConfig.hpp"
+#include "common/Scheduler.hpp"
+#include "common/TimerWheel.hpp"
+
+namespace {
+
+// Records the values of the interfaces each time it is fired.
+class RecordingAction : public Action {
+public:
+    RecordingAction(
+        const std::vector<std::unique_ptr<InterfaceConfig>>& interfaces,
+        std::vector<std::string>& fired)
+        : interfaces(interfaces), fired(fired) {}
+
+    void fire(const InterfaceConfig& interface) override {
+        std::string value = interface.name + ":";
+        for (const auto& other : this->interfaces) {
+            value += " " + other->storedValue[0];
+        }
+        this->fired.push_back(value);
+    }
+    void reset() override { ++this->resets; }
+
+    int resets = 0;
+
+private:
+    const std::vector<std::unique_ptr<InterfaceConfig>>& interfaces;
+    std::vector<std::string>& fired;
+};
+
+// Fires its next value when updated.
+class ValueInterface : public Interface {
+public:
+    void start() override {}
+    void execute(const std::string& /*command*/) override {}
+    void update(Actions action) override {
+        if (!this->value.empty()) {
+            action.fire({this->value});
+            this->value.clear();
+        }
+    }
+
+    std::string value;
+};
+
+}  // unnamed namespace
+
+struct CoalescedActionTest : EspTestBase {
+    std::vector<std::unique_ptr<InterfaceConfig>> interfaces;
+    std::vector<std::string> fired;
+
+    CoalescedActionTest() {
+        this->addInterface("a");
+        this->addInterface("b");
+    }
+
+    ~CoalescedActionTest() { CoalescedAction::firePending(); }
+
+    void addInterface(std::string name) {
+        this->interfaces.emplace_back(std::make_unique<InterfaceConfig>());
+        this->interfaces.back()->name = std::move(name);
+        this->interfaces.back()->storedValue = {"0"};
+        this->interfaces.back()->interface =
+            std::make_unique<ValueInterface>();
+    }
+
+    std::shared_ptr<Action> addAction(bool coalesce) {
+        std::unique_ptr<Action> action =
+            std::make_unique<RecordingAction>(this->interfaces, this->fired);
+        if (coalesce) {
+            action = std::make_unique<CoalescedAction>(std::move(action));
+        }
+        std::shared_ptr<Action> result = std::move(action);
+        for (const auto& interface : this->interfaces) {
+            interface->actions.push_back(result);
+        }
+        return result;
+    }
+
+    void fire(std::size_t index, const std::string& value) {
+        Actions{*this->interfaces[index], this->esp}.fire({value});
+    }
+
+    void setNext(std::size_t index, std::string value) {
+        static_cast<ValueInterface&>(*this->interfaces[index]->interface)
+            .value = std::move(value);
+    }
+};
+
+TEST_F(CoalescedActionTest, NotCoalesced) {
+    this->addAction(false);
+    this->fire(0, "1");
+    this->fire(1, "2");
+    EXPECT_EQ(this->fired, (std::vector<std::string>{"a: 1 0", "b: 1 2"}));
+}
+
+TEST_F(CoalescedActionTest, FiresOncePerLoop) {
+    auto action = this->addAction(true);
+    this->fire(0, "1");
+    this->fire(1, "2");
+    this->fire(0, "3");
+    EXPECT_TRUE(this->fired.empty());
+    EXPECT_TRUE(static_cast<CoalescedAction&>(*action).isPending());
+
+    EXPECT_TRUE(CoalescedAction::firePending());
+    EXPECT_EQ(this->fired, (std::vector<std::string>{"a: 3 2"}));
+    EXPECT_FALSE(static_cast<CoalescedAction&>(*action).isPending());
+    EXPECT_FALSE(CoalescedAction::firePending());
+    EXPECT_EQ(this->fired.size(), 1);
+}
+
+TEST_F(CoalescedActionTest, MoreActions) {
+    auto first = this->addAction(true);
+    auto second = this->addAction(true);
+    this->fire(1, "2");
+    EXPECT_TRUE(CoalescedAction::firePending());
+    EXPECT_EQ(this->fired, (std::vector<std::string>{"b: 0 2", "b: 0 2"}));
+}
+
+TEST_F(CoalescedActionTest, DestroyedWhilePending) {
+    auto first = this->addAction(true);
+    auto second = this->addAction(true);
+    this->fire(0, "1");
+    for (const auto& interface : this->interfaces) {
+        interface->actions.erase(interface->actions.begin());
+    }
+    first.reset();
+    EXPECT_TRUE(CoalescedAction::firePending());
+    EXPECT_EQ(this->fired, (std::vector<std::string>{"a: 1 0"}));
+}
+
+TEST_F(CoalescedActionTest, Reset) {
+    auto action = std::make_unique<RecordingAction>(
+        this->interfaces, this->fired);
+    auto& recording = *action;
+    CoalescedAction coalesced{std::move(action)};
+    coalesced.reset();
+    EXPECT_EQ(recording.resets, 1);
+}
+
+TEST_F(CoalescedActionTest, Scheduler) {
+    TimerWheel timers{this->esp};
+    Scheduler scheduler{this->esp, timers, 20};
+    this->addAction(true);
+    this->setNext(0, "1");
+    this->setNext(1, "2");
+    EXPECT_EQ(scheduler.update(this->interfaces), 1);
+    EXPECT_EQ(this->fired, (std::vector<std::string>{"b: 1 2"}));
+}
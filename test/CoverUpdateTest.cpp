@@ -55,7 +55,7 @@ public:
 
     CoverUpdate updateImpl{this->ctx, this->up, this->down, this->stopper};
     InterfaceConfig config;
-    Actions actions{this->config};
+    Actions actions{this->config, this->esp};
 
     CoverUpdateTest()
         : ctx{
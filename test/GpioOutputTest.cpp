@@ -0,0 +1,69 @@
+#include <gtest/gtest.h>
+
+#include <memory>
+
+#include "EspTestBase.hpp"
+#include "common/GpioOutput.hpp"
+#include "common/TimerWheel.hpp"
+
+namespace {
+
+constexpr uint8_t pin = 5;
+
+}  // unnamed namespace
+
+struct GpioOutputTest : EspTestBase {
+    TimerWheel timers{this->esp};
+    std::unique_ptr<GpioOutput> output;
+
+    void create(bool defaultValue, bool invert) {
+        this->output = std::make_unique<GpioOutput>(
+            this->debug, this->esp, this->timers, this->rtc, pin,
+            defaultValue, invert);
+        this->output->start();
+    }
+
+    // Steps the time by 1 ms until the given time.
+    void runUntil(unsigned long time) {
+        this->delayUntil(time, 1, [this]() { this->timers.update(); });
+    }
+};
+
+TEST_F(GpioOutputTest, Blink) {
+    this->create(false, false);
+    this->output->execute("blink 100 200");
+    this->timers.update();
+    EXPECT_EQ(this->esp.digitalRead(pin), 1);
+    this->runUntil(99);
+    EXPECT_EQ(this->esp.digitalRead(pin), 1);
+    this->runUntil(100);
+    EXPECT_EQ(this->esp.digitalRead(pin), 0);
+    this->runUntil(299);
+    EXPECT_EQ(this->esp.digitalRead(pin), 0);
+    this->runUntil(300);
+    EXPECT_EQ(this->esp.digitalRead(pin), 1);
+    this->runUntil(400);
+    EXPECT_EQ(this->esp.digitalRead(pin), 0);
+
+    this->output->execute("1");
+    EXPECT_EQ(this->esp.digitalRead(pin), 1);
+    this->runUntil(1000);
+    EXPECT_EQ(this->esp.digitalRead(pin), 1);
+    EXPECT_EQ(this->timers.size(), 0);
+}
+
+TEST_F(GpioOutputTest, Invert) {
+    this->create(true, true);
+    EXPECT_EQ(this->esp.digitalRead(pin), 0);
+    this->output->execute("toggle");
+    EXPECT_EQ(this->esp.digitalRead(pin), 1);
+}
+
+TEST_F(GpioOutputTest, ValueIsKeptInRtc) {
+    this->create(false, false);
+    this->output->execute("on");
+    // After a reboot, the value is read back.
+    this->rtc.reset();
+    this->create(false, false);
+    EXPECT_EQ(this->esp.digitalRead(pin), 1);
+}
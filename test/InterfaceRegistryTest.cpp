@@ -0,0 +1,206 @@
+#include <gtest/gtest.h>
+
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Benchmark.hpp"
+#include "EspTestBase.hpp"
+#include "common/ArduinoJson.hpp"
+#include "common/InterfaceConfig.hpp"
+#include "operation/OperationParser.hpp"
+#include "operation/OperationParser2.hpp"
+
+using namespace ArduinoJson;
+
+struct InterfaceRegistryTest : EspTestBase {
+    std::vector<std::unique_ptr<InterfaceConfig>> interfaces;
+
+    void addInterface(std::string name) {
+        this->interfaces.emplace_back(std::make_unique<InterfaceConfig>());
+        this->interfaces.back()->name = std::move(name);
+        this->interfaces.back()->storedValue = {"0", "0"};
+    }
+};
+
+TEST_F(InterfaceRegistryTest, FindByName) {
+    this->addInterface("foo");
+    this->addInterface("bar");
+    InterfaceRegistry registry{this->interfaces};
+    EXPECT_EQ(registry.find("foo"), this->interfaces[0].get());
+    EXPECT_EQ(registry.find("bar"), this->interfaces[1].get());
+    EXPECT_EQ(findInterface(registry, "bar"), this->interfaces[1].get());
+}
+
+TEST_F(InterfaceRegistryTest, NotFound) {
+    this->addInterface("foo");
+    InterfaceRegistry registry{this->interfaces};
+    EXPECT_EQ(registry.find("fo"), nullptr);
+    EXPECT_EQ(registry.find(""), nullptr);
+    EXPECT_EQ(InterfaceRegistry{}.find("foo"), nullptr);
+}
+
+TEST_F(InterfaceRegistryTest, FirstOfSameNameIsFound) {
+    this->addInterface("foo");
+    this->addInterface("foo");
+    InterfaceRegistry registry{this->interfaces};
+    EXPECT_EQ(registry.find("foo"), this->interfaces[0].get());
+}
+
+TEST_F(InterfaceRegistryTest, SharedBetweenParsers) {
+    this->addInterface("foo");
+    this->addInterface("bar");
+    InterfaceRegistry registry{this->interfaces};
+    operation::Parser2 parser{
+        this->debug, registry, this->interfaces[0].get()};
+    auto operation = parser.parse("[bar] s+ %1");
+    ASSERT_NE(operation, nullptr);
+    this->interfaces[1]->storedValue[0] = "x";
+    EXPECT_EQ(operation->evaluate(), "x0");
+}
+
+TEST_F(InterfaceRegistryTest, DISABLED_BenchmarkConfigLoading) {
+    constexpr int interfaceCount = 200;
+    constexpr int actionCount = 500;
+    for (int i = 0; i < interfaceCount; ++i) {
+        this->addInterface("interface_" + std::to_string(i));
+    }
+
+    auto name = [](int i) {
+        return "interface_" + std::to_string(i % interfaceCount);
+    };
+    std::string config = R"({"actions": [)";
+    for (int i = 0; i < actionCount; ++i) {
+        if (i != 0) {
+            config += ",";
+        }
+        config += R"({"type": "publish", "interface": ")" + name(i) + "\", ";
+        if (i % 5 == 0) {
+            config += R"("payload": {"type": "+", "ops": [)"
+                      R"({"type": "value", "interface": ")" +
+                      name(i * 7) +
+                      R"("}, {"type": "value", "interface": ")" +
+                      name(i * 13) + "\"}]}}";
+        } else {
+            config += "\"payload\": \"[" + name(i * 7) + "] + [" +
+                      name(i * 13) + "].2 > %1 ? [" + name(i * 3) +
+                      "] : 'off'\"}";
+        }
+    }
+    config += "]}";
+
+    DynamicJsonBuffer buffer{4096};
+    auto& data = buffer.parseObject(config);
+    ASSERT_TRUE(data.success());
+    const JsonArray& actions = data["actions"];
+    ASSERT_EQ(actions.size(), actionCount);
+
+    constexpr int iterations = 10;
+    auto parseAction = [&](const JsonObject& action, auto& interfaces) {
+        auto defaultInterface = findInterface(
+            interfaces, action.get<std::string>("interface"));
+        ASSERT_NE(defaultInterface, nullptr);
+        if (action["payload"].is<std::string>()) {
+            operation::Parser2 parser{
+                this->debug, interfaces, defaultInterface};
+            ASSERT_NE(
+                parser.parse(action.get<std::string>("payload")), nullptr);
+        } else {
+            operation::Parser parser{interfaces, defaultInterface};
+            ASSERT_NE(parser.parse(action, "payload", nullptr), nullptr);
+        }
+    };
+
+    double separate = measure(iterations, [&](int /*i*/) {
+        for (const JsonObject& action : actions) {
+            parseAction(action, this->interfaces);
+        }
+    });
+    double shared = measure(iterations, [&](int /*i*/) {
+        InterfaceRegistry registry{this->interfaces};
+        for (const JsonObject& action : actions) {
+            parseAction(action, registry);
+        }
+    });
+    std::cout << interfaceCount << " interfaces, " << actionCount
+              << " actions: " << separate / 1e6
+              << " ms with a registry per parser, " << shared / 1e6
+              << " ms with a shared registry" << std::endl;
+}
+
+struct SortInterfacesTest : InterfaceRegistryTest {
+    std::vector<std::string> getNames() const {
+        std::vector<std::string> result;
+        for (const auto& interface : this->interfaces) {
+            result.push_back(interface->name);
+        }
+        return result;
+    }
+
+    const InterfaceConfig* get(std::size_t index) const {
+        return this->interfaces[index].get();
+    }
+};
+
+TEST_F(SortInterfacesTest, KeepsOrderWithoutDependencies) {
+    this->addInterface("a");
+    this->addInterface("b");
+    this->addInterface("c");
+    EXPECT_TRUE(sortInterfaces(this->interfaces, {}).empty());
+    EXPECT_EQ(this->getNames(), (std::vector<std::string>{"a", "b", "c"}));
+}
+
+TEST_F(SortInterfacesTest, Chain) {
+    this->addInterface("publish");
+    this->addInterface("relay");
+    this->addInterface("button");
+    this->addInterface("other");
+    EXPECT_TRUE(sortInterfaces(
+                    this->interfaces, {{this->get(2), this->get(1)},
+                                       {this->get(1), this->get(0)}})
+                    .empty());
+    EXPECT_EQ(
+        this->getNames(),
+        (std::vector<std::string>{"button", "relay", "publish", "other"}));
+}
+
+TEST_F(SortInterfacesTest, MoreDependencies) {
+    this->addInterface("a");
+    this->addInterface("b");
+    this->addInterface("c");
+    this->addInterface("d");
+    // d -> a, c -> a, d -> b
+    EXPECT_TRUE(sortInterfaces(
+                    this->interfaces, {{this->get(3), this->get(0)},
+                                       {this->get(2), this->get(0)},
+                                       {this->get(3), this->get(1)},
+                                       {this->get(3), this->get(1)}})
+                    .empty());
+    EXPECT_EQ(this->getNames(), (std::vector<std::string>{"c", "d", "a", "b"}));
+}
+
+TEST_F(SortInterfacesTest, SelfDependency) {
+    this->addInterface("a");
+    this->addInterface("b");
+    EXPECT_TRUE(
+        sortInterfaces(this->interfaces, {{this->get(1), this->get(1)}})
+            .empty());
+    EXPECT_EQ(this->getNames(), (std::vector<std::string>{"a", "b"}));
+}
+
+TEST_F(SortInterfacesTest, Cycle) {
+    this->addInterface("a");
+    this->addInterface("b");
+    this->addInterface("c");
+    this->addInterface("d");
+    const InterfaceConfig* a = this->get(0);
+    const InterfaceConfig* b = this->get(1);
+    const InterfaceConfig* c = this->get(2);
+    const InterfaceConfig* d = this->get(3);
+    // a -> b -> c -> b, d -> a
+    EXPECT_EQ(
+        sortInterfaces(this->interfaces, {{a, b}, {b, c}, {c, b}, {d, a}}),
+        (std::vector<const InterfaceConfig*>{b, c}));
+    EXPECT_EQ(this->getNames(), (std::vector<std::string>{"d", "a", "b", "c"}));
+}
@@ -14,7 +14,7 @@ public:
     std::string getValue(size_t index);
 
 private:
-    Actions actions{interface};
+    Actions actions{interface, esp};
 };
 
 #endif  // TEST_INTERFACETESTBASE_HPP
@@ -0,0 +1,26 @@
+#include <gtest/gtest.h>
+
+#include "EspTestBase.hpp"
+#include "common/KeepaliveInterface.hpp"
+#include "common/TimerWheel.hpp"
+
+struct KeepaliveInterfaceTest : EspTestBase {
+    TimerWheel timers{this->esp};
+};
+
+TEST_F(KeepaliveInterfaceTest, ResetsPeriodically) {
+    constexpr unsigned interval = 1000;
+    constexpr unsigned resetInterval = 10;
+    KeepaliveInterface keepalive{this->esp, this->timers, 4, interval,
+        resetInterval};
+    // Each reset waits for resetInterval, which moves the time forward.
+    this->timers.update();
+    EXPECT_EQ(this->esp.millis(), resetInterval);
+    this->esp.delay(interval - 1);
+    this->timers.update();
+    EXPECT_EQ(this->esp.millis(), interval + resetInterval - 1);
+    this->esp.delay(1);
+    this->timers.update();
+    EXPECT_EQ(this->esp.millis(), interval + resetInterval * 2);
+    EXPECT_EQ(this->timers.size(), 1);
+}
@@ -0,0 +1,112 @@
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "EspTestBase.hpp"
+#include "common/Actions.hpp"
+#include "common/InterfaceConfig.hpp"
+#include "operation/Memoized.hpp"
+#include "operation/OperationParser2.hpp"
+#include "operation/Operations.hpp"
+
+struct MemoizedTest : EspTestBase {
+    std::vector<std::unique_ptr<InterfaceConfig>> interfaces;
+
+    MemoizedTest() { operation::Memoized::statistics = {}; }
+
+    void addInterface(std::string name, std::vector<std::string> values) {
+        this->interfaces.emplace_back(std::make_unique<InterfaceConfig>());
+        this->interfaces.back()->name = std::move(name);
+        this->interfaces.back()->storedValue = std::move(values);
+    }
+
+    void fire(std::size_t index, std::vector<std::string> values) {
+        Actions{*this->interfaces[index], this->esp}.fire(values);
+    }
+
+    std::unique_ptr<operation::Operation> parse(const std::string& data) {
+        operation::Parser2 parser{this->debug, this->interfaces, nullptr};
+        auto operation = parser.parse(data);
+        EXPECT_NE(operation, nullptr);
+        return operation::memoize(std::move(operation));
+    }
+
+    void expectStatistics(unsigned long hits, unsigned long misses) {
+        EXPECT_EQ(operation::Memoized::statistics.hits, hits);
+        EXPECT_EQ(operation::Memoized::statistics.misses, misses);
+    }
+};
+
+TEST_F(MemoizedTest, ValueIsKeptUntilInterfaceChanges) {
+    this->addInterface("itf1", {"2"});
+    this->addInterface("itf2", {"3"});
+    auto operation = this->parse("[itf1] * [itf2] + 1");
+    EXPECT_EQ(operation->evaluate(), "7");
+    this->expectStatistics(0, 1);
+    EXPECT_EQ(operation->evaluate(), "7");
+    this->expectStatistics(1, 1);
+
+    this->fire(1, {"3"});
+    EXPECT_EQ(operation->evaluate(), "7");
+    this->expectStatistics(2, 1);
+
+    this->fire(1, {"5"});
+    EXPECT_EQ(operation->evaluate(), "11");
+    this->expectStatistics(2, 2);
+}
+
+TEST_F(MemoizedTest, OperandOfUnchangedInterfaceIsKept) {
+    this->addInterface("itf1", {"1"});
+    this->addInterface("itf2", {"foo"});
+    auto operation =
+        this->parse("[itf1] > 0 ? [itf2] s+ 'bar' : [itf2] s+ 'baz'");
+    EXPECT_EQ(operation->evaluate(), "foobar");
+    // The whole expression, the condition and the branch that was taken.
+    this->expectStatistics(0, 3);
+
+    this->fire(0, {"2"});
+    EXPECT_EQ(operation->evaluate(), "foobar");
+    this->expectStatistics(1, 5);
+
+    this->fire(1, {"x"});
+    EXPECT_EQ(operation->evaluate(), "xbar");
+    this->expectStatistics(2, 7);
+}
+
+TEST_F(MemoizedTest, ValuesAreNotCached) {
+    this->addInterface("itf1", {"foo"});
+    auto operation = this->parse("[itf1]");
+    auto value = operation->evaluateValue();
+    EXPECT_EQ(&value.asString(), &this->interfaces[0]->storedValue[0]);
+    this->expectStatistics(0, 0);
+}
+
+namespace {
+
+class Counter : public operation::Operation {
+public:
+    operation::TypedValue evaluateValue() override {
+        return operation::TypedValue::fromNumber(++this->count);
+    }
+
+private:
+    int count = 0;
+};
+
+}  // unnamed namespace
+
+TEST_F(MemoizedTest, UnknownDependenciesAreEvaluatedEveryTime) {
+    this->addInterface("itf1", {"10"});
+    std::vector<std::unique_ptr<operation::Operation>> operands;
+    operands.push_back(
+        std::make_unique<operation::Value>(this->interfaces[0].get(), 1));
+    operands.push_back(std::make_unique<Counter>());
+    auto operation = operation::memoize(
+        std::make_unique<operation::FoldingOperation<
+            std::plus<float>, translator::Float>>(std::move(operands)));
+    EXPECT_EQ(operation->evaluate(), "11");
+    EXPECT_EQ(operation->evaluate(), "12");
+    this->expectStatistics(0, 0);
+}
@@ -4,6 +4,8 @@
 #include "TestHelpers.hpp"
 #include "common/ArduinoJson.hpp"
 #include "common/MqttClient.hpp"
+#include "operation/Operations.hpp"
+#include "operation/Profiled.hpp"
 #include "tools/string.hpp"
 
 using namespace ArduinoJson;
@@ -139,7 +141,8 @@ public:
         });
 
         this->mqttClient.setConfig(
-            MqttConfig{this->deviceName, {ServerConfig{}}, {"ava", "status"}});
+            MqttConfig{
+                this->deviceName, {ServerConfig{}}, {"ava", "status", ""}});
     }
 
     void loopUntil(unsigned long time, unsigned long delay = 100) {
@@ -369,3 +372,24 @@ TEST_F(MqttClientTest, CycleTime) {
         },
         {{20, true}, {60020, true}});
 }
+
+TEST_F(MqttClientTest, Profile) {
+    std::vector<std::string> profiles;
+    this->server.subscribe(
+        this->connectionId, "profile", [&](size_t id, FakeMessage message) {
+        if (id != this->connectionId) {
+            profiles.push_back(message.payload);
+        }
+    });
+    this->mqttClient.setConfig(
+        MqttConfig{
+            this->deviceName, {ServerConfig{}}, {"ava", "status", "profile"}});
+    auto operation = operation::profile(
+        std::make_unique<operation::Constant>("1"), this->esp, "foo", false);
+    operation->evaluate();
+    this->sendAvailability(false);
+    this->loopUntil(20, 10);
+
+    ASSERT_EQ(profiles.size(), 1);
+    EXPECT_EQ(profiles[0], R"([{"name":"foo","count":1,"micros":0}])");
+}
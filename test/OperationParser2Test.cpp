@@ -1,7 +1,9 @@
 #include <gtest/gtest.h>
 
 #include <iostream>
+#include <string>
 
+#include "Benchmark.hpp"
 #include "EspTestBase.hpp"
 #include "common/InterfaceConfig.hpp"
 #include "operation/OperationParser2.hpp"
@@ -198,6 +200,13 @@ TEST_F(OperationParser2Test, PrecedenceMultiplyAndDivideAreTheSame) {
     EXPECT_EQ(operation->evaluate(), "18");
 }
 
+TEST_F(OperationParser2Test, IntermediateResultsKeepSixDecimals) {
+    operation::Parser2 parser{this->debug, this->interfaces, nullptr};
+    auto operation = parser.parse("1 / 3 * 3");
+    ASSERT_NE(operation, nullptr);
+    EXPECT_EQ(operation->evaluate(), "0.999998");  // 0.333333 * 3
+}
+
 TEST_F(OperationParser2Test, GroupingWithParenthesis) {
     operation::Parser2 parser{this->debug, this->interfaces, nullptr};
     auto operation = parser.parse("(3 + 5) * (9 - 12)");
@@ -749,6 +758,14 @@ TEST_F(OperationParser2Test, UsedInterfaces) {
     EXPECT_EQ(parser.getUsedInterfaces(), expectedUsedInterfaces);
 }
 
+TEST_F(OperationParser2Test, EscapedInterfaceName) {
+    this->addInterface("foo]bar\\", {"baz"});
+    operation::Parser2 parser{this->debug, this->interfaces, nullptr};
+    auto operation = parser.parse(R"([foo\]bar\\] s+ 'x')");
+    ASSERT_NE(operation, nullptr);
+    EXPECT_EQ(operation->evaluate(), "bazx");
+}
+
 TEST_F(OperationParser2Test, SyntaxErrorEmptyExpression) {
     operation::Parser2 parser{this->debug, this->interfaces, nullptr};
     auto ex = expectLog("Syntax error:");
@@ -823,6 +840,14 @@ TEST_F(OperationParser2Test, SyntaxErrorMissingValueNumber) {
     ASSERT_EQ(operation, nullptr);
 }
 
+TEST_F(OperationParser2Test, SyntaxErrorValueNumberOverflow) {
+    addInterface("itf1", {""});
+    operation::Parser2 parser{this->debug, this->interfaces, nullptr};
+    auto ex = expectLog("Syntax error:");
+    auto operation = parser.parse("[itf1].99999999999999999999999");
+    ASSERT_EQ(operation, nullptr);
+}
+
 TEST_F(OperationParser2Test, ErrorMissingInterface) {
     addInterface("itf1", {""});
     operation::Parser2 parser{this->debug, this->interfaces, nullptr};
@@ -830,3 +855,195 @@ TEST_F(OperationParser2Test, ErrorMissingInterface) {
     auto operation = parser.parse("[itf2]");
     ASSERT_EQ(operation, nullptr);
 }
+
+TEST_F(OperationParser2Test, ConstantExpressionIsFolded) {
+    operation::Parser2 parser{this->debug, this->interfaces, nullptr};
+    auto operation = parser.parse("(3 + 5) * (9 - 12) s+ 'x'");
+    ASSERT_NE(operation, nullptr);
+    EXPECT_NE(operation->getConstantValue(), nullptr);
+    EXPECT_EQ(operation->evaluate(), "-24x");
+}
+
+TEST_F(OperationParser2Test, NeutralOperandIsRemoved) {
+    this->addInterface("itf1", {"foo"});
+    operation::Parser2 parser{
+        this->debug, this->interfaces, this->interfaces[0].get()};
+    auto operation = parser.parse("'' s+ %1 s+ ''");
+    ASSERT_NE(operation, nullptr);
+    auto value = operation->evaluateValue();
+    EXPECT_EQ(&value.asString(), &this->interfaces[0]->storedValue[0]);
+}
+
+TEST_F(OperationParser2Test, NeutralNumberKeepsRounding) {
+    this->addInterface("itf1", {"0.1234567"});
+    operation::Parser2 parser{
+        this->debug, this->interfaces, this->interfaces[0].get()};
+    auto operation = parser.parse("%1 * 1 + 0");
+    ASSERT_NE(operation, nullptr);
+    EXPECT_EQ(operation->evaluate(), "0.123456");
+}
+
+TEST_F(OperationParser2Test, ConstantConditionSelectsBranch) {
+    this->addInterface("itf1", {"foo"});
+    operation::Parser2 parser{
+        this->debug, this->interfaces, this->interfaces[0].get()};
+    auto operation = parser.parse("1 < 2 ? %1 : 'bar'");
+    ASSERT_NE(operation, nullptr);
+    auto value = operation->evaluateValue();
+    EXPECT_EQ(&value.asString(), &this->interfaces[0]->storedValue[0]);
+}
+
+TEST_F(OperationParser2Test, AbsorbingOperandDecidesResult) {
+    this->addInterface("itf1", {"1"});
+    operation::Parser2 parser{
+        this->debug, this->interfaces, this->interfaces[0].get()};
+    auto operation1 = parser.parse("0 && %1");
+    ASSERT_NE(operation1, nullptr);
+    EXPECT_NE(operation1->getConstantValue(), nullptr);
+    EXPECT_EQ(operation1->evaluate(), "0");
+    auto operation2 = parser.parse("%1 || 1");
+    ASSERT_NE(operation2, nullptr);
+    EXPECT_NE(operation2->getConstantValue(), nullptr);
+    EXPECT_EQ(operation2->evaluate(), "1");
+}
+
+TEST_F(OperationParser2Test, DISABLED_BenchmarkParseThroughput) {
+    constexpr int interfaceCount = 50;
+    for (int i = 0; i < interfaceCount; ++i) {
+        this->addInterface("sensor_" + std::to_string(i), {"0", "0"});
+    }
+    std::string expression;
+    for (int i = 0; i < interfaceCount; ++i) {
+        std::string name = "[sensor_" + std::to_string(i) + "]";
+        expression += name + ".2 * 1.5 + " + name + " > 10 && " + name +
+                      " s!= 'off' || ";
+    }
+    expression += "false ? 'on' : 'off'";
+
+    operation::Parser2 parser{
+        this->debug, this->interfaces, this->interfaces[0].get()};
+    // Far larger than an expression that fits on a device.
+    parser.setLimits({16, 1000, 100000});
+    ASSERT_NE(parser.parse(expression), nullptr);
+    constexpr int iterations = 1000;
+    double time = measure(iterations, [&](int /*i*/) {
+        parser.parse(expression);
+    }) / 1000;
+    std::cout << expression.size() << " characters, " << interfaceCount * 3
+              << " interface references: " << time << " us per parse, "
+              << expression.size() / time << " MB/s" << std::endl;
+}
+
+TEST_F(OperationParser2Test, NestedTooDeeply) {
+    operation::Parser2 parser{this->debug, this->interfaces, nullptr};
+    auto ex = expectLog("Error: Expression is nested too deeply", 2);
+    EXPECT_EQ(
+        parser.parse(std::string(20, '(') + "1" + std::string(20, ')')),
+        nullptr);
+    EXPECT_EQ(parser.parse(std::string(20, '!') + "1"), nullptr);
+}
+
+TEST_F(OperationParser2Test, NestingWithinLimit) {
+    operation::Parser2 parser{this->debug, this->interfaces, nullptr};
+    auto operation =
+        parser.parse(std::string(10, '(') + "1" + std::string(10, ')'));
+    ASSERT_NE(operation, nullptr);
+    EXPECT_EQ(operation->evaluate(), "1");
+}
+
+TEST_F(OperationParser2Test, TooDeep) {
+    this->addInterface("a", {"1"});
+    operation::Parser2 parser{this->debug, this->interfaces, nullptr};
+    std::string expression = "[a]";
+    // Each level is only one level of parentheses.
+    for (int i = 0; i < 10; ++i) {
+        expression = "[a] + [a] * (" + expression + ")";
+    }
+    auto ex = expectLog("Error: Expression is too deep, at most 16 levels");
+    EXPECT_EQ(parser.parse(expression), nullptr);
+}
+
+TEST_F(OperationParser2Test, LongNumberChain) {
+    this->addInterface("a", {"1"});
+    operation::Parser2 parser{this->debug, this->interfaces, nullptr};
+    std::string expression = "[a]";
+    for (int i = 0; i < 40; ++i) {
+        expression += " + [a]";
+    }
+    auto operation = parser.parse(expression);
+    ASSERT_NE(operation, nullptr);
+    EXPECT_EQ(operation->evaluate(), "41");
+}
+
+TEST_F(OperationParser2Test, LogicalChainsAreFlattened) {
+    this->addInterface("a", {"1", "0"});
+    operation::Parser2 parser{this->debug, this->interfaces, nullptr};
+    std::string conjunction = "[a]";
+    std::string disjunction = "[a].2";
+    std::string concatenation = "'x'";
+    for (int i = 0; i < 100; ++i) {
+        conjunction += " && [a]";
+        disjunction += " || [a].2";
+        concatenation += " s+ [a]";
+    }
+    auto operation = parser.parse(conjunction);
+    ASSERT_NE(operation, nullptr);
+    EXPECT_EQ(operation->evaluate(), "1");
+    operation = parser.parse(disjunction);
+    ASSERT_NE(operation, nullptr);
+    EXPECT_EQ(operation->evaluate(), "0");
+    operation = parser.parse(concatenation);
+    ASSERT_NE(operation, nullptr);
+    EXPECT_EQ(operation->evaluate(), "x" + std::string(100, '1'));
+}
+
+TEST_F(OperationParser2Test, MixedOperatorsAreNotFlattened) {
+    this->addInterface("a", {"1", "0"});
+    operation::Parser2 parser{this->debug, this->interfaces, nullptr};
+    const std::pair<const char*, const char*> samples[] = {
+        {"[a] && [a].2 || [a]", "1"},    {"[a].2 || [a] && [a].2", "0"},
+        {"[a] || [a].2 && [a].2", "1"},  {"'a' s+ 'b' s== 'ab' && [a]", "1"},
+        {"[a] - [a] - [a] + 3 - 1", "1"}, {"12 / 2 / 3 * 2", "4"},
+    };
+    for (const auto& [expression, expected] : samples) {
+        auto operation = parser.parse(expression);
+        ASSERT_NE(operation, nullptr) << expression;
+        EXPECT_EQ(operation->evaluate(), expected) << expression;
+    }
+}
+
+TEST_F(OperationParser2Test, TooManyNodes) {
+    this->addInterface("a", {"1"});
+    operation::Parser2 parser{this->debug, this->interfaces, nullptr};
+    parser.setLimits({16, 5, 4096});
+    EXPECT_NE(parser.parse("[a] + [a] > 1"), nullptr);
+    auto ex = expectLog("Error: Expression has 7 nodes, at most 5");
+    EXPECT_EQ(parser.parse("[a] + [a] > [a] + 1"), nullptr);
+}
+
+TEST_F(OperationParser2Test, TooManyBytes) {
+    this->addInterface("a", {"1"});
+    operation::Parser2 parser{this->debug, this->interfaces, nullptr};
+    parser.setLimits({16, 128, 100});
+    EXPECT_NE(parser.parse("[a]"), nullptr);
+    auto ex = expectLog("Error: Expression takes");
+    EXPECT_EQ(parser.parse("[a] + [a] > [a] + 1 ? 'yes' : 'no'"), nullptr);
+}
+
+TEST_F(OperationParser2Test, Statistics) {
+    this->addInterface("a", {"1"});
+    operation::Parser2 parser{this->debug, this->interfaces, nullptr};
+    auto before = operation::Parser2::getStatistics();
+    auto operation = parser.parse("[a] + 1 > 1 ? 'yes' : 'no'");
+    ASSERT_NE(operation, nullptr);
+    auto after = operation::Parser2::getStatistics();
+    EXPECT_EQ(after.expressions, before.expressions + 1);
+    EXPECT_EQ(after.nodes, before.nodes + 8);
+    EXPECT_GT(after.bytes, before.bytes);
+    EXPECT_GE(after.depth, 2);
+
+    auto ex = expectLog("Syntax error:");
+    EXPECT_EQ(parser.parse("[a] +"), nullptr);
+    EXPECT_EQ(
+        operation::Parser2::getStatistics().expressions, after.expressions);
+}
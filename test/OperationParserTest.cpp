@@ -620,3 +620,15 @@ TEST_F(OperationParserTest, ValueConditionDoesNotHold) {
     auto operation = parse(json);
     EXPECT_EQ(operation->evaluate(), "");
 }
+
+TEST_F(OperationParserTest, ConstantExpressionIsFolded) {
+    std::string json = R"({
+        "result": {
+            "type": "s+",
+            "ops": [{"type": "+", "ops": ["3", "5"]}, "x"]
+        }
+    })";
+    auto operation = parse(json);
+    EXPECT_NE(operation->getConstantValue(), nullptr);
+    EXPECT_EQ(operation->evaluate(), "8x");
+}
@@ -0,0 +1,272 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Benchmark.hpp"
+#include "operation/Operations.hpp"
+#include "operation/Program.hpp"
+#include "operation/Translator.hpp"
+
+using namespace operation;
+
+namespace {
+
+class CountingOperation : public Operation {
+public:
+    CountingOperation(std::string value, int& count)
+        : value(std::move(value)), count(count) {}
+
+    TypedValue evaluateValue() override {
+        ++this->count;
+        return TypedValue::fromReference(this->value);
+    }
+
+private:
+    std::string value;
+    int& count;
+};
+
+// Evaluates to its value without being a constant.
+class Variable : public Operation {
+public:
+    explicit Variable(TypedValue value) : value(std::move(value)) {}
+
+    TypedValue evaluateValue() override { return this->value; }
+
+    TypedValue value;
+};
+
+struct Bounds {
+    float min;
+    float max;
+};
+
+std::unique_ptr<Operation> createMapping(
+    const std::vector<Bounds>& bounds, bool constant, Variable*& input) {
+    std::vector<MappingElement> elements;
+    for (std::size_t i = 0; i < bounds.size(); ++i) {
+        auto bound = [&](float value) -> std::unique_ptr<Operation> {
+            if (constant) {
+                return std::make_unique<Constant>(
+                    TypedValue::fromNumber(value));
+            }
+            return std::make_unique<Variable>(TypedValue::fromNumber(value));
+        };
+        elements.push_back(
+            MappingElement{
+                bound(bounds[i].min), bound(bounds[i].max),
+                std::make_unique<Constant>(std::to_string(i))});
+    }
+    auto inputOperation = std::make_unique<Variable>(TypedValue{});
+    input = inputOperation.get();
+    return optimize(
+        std::make_unique<Mapping<translator::Float>>(
+            std::move(elements), std::move(inputOperation)));
+}
+
+// Buckets of equal width from 0 to 100, in shuffled order.
+std::vector<Bounds> createBuckets(int count, std::mt19937& random) {
+    std::vector<Bounds> result;
+    float width = 100.0f / count;
+    for (int i = 0; i < count; ++i) {
+        result.push_back(Bounds{i * width, (i + 1) * width});
+    }
+    std::shuffle(result.begin(), result.end(), random);
+    return result;
+}
+
+}  // unnamed namespace
+
+struct OperationsTest : testing::Test {
+    std::vector<int> counts;
+    std::vector<std::unique_ptr<Operation>> operands;
+
+    void addOperands(std::vector<std::string> values) {
+        this->counts.assign(values.size(), 0);
+        for (std::size_t i = 0; i < values.size(); ++i) {
+            this->operands.push_back(std::make_unique<CountingOperation>(
+                std::move(values[i]), this->counts[i]));
+        }
+    }
+};
+
+TEST_F(OperationsTest, AndStopsAtFirstFalse) {
+    this->addOperands({"1", "0", "1"});
+    FoldingOperation<std::logical_and<bool>, translator::Bool> operation{
+        std::move(this->operands)};
+    EXPECT_EQ(operation.evaluate(), "0");
+    EXPECT_EQ(this->counts, (std::vector<int>{1, 1, 0}));
+
+    auto program = Program::compile(operation);
+    EXPECT_EQ(program.evaluateString(), "0");
+    EXPECT_EQ(this->counts, (std::vector<int>{2, 2, 0}));
+}
+
+TEST_F(OperationsTest, AndEvaluatesAllIfTrue) {
+    this->addOperands({"on", "1", "true"});
+    FoldingOperation<std::logical_and<bool>, translator::Bool> operation{
+        std::move(this->operands)};
+    EXPECT_EQ(operation.evaluate(), "1");
+    EXPECT_EQ(this->counts, (std::vector<int>{1, 1, 1}));
+
+    auto program = Program::compile(operation);
+    EXPECT_EQ(program.evaluateString(), "1");
+    EXPECT_EQ(this->counts, (std::vector<int>{2, 2, 2}));
+}
+
+TEST_F(OperationsTest, OrStopsAtFirstTrue) {
+    this->addOperands({"off", "on", "0"});
+    FoldingOperation<std::logical_or<bool>, translator::Bool> operation{
+        std::move(this->operands)};
+    EXPECT_EQ(operation.evaluate(), "1");
+    EXPECT_EQ(this->counts, (std::vector<int>{1, 1, 0}));
+
+    auto program = Program::compile(operation);
+    EXPECT_EQ(program.evaluateString(), "1");
+    EXPECT_EQ(this->counts, (std::vector<int>{2, 2, 0}));
+}
+
+TEST_F(OperationsTest, OrEvaluatesAllIfFalse) {
+    this->addOperands({"0", "foo", "off"});
+    FoldingOperation<std::logical_or<bool>, translator::Bool> operation{
+        std::move(this->operands)};
+    EXPECT_EQ(operation.evaluate(), "0");
+    EXPECT_EQ(this->counts, (std::vector<int>{1, 1, 1}));
+
+    auto program = Program::compile(operation);
+    EXPECT_EQ(program.evaluateString(), "0");
+    EXPECT_EQ(this->counts, (std::vector<int>{2, 2, 2}));
+}
+
+TEST_F(OperationsTest, ComparisonEvaluatesOperandsOnce) {
+    this->addOperands({"1", "2", "3", "4"});
+    Comparison<std::less<float>, translator::Float> operation{
+        std::move(this->operands)};
+    EXPECT_EQ(operation.evaluate(), "1");
+    EXPECT_EQ(this->counts, (std::vector<int>{1, 1, 1, 1}));
+}
+
+TEST_F(OperationsTest, ComparisonStopsAtFirstFailure) {
+    this->addOperands({"1", "3", "2", "4"});
+    Comparison<std::less<float>, translator::Float> operation{
+        std::move(this->operands)};
+    EXPECT_EQ(operation.evaluate(), "0");
+    EXPECT_EQ(this->counts, (std::vector<int>{1, 1, 1, 0}));
+}
+
+TEST_F(OperationsTest, StringComparisonKeepsPreviousValue) {
+    this->addOperands({"a", "b", "b", "c"});
+    Comparison<std::less_equal<std::string>, translator::Str> operation{
+        std::move(this->operands)};
+    EXPECT_EQ(operation.evaluate(), "1");
+    EXPECT_EQ(this->counts, (std::vector<int>{1, 1, 1, 1}));
+}
+
+TEST(MappingTest, ConstantBoundsGiveSameResult) {
+    std::mt19937 random{42};
+    std::uniform_real_distribution<float> value{-10.0f, 110.0f};
+    std::uniform_real_distribution<float> bound{0.0f, 100.0f};
+    for (int count : {1, 2, 5, 20, 50}) {
+        auto buckets = createBuckets(count, random);
+        // Some empty and inverted ranges, which never match.
+        buckets.push_back(Bounds{50.0f, 50.0f});
+        buckets.push_back(Bounds{120.0f, -10.0f});
+        std::shuffle(buckets.begin(), buckets.end(), random);
+        Variable* constantInput = nullptr;
+        Variable* variableInput = nullptr;
+        auto constant = createMapping(buckets, true, constantInput);
+        auto variable = createMapping(buckets, false, variableInput);
+        for (int i = 0; i < 1000; ++i) {
+            float x = i % 10 == 0 ? bound(random) : value(random);
+            if (i % 10 == 1) {
+                x = buckets[i % buckets.size()].max;
+            }
+            constantInput->value = TypedValue::fromNumber(x);
+            variableInput->value = TypedValue::fromNumber(x);
+            EXPECT_EQ(constant->evaluate(), variable->evaluate())
+                << count << " " << x;
+        }
+        constantInput->value = TypedValue::fromNumber(NAN);
+        EXPECT_EQ(constant->evaluate(), "");
+    }
+}
+
+TEST(MappingTest, OverlappingRangesMatchFirst) {
+    Variable* input = nullptr;
+    auto mapping = createMapping(
+        {{20.0f, 60.0f}, {0.0f, 30.0f}, {50.0f, 100.0f}}, true, input);
+    input->value = TypedValue::fromNumber(25.0f);
+    EXPECT_EQ(mapping->evaluate(), "0");
+    input->value = TypedValue::fromNumber(10.0f);
+    EXPECT_EQ(mapping->evaluate(), "1");
+    input->value = TypedValue::fromNumber(55.0f);
+    EXPECT_EQ(mapping->evaluate(), "0");
+    input->value = TypedValue::fromNumber(60.0f);
+    EXPECT_EQ(mapping->evaluate(), "2");
+}
+
+TEST(MappingTest, StringBounds) {
+    std::vector<MappingElement> elements;
+    elements.push_back(
+        MappingElement{
+            std::make_unique<Constant>("foo"),
+            std::make_unique<Constant>("widget"),
+            std::make_unique<Constant>("second")});
+    elements.push_back(
+        MappingElement{
+            std::make_unique<Constant>("bar"),
+            std::make_unique<Constant>("foo"),
+            std::make_unique<Constant>("first")});
+    auto input = std::make_unique<Variable>(TypedValue{});
+    Variable& value = *input;
+    auto mapping = optimize(
+        std::make_unique<Mapping<translator::Str>>(
+            std::move(elements), std::move(input)));
+    for (auto [input, expected] :
+         std::vector<std::pair<const char*, const char*>>{
+             {"asd", ""},
+             {"bar", "first"},
+             {"ert", "first"},
+             {"foo", "second"},
+             {"vbvbvb", "second"},
+             {"widget", ""}}) {
+        value.value = TypedValue::fromString(input);
+        EXPECT_EQ(mapping->evaluate(), expected) << input;
+    }
+}
+
+TEST(MappingTest, DISABLED_Benchmark) {
+    constexpr int iterations = 100000;
+    std::mt19937 random{42};
+    std::uniform_real_distribution<float> distribution{0.0f, 100.0f};
+    std::vector<TypedValue> values;
+    for (int i = 0; i < 1024; ++i) {
+        values.push_back(TypedValue::fromNumber(distribution(random)));
+    }
+
+    for (int count : {5, 20, 50}) {
+        auto buckets = createBuckets(count, random);
+        Variable* constantInput = nullptr;
+        Variable* variableInput = nullptr;
+        auto constant = createMapping(buckets, true, constantInput);
+        auto variable = createMapping(buckets, false, variableInput);
+        std::size_t length = 0;
+        double linear = measure(iterations, [&](int i) {
+            variableInput->value = values[i % values.size()];
+            length += variable->evaluateValue().asString().size();
+        });
+        double binary = measure(iterations, [&](int i) {
+            constantInput->value = values[i % values.size()];
+            length += constant->evaluateValue().asString().size();
+        });
+        std::cout << count << " ranges, linear: " << linear
+                  << " ns, binary search: " << binary << " ns" << std::endl;
+        EXPECT_GT(length, 0);
+    }
+}
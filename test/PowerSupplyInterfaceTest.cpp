@@ -0,0 +1,102 @@
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+
+#include "EspTestBase.hpp"
+#include "LogExpectation.hpp"
+#include "common/PowerSupplyInterface.hpp"
+#include "common/TimerWheel.hpp"
+
+namespace {
+
+constexpr uint8_t powerSwitchPin = 1;
+constexpr uint8_t resetSwitchPin = 2;
+constexpr uint8_t powerCheckPin = 3;
+constexpr unsigned pushTime = 100;
+constexpr unsigned forceOffTime = 5000;
+constexpr unsigned checkTime = 1000;
+
+}  // unnamed namespace
+
+struct PowerSupplyInterfaceTest : EspTestBase {
+    TimerWheel timers{this->esp};
+    std::unique_ptr<PowerSupplyInterface> interface;
+
+    void create(const std::string& initialState) {
+        this->interface = std::make_unique<PowerSupplyInterface>(
+            this->debug, this->esp, this->timers, powerSwitchPin,
+            resetSwitchPin, powerCheckPin, pushTime, forceOffTime, checkTime,
+            initialState);
+        this->interface->start();
+    }
+
+    void setPower(bool value) { this->esp.digitalWrite(powerCheckPin, value); }
+
+    void runUntil(unsigned long time) {
+        this->timers.update();
+        this->delayUntil(time, 10, [this]() { this->timers.update(); });
+    }
+};
+
+TEST_F(PowerSupplyInterfaceTest, TurnsOn) {
+    this->create("on");
+    {
+        auto press = this->expectLog("power button press");
+        auto release = this->expectLog("power button release");
+        this->runUntil(pushTime + 10);
+    }
+    this->setPower(true);
+    auto press = this->expectLog("power button press", 0);
+    this->runUntil(checkTime * 5);
+}
+
+TEST_F(PowerSupplyInterfaceTest, KeepsOff) {
+    this->create("off");
+    this->setPower(true);
+    {
+        auto press = this->expectLog("power button press");
+        this->runUntil(10);
+    }
+    this->runUntil(pushTime + 10);
+    this->setPower(false);
+    auto press = this->expectLog("power button press", 0);
+    this->runUntil(checkTime * 5);
+}
+
+TEST_F(PowerSupplyInterfaceTest, Dontcare) {
+    this->create("dontcare");
+    auto check = this->expectLog("check", 0);
+    this->runUntil(checkTime * 5);
+    this->setPower(true);
+    this->interface->execute("off");
+    this->interface->execute("dontcare");
+    this->runUntil(checkTime * 10);
+}
+
+TEST_F(PowerSupplyInterfaceTest, ForceOffAfterDontcare) {
+    this->create("dontcare");
+    this->setPower(true);
+    this->runUntil(100);
+    {
+        auto press = this->expectLog("power button press", 0);
+        auto release = this->expectLog("power button release");
+        this->interface->execute("forceOff");
+        this->setPower(false);
+        this->runUntil(100 + forceOffTime + checkTime * 2);
+    }
+
+    // Turned on by hand, so it is turned off again.
+    this->setPower(true);
+    auto press = this->expectLog("power button press");
+    this->runUntil(100 + forceOffTime + checkTime * 3 + 10);
+}
+
+TEST_F(PowerSupplyInterfaceTest, Reset) {
+    this->create("on");
+    this->setPower(true);
+    this->runUntil(100);
+    auto release = this->expectLog("reset button release");
+    this->interface->execute("reset");
+    this->runUntil(100 + pushTime + 10);
+}
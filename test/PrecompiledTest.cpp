@@ -0,0 +1,214 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "EspTestBase.hpp"
+#include "common/InterfaceConfig.hpp"
+#include "operation/Generator.hpp"
+#include "operation/Memoized.hpp"
+#include "operation/OperationParser2.hpp"
+#include "operation/Operations.hpp"
+#include "operation/Precompiled.hpp"
+
+namespace {
+
+constexpr const char* expression =
+    "[a] + %1 > 2 || [a] s== 'x' ? 'big' : 'small'";
+
+// The function body operation_compiler generates for the expression.
+constexpr const char* generatedCode = R"(    do {
+        stack[0].assignReference(Value::get(interfaces[0], 1));
+        stack[1].assignReference(Value::get(interfaces[1], 1));
+        FoldingOperation<std::plus<float>, translator::Float>::apply(
+            stack + 0, 2);
+        stack[1].assignReference(strings[0]);
+        Comparison<std::greater<float>, translator::Float>::apply(stack + 0, 2);
+        if (stack[0].asBool()) {
+            stack[0].assignBool(true);
+            break;
+        }
+        stack[0].assignReference(Value::get(interfaces[0], 1));
+        stack[1].assignReference(strings[1]);
+        Comparison<std::equal_to<std::string>, translator::Str>::apply(
+            stack + 0, 2);
+        FoldingOperation<std::logical_or<bool>, translator::Bool>::apply(
+            stack + 0, 1);
+    } while (false);
+    if (stack[0].asBool()) {
+        stack[0].assignReference(strings[2]);
+    } else {
+        stack[0].assignReference(strings[3]);
+    }
+)";
+
+}  // unnamed namespace
+
+// The same code built into the test, as it would be into the firmware.
+namespace operation {
+namespace {
+
+const std::string strings[] = {
+    "2",
+    "x",
+    "big",
+    "small",
+};
+
+void rule0(const InterfaceConfig* const* interfaces, TypedValue* stack) {
+    do {
+        stack[0].assignReference(Value::get(interfaces[0], 1));
+        stack[1].assignReference(Value::get(interfaces[1], 1));
+        FoldingOperation<std::plus<float>, translator::Float>::apply(
+            stack + 0, 2);
+        stack[1].assignReference(strings[0]);
+        Comparison<std::greater<float>, translator::Float>::apply(stack + 0, 2);
+        if (stack[0].asBool()) {
+            stack[0].assignBool(true);
+            break;
+        }
+        stack[0].assignReference(Value::get(interfaces[0], 1));
+        stack[1].assignReference(strings[1]);
+        Comparison<std::equal_to<std::string>, translator::Str>::apply(
+            stack + 0, 2);
+        FoldingOperation<std::logical_or<bool>, translator::Bool>::apply(
+            stack + 0, 1);
+    } while (false);
+    if (stack[0].asBool()) {
+        stack[0].assignReference(strings[2]);
+    } else {
+        stack[0].assignReference(strings[3]);
+    }
+}
+
+const char* const interfaces0[] = {"a", "b"};
+
+const Precompiled::Rule rules[] = {
+    {"[a] + %1 > 2 || [a] s== 'x' ? 'big' : 'small'",
+     "b", interfaces0, 2, 2, &rule0},
+};
+
+Precompiled::Registration registration{rules, 1};
+
+}  // unnamed namespace
+}  // namespace operation
+
+struct PrecompiledTest : EspTestBase {
+    std::vector<std::unique_ptr<InterfaceConfig>> interfaces;
+
+    PrecompiledTest() {
+        this->addInterface("a");
+        this->addInterface("b");
+    }
+
+    void addInterface(std::string name) {
+        this->interfaces.emplace_back(std::make_unique<InterfaceConfig>());
+        this->interfaces.back()->name = std::move(name);
+        this->interfaces.back()->storedValue = {""};
+    }
+
+    std::unique_ptr<operation::Operation> parse(
+        const std::string& data, InterfaceConfig* defaultInterface) {
+        operation::Parser2 parser{
+            this->debug, this->interfaces, defaultInterface, &this->esp};
+        return parser.parse(data);
+    }
+
+    std::unique_ptr<operation::Precompiled> find(
+        InterfaceConfig* defaultInterface) {
+        return operation::Precompiled::find(
+            InterfaceRegistry{this->interfaces}, defaultInterface,
+            expression);
+    }
+
+    void set(std::size_t index, std::string value) {
+        this->interfaces[index]->storedValue[0] = std::move(value);
+        ++this->interfaces[index]->generation;
+    }
+};
+
+TEST_F(PrecompiledTest, GeneratedCodeIsUpToDate) {
+    auto operation = this->parse(expression, this->interfaces[1].get());
+    ASSERT_NE(operation, nullptr);
+    std::ostringstream code;
+    std::vector<const InterfaceConfig*> usedInterfaces{
+        this->interfaces[0].get(), this->interfaces[1].get()};
+    std::vector<std::string> usedStrings;
+    operation::Generator generator{code, usedInterfaces, usedStrings};
+    ASSERT_TRUE(operation->generate(generator));
+    EXPECT_EQ(code.str(), generatedCode);
+    EXPECT_EQ(generator.getStackSize(), 2);
+    EXPECT_EQ(
+        usedStrings, (std::vector<std::string>{"2", "x", "big", "small"}));
+    EXPECT_EQ(usedInterfaces.size(), 2);
+}
+
+TEST_F(PrecompiledTest, SameAsParsed) {
+    auto precompiled = this->find(this->interfaces[1].get());
+    ASSERT_NE(precompiled, nullptr);
+    auto parsed = this->parse(expression, this->interfaces[1].get());
+    ASSERT_NE(parsed, nullptr);
+
+    const char* values[] = {"", "0", "1", "1.5", "2", "x", "-3"};
+    for (const char* a : values) {
+        for (const char* b : values) {
+            this->set(0, a);
+            this->set(1, b);
+            EXPECT_EQ(precompiled->evaluate(), parsed->evaluate())
+                << a << " " << b;
+        }
+    }
+}
+
+TEST_F(PrecompiledTest, UsesInterfaces) {
+    auto precompiled = this->find(this->interfaces[1].get());
+    ASSERT_NE(precompiled, nullptr);
+    std::vector<InterfaceConfig*> expected{
+        this->interfaces[0].get(), this->interfaces[1].get()};
+    EXPECT_EQ(precompiled->getInterfaces(), expected);
+
+    auto operation = operation::memoize(std::move(precompiled));
+    this->set(0, "x");
+    EXPECT_EQ(operation->evaluate(), "big");
+    this->set(0, "y");
+    EXPECT_EQ(operation->evaluate(), "small");
+}
+
+TEST_F(PrecompiledTest, OtherDefaultInterface) {
+    EXPECT_EQ(this->find(this->interfaces[0].get()), nullptr);
+    EXPECT_EQ(this->find(nullptr), nullptr);
+}
+
+TEST_F(PrecompiledTest, MissingInterface) {
+    this->interfaces[0]->name = "c";
+    EXPECT_EQ(this->find(this->interfaces[1].get()), nullptr);
+}
+
+TEST_F(PrecompiledTest, OtherExpression) {
+    EXPECT_EQ(
+        operation::Precompiled::find(
+            InterfaceRegistry{this->interfaces}, this->interfaces[1].get(),
+            "[a] + %1 > 2"),
+        nullptr);
+}
+
+TEST_F(PrecompiledTest, StatefulOperationsAreNotGenerated) {
+    for (const char* data : {"avg([a], 2) + 1", "now() > 5", "since() > 1s"}) {
+        auto operation = this->parse(data, this->interfaces[1].get());
+        ASSERT_NE(operation, nullptr) << data;
+        std::ostringstream code;
+        std::vector<const InterfaceConfig*> usedInterfaces;
+        std::vector<std::string> usedStrings;
+        operation::Generator generator{code, usedInterfaces, usedStrings};
+        EXPECT_FALSE(operation->generate(generator)) << data;
+    }
+}
+
+TEST_F(PrecompiledTest, StringLiteral) {
+    std::ostringstream out;
+    operation::writeStringLiteral(out, "a\"b\\c\n1\x7f" "2");
+    EXPECT_EQ(out.str(), R"("a\"b\\c\0121\1772")");
+}
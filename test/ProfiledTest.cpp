@@ -0,0 +1,110 @@
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "EspTestBase.hpp"
+#include "common/InterfaceConfig.hpp"
+#include "operation/OperationParser2.hpp"
+#include "operation/Profiled.hpp"
+
+namespace {
+
+// Takes the given time to evaluate.
+class Slow : public operation::Operation {
+public:
+    Slow(EspApi& esp, unsigned long millis) : esp(esp), millis(millis) {}
+
+    operation::TypedValue evaluateValue() override {
+        this->esp.delay(this->millis);
+        return operation::TypedValue::fromNumber(this->millis);
+    }
+
+private:
+    EspApi& esp;
+    unsigned long millis;
+};
+
+std::vector<std::string> getNames(
+    const std::vector<const operation::Profiled*>& profile) {
+    std::vector<std::string> result;
+    for (const operation::Profiled* profiled : profile) {
+        result.push_back(profiled->getName());
+    }
+    return result;
+}
+
+}  // unnamed namespace
+
+struct ProfiledTest : EspTestBase {
+    std::vector<std::unique_ptr<InterfaceConfig>> interfaces;
+
+    ProfiledTest() {
+        this->interfaces.emplace_back(std::make_unique<InterfaceConfig>());
+        this->interfaces.back()->name = "x";
+        this->interfaces.back()->storedValue = {"2", "3"};
+    }
+};
+
+TEST_F(ProfiledTest, CountsEvaluationsAndTime) {
+    auto operation = operation::profile(
+        std::make_unique<Slow>(this->esp, 3), this->esp, "slow", false);
+    EXPECT_EQ(operation->evaluate(), "3");
+    EXPECT_EQ(operation->evaluate(), "3");
+
+    auto profile = operation::Profiled::getAll();
+    ASSERT_EQ(profile.size(), 1);
+    EXPECT_EQ(profile[0]->getName(), "slow");
+    EXPECT_FALSE(profile[0]->isNode());
+    EXPECT_EQ(profile[0]->getCount(), 2);
+    EXPECT_EQ(profile[0]->getMicros(), 6000);
+}
+
+TEST_F(ProfiledTest, Nodes) {
+    operation::Parser2 parser{this->debug, this->interfaces, nullptr};
+    auto operation = operation::profile(
+        parser.parse("[x] + [x].2 * 2"), this->esp, "action", true);
+    EXPECT_EQ(operation->evaluate(), "8");
+    auto profile = operation::Profiled::getAll();
+    EXPECT_EQ(
+        getNames(profile),
+        (std::vector<std::string>{
+            "action/0", "action/1/0", "action/1/1", "action/1", "action"}));
+    for (const operation::Profiled* profiled : profile) {
+        EXPECT_EQ(profiled->getCount(), 1) << profiled->getName();
+        EXPECT_EQ(profiled->isNode(), profiled->getName() != "action");
+    }
+}
+
+TEST_F(ProfiledTest, TopActions) {
+    std::vector<std::unique_ptr<operation::Operation>> operations;
+    for (unsigned long millis : {2, 5, 1, 4}) {
+        operations.push_back(operation::profile(
+            std::make_unique<Slow>(this->esp, millis), this->esp,
+            std::to_string(millis), true));
+    }
+    operations.push_back(operation::profile(
+        std::make_unique<Slow>(this->esp, 3), this->esp, "nodes", true));
+    for (const auto& operation : operations) {
+        operation->evaluate();
+    }
+    EXPECT_EQ(
+        getNames(operation::Profiled::getTop(3)),
+        (std::vector<std::string>{"5", "4", "nodes"}));
+    EXPECT_EQ(getNames(operation::Profiled::getTop(10)).size(), 5);
+
+    operations.erase(operations.begin() + 1);
+    EXPECT_EQ(
+        getNames(operation::Profiled::getTop(2)),
+        (std::vector<std::string>{"4", "nodes"}));
+}
+
+TEST_F(ProfiledTest, RemovedWhenDestroyed) {
+    {
+        auto operation = operation::profile(
+            std::make_unique<Slow>(this->esp, 1), this->esp, "slow", false);
+        EXPECT_EQ(operation::Profiled::getAll().size(), 1);
+    }
+    EXPECT_TRUE(operation::Profiled::getAll().empty());
+}
@@ -0,0 +1,207 @@
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include "Benchmark.hpp"
+#include "EspTestBase.hpp"
+#include "common/ArduinoJson.hpp"
+#include "common/InterfaceConfig.hpp"
+#include "operation/OperationParser.hpp"
+#include "operation/OperationParser2.hpp"
+#include "operation/Program.hpp"
+
+using namespace ArduinoJson;
+
+namespace {
+
+struct ProgramTestValues {
+    std::vector<std::string> itf1;
+    std::vector<std::string> itf2;
+};
+
+const ProgramTestValues programTestValues[] = {
+    {{"0", "0", "0"}, {"0"}},
+    {{"1", "2", "3"}, {"on"}},
+    {{"-2.5", "foo", "0.1234567"}, {"bar"}},
+    {{"5", "", "1e3"}, {"5"}},
+};
+
+}  // unnamed namespace
+
+struct ProgramTest : EspTestBase {
+    std::vector<std::unique_ptr<InterfaceConfig>> interfaces;
+
+    void addInterface(std::string name, std::vector<std::string> values) {
+        this->interfaces.emplace_back(std::make_unique<InterfaceConfig>());
+        this->interfaces.back()->name = std::move(name);
+        this->interfaces.back()->storedValue = std::move(values);
+    }
+};
+
+struct ProgramEquivalenceTest
+    : ProgramTest
+    , testing::WithParamInterface<std::string> {};
+
+INSTANTIATE_TEST_SUITE_P(
+    Expressions, ProgramEquivalenceTest,
+    testing::Values(
+        "'foo'", "12.5", "true", "%1", "%3", "[itf2]", "[itf1].2", "-%1",
+        "%1 + %2 - 1.5", "%1 * %2 / 3", "1 / %1 * 3", "%1 s+ ' ' s+ [itf2]",
+        "%1 == %2", "%1 != 0", "%1 < %2", "%1 <= %2", "%1 > 0", "%1 >= %3",
+        "%2 s== 'foo'", "%2 s!= [itf2]", "%1 s< %2", "%1 s<= %2",
+        "%1 s> %2", "%1 s>= %2", "%1 && [itf2]", "%1 || [itf2]", "!%1",
+        "!(%1 > 0 && %2 < 3) || [itf2] s== 'on'",
+        "%1 > 0 ? 'pos' : %1 < 0 ? 'neg' : 'zero'",
+        "10 + (%1 ? 3 : -2) * 2",
+        "[itf2] ? ([itf1] ? 'a' : 'b') : (%2 s== 'foo' ? 'c' : 'd')",
+        "%1 > 0 ? 'blink ' s+ %2 s+ ' ' s+ %3 : 'toggle'"));
+
+TEST_P(ProgramEquivalenceTest, SameResultAsTree) {
+    this->addInterface("itf1", {});
+    this->addInterface("itf2", {});
+    operation::Parser2 parser{
+        this->debug, this->interfaces, this->interfaces[0].get()};
+    auto operation = parser.parse(GetParam());
+    ASSERT_NE(operation, nullptr);
+    auto program = operation::Program::compile(*operation);
+
+    for (const auto& values : programTestValues) {
+        this->interfaces[0]->storedValue = values.itf1;
+        this->interfaces[1]->storedValue = values.itf2;
+        EXPECT_EQ(program.evaluateString(), operation->evaluate())
+            << values.itf1[0] << " " << values.itf1[1] << " "
+            << values.itf1[2] << " " << values.itf2[0];
+    }
+}
+
+TEST_F(ProgramTest, ConditionalJumpsOverUnusedBranch) {
+    this->addInterface("itf1", {"1"});
+    operation::Parser2 parser{
+        this->debug, this->interfaces, this->interfaces[0].get()};
+    auto operation = parser.parse("%1 ? 'foo' : 'bar'");
+    ASSERT_NE(operation, nullptr);
+    auto program = operation::Program::compile(*operation);
+    EXPECT_EQ(program.getCode().size(), 5);
+    EXPECT_EQ(program.evaluateString(), "foo");
+    this->interfaces[0]->storedValue[0] = "0";
+    EXPECT_EQ(program.evaluateString(), "bar");
+}
+
+TEST_F(ProgramTest, ValueIsNotCopied) {
+    this->addInterface("itf1", {"foo"});
+    operation::Parser2 parser{
+        this->debug, this->interfaces, this->interfaces[0].get()};
+    auto operation = parser.parse("%1");
+    ASSERT_NE(operation, nullptr);
+    auto program = operation::Program::compile(*operation);
+    auto value = program.evaluate();
+    EXPECT_EQ(&value.asString(), &this->interfaces[0]->storedValue[0]);
+}
+
+TEST_F(ProgramTest, LegacyOperationsAreCalled) {
+    this->addInterface("itf1", {"12", "34"});
+    DynamicJsonBuffer buffer{512};
+    auto& data = buffer.parseObject(R"({
+        "payload": {
+            "type": "s+",
+            "ops": [
+                "<",
+                {"type": "value", "interface": "itf1", "template": "%1-%2"},
+                ">"
+            ]
+        }
+    })");
+    ASSERT_TRUE(data.success());
+    operation::Parser parser{this->interfaces, this->interfaces[0].get()};
+    auto operation = parser.parse(data, "payload", nullptr);
+    ASSERT_NE(operation, nullptr);
+    auto program = operation::Program::compile(*operation);
+    EXPECT_EQ(program.evaluateString(), "<12-34>");
+}
+
+// The rules of the example config, both as trees and as programs.
+struct ExampleConfigProgramTest : ProgramTest {
+    DynamicJsonBuffer buffer{4096};
+    std::vector<std::unique_ptr<operation::Operation>> operations;
+    std::vector<operation::Program> programs;
+
+    void SetUp() override {
+        std::string path{__FILE__};
+        path = path.substr(0, path.rfind('/')) +
+               "/../example_config/expressions/device_config.json";
+        std::ifstream file{path};
+        if (!file) {
+            GTEST_SKIP() << "Cannot open " << path;
+        }
+        std::stringstream content;
+        content << file.rdbuf();
+
+        auto& config = this->buffer.parseObject(content.str());
+        ASSERT_TRUE(config.success());
+        for (const JsonObject& interface :
+             config.get<JsonArray>("interfaces")) {
+            this->addInterface(
+                interface.get<std::string>("name"), {"0", "0", "0"});
+        }
+
+        for (JsonObject& action : config.get<JsonArray>("actions")) {
+            auto defaultInterface = findInterface(
+                this->interfaces, action.get<std::string>("interface"));
+            bool isCommand = action.get<std::string>("type") == "command";
+            if (!isCommand && !action["payload"].success() &&
+                !action["template"].success()) {
+                action.set("template", "%1");
+            }
+            operation::Parser parser{this->interfaces, defaultInterface};
+            this->operations.push_back(parser.parse(
+                action, isCommand ? "command" : "payload", "template"));
+            ASSERT_NE(this->operations.back(), nullptr);
+        }
+
+        for (const auto& operation : this->operations) {
+            this->programs.push_back(operation::Program::compile(*operation));
+        }
+    }
+
+    void setInputs(int i) {
+        const char* inputs[] = {"0", "3", "-1", "12.5"};
+        for (const auto& interface : this->interfaces) {
+            interface->storedValue[0] = inputs[i % 4];
+            interface->storedValue[1] = inputs[(i + 1) % 4];
+        }
+    }
+};
+
+TEST_F(ExampleConfigProgramTest, SameResultAsTree) {
+    for (int i = 0; i < 4; ++i) {
+        this->setInputs(i);
+        for (std::size_t j = 0; j < this->operations.size(); ++j) {
+            EXPECT_EQ(
+                this->programs[j].evaluateString(),
+                this->operations[j]->evaluate());
+        }
+    }
+}
+
+TEST_F(ExampleConfigProgramTest, DISABLED_Benchmark) {
+    constexpr int iterations = 100000;
+    std::size_t length = 0;
+    double tree = measure(iterations, [&](int i) {
+        this->setInputs(i);
+        for (const auto& operation : this->operations) {
+            length += operation->evaluateValue().asString().size();
+        }
+    });
+    double program = measure(iterations, [&](int i) {
+        this->setInputs(i);
+        for (auto& program : this->programs) {
+            length += program.evaluate().asString().size();
+        }
+    });
+    std::cout << this->operations.size() << " rules, tree: " << tree
+              << " ns, program: " << program << " ns per iteration ("
+              << length << " characters)" << std::endl;
+}
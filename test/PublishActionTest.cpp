@@ -0,0 +1,150 @@
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "DummyBackoff.hpp"
+#include "EspTestBase.hpp"
+#include "FakeMqttConnection.hpp"
+#include "common/InterfaceConfig.hpp"
+#include "common/MqttClient.hpp"
+#include "common/PublishAction.hpp"
+#include "common/TimerWheel.hpp"
+#include "operation/Streaming.hpp"
+
+namespace {
+
+constexpr unsigned interval = 1000;
+
+// Counts the evaluations, like a stateful operation would see them.
+class CountingValue : public operation::Operation {
+public:
+    explicit CountingValue(int& evaluations) : evaluations(evaluations) {}
+
+    operation::TypedValue evaluateValue() override {
+        ++this->evaluations;
+        return operation::TypedValue::fromString(this->value);
+    }
+
+    std::string value;
+
+private:
+    int& evaluations;
+};
+
+}  // unnamed namespace
+
+struct PublishActionTest : EspTestBase {
+    FakeMqttServer server;
+    FakeMqttConnection connection{this->server, [](bool) {}};
+    DummyBackoff backoff;
+    MqttClient mqttClient{this->debug,   this->esp,        this->wifi,
+                          this->backoff, this->connection, []() {}};
+    TimerWheel timers{this->esp};
+    InterfaceConfig interface;
+
+    int evaluations = 0;
+    CountingValue* value = nullptr;
+    std::unique_ptr<PublishAction> action;
+    std::vector<std::pair<unsigned long, std::string>> messages;
+    unsigned long start = 0;
+
+    PublishActionTest() {
+        auto connectionId = this->server.connect({});
+        this->server.subscribe(
+            connectionId, "topic", [this](size_t id, FakeMessage message) {
+            if (id != 0) {
+                this->messages.emplace_back(
+                    this->esp.millis() - this->start, message.payload);
+            }
+        });
+        this->mqttClient.setConfig(
+            MqttConfig{"device", {ServerConfig{}}, {"", "", ""}});
+        this->runUntil(5000);
+        this->start = this->esp.millis();
+    }
+
+    // If averageSize is given, the action publishes the moving average of
+    // the value.
+    void create(
+        double sendDiff, bool publishLast, std::size_t averageSize = 0) {
+        auto value = std::make_unique<CountingValue>(this->evaluations);
+        this->value = value.get();
+        std::unique_ptr<operation::Operation> operation = std::move(value);
+        if (averageSize != 0) {
+            operation = std::make_unique<operation::MovingAverage>(
+                std::move(operation), averageSize);
+        }
+        this->action = std::make_unique<PublishAction>(
+            this->debug, this->esp, this->timers, this->mqttClient, "topic",
+            std::move(operation), false, interval, sendDiff, publishLast);
+    }
+
+    void fireAt(unsigned long time, std::string value) {
+        this->runUntil(this->start + time);
+        this->value->value = std::move(value);
+        this->action->fire(this->interface);
+    }
+
+    void runUntil(unsigned long time) {
+        this->delayUntil(time, 10, [this]() {
+            this->timers.update();
+            this->mqttClient.loop();
+        });
+    }
+
+    using Messages = std::vector<std::pair<unsigned long, std::string>>;
+};
+
+TEST_F(PublishActionTest, DropsValuesTooSoon) {
+    this->create(0.0, false);
+    this->fireAt(0, "1");
+    this->fireAt(100, "2");
+    this->fireAt(500, "3");
+    this->runUntil(this->start + interval * 3);
+    EXPECT_EQ(this->messages, (Messages{{0, "1"}}));
+}
+
+TEST_F(PublishActionTest, PublishesLastValue) {
+    this->create(0.0, true);
+    this->fireAt(0, "1");
+    this->fireAt(100, "2");
+    this->fireAt(500, "3");
+    this->value->value = "4";
+    this->runUntil(this->start + interval * 3);
+    EXPECT_EQ(this->messages, (Messages{{0, "1"}, {interval, "3"}}));
+    EXPECT_EQ(this->evaluations, 3);
+}
+
+TEST_F(PublishActionTest, LastValueWithinSendDiff) {
+    this->create(1.0, true);
+    this->fireAt(0, "10");
+    this->fireAt(100, "10.5");
+    this->runUntil(this->start + interval * 3);
+    EXPECT_EQ(
+        this->messages, (Messages{{0, "10"}, {interval, "10.5"}}));
+    EXPECT_EQ(this->evaluations, 2);
+}
+
+TEST_F(PublishActionTest, SentValueCancelsLastValue) {
+    this->create(1.0, true);
+    this->fireAt(0, "10");
+    this->fireAt(100, "10.5");
+    this->fireAt(200, "12");
+    this->runUntil(this->start + interval * 3);
+    EXPECT_EQ(this->messages, (Messages{{0, "10"}, {200, "12"}}));
+}
+
+TEST_F(PublishActionTest, StatefulOperationSamplesEachFire) {
+    this->create(0.0, false, 3);
+    this->fireAt(0, "1");
+    this->fireAt(100, "2");
+    this->fireAt(500, "3");
+    this->fireAt(interval, "4");
+    this->runUntil(this->start + interval * 3);
+    EXPECT_EQ(this->messages, (Messages{{0, "1"}, {interval, "3"}}));
+    EXPECT_EQ(this->evaluations, 4);
+}
@@ -0,0 +1,166 @@
+#include <gtest/gtest.h>
+
+#include <limits>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "EspTestBase.hpp"
+#include "common/Interface.hpp"
+#include "common/InterfaceConfig.hpp"
+#include "common/Scheduler.hpp"
+#include "common/Sensor.hpp"
+#include "common/SensorInterface.hpp"
+#include "common/TimerWheel.hpp"
+
+namespace {
+
+constexpr unsigned long never = std::numeric_limits<unsigned long>::max();
+
+class FakeInterface : public Interface {
+public:
+    void start() override {}
+    void execute(const std::string& /*command*/) override {}
+    void update(Actions /*action*/) override {
+        ++this->updates;
+        if (this->nextUpdateAfterUpdate) {
+            this->nextUpdate = *this->nextUpdateAfterUpdate;
+        }
+    }
+    unsigned long getNextUpdate() const override { return this->nextUpdate; }
+
+    unsigned long nextUpdate = 0;
+    std::optional<unsigned long> nextUpdateAfterUpdate;
+    int updates = 0;
+};
+
+class FakeSensor : public Sensor {
+public:
+    std::optional<std::vector<std::string>> measure() override {
+        ++this->measurements;
+        return std::vector<std::string>{"1"};
+    }
+
+    int measurements = 0;
+};
+
+}  // unnamed namespace
+
+struct SchedulerTest : EspTestBase {
+    std::vector<std::unique_ptr<InterfaceConfig>> interfaces;
+    TimerWheel timers{this->esp};
+    Scheduler scheduler{this->esp, this->timers, 20};
+
+    template <typename InterfaceType>
+    InterfaceType& add(std::unique_ptr<InterfaceType> interface) {
+        auto& result = *interface;
+        this->interfaces.emplace_back(std::make_unique<InterfaceConfig>());
+        this->interfaces.back()->interface = std::move(interface);
+        return result;
+    }
+
+    FakeInterface& addFake(unsigned long nextUpdate) {
+        auto& result = this->add(std::make_unique<FakeInterface>());
+        result.nextUpdate = nextUpdate;
+        return result;
+    }
+};
+
+TEST_F(SchedulerTest, PollingInterfacesAreAlwaysUpdated) {
+    auto& interface = this->addFake(0);
+    for (int i = 0; i < 5; ++i) {
+        EXPECT_EQ(this->scheduler.update(this->interfaces), 1);
+    }
+    EXPECT_EQ(interface.updates, 5);
+}
+
+TEST_F(SchedulerTest, UpdatesOnlyWhenDue) {
+    auto& interface = this->addFake(105);
+    this->esp.delay(100);
+    EXPECT_EQ(this->scheduler.update(this->interfaces), 5);
+    EXPECT_EQ(interface.updates, 0);
+    this->esp.delay(4);
+    EXPECT_EQ(this->scheduler.update(this->interfaces), 1);
+    EXPECT_EQ(interface.updates, 0);
+    this->esp.delay(1);
+    this->scheduler.update(this->interfaces);
+    EXPECT_EQ(interface.updates, 1);
+    EXPECT_EQ(this->scheduler.getUpdateCount(), 1);
+    EXPECT_EQ(this->scheduler.getSkipCount(), 2);
+}
+
+TEST_F(SchedulerTest, SleepIsLimited) {
+    this->addFake(never);
+    EXPECT_EQ(this->scheduler.update(this->interfaces), 20);
+    this->addFake(1000);
+    EXPECT_EQ(this->scheduler.update(this->interfaces), 20);
+}
+
+TEST_F(SchedulerTest, SleepsUntilEarliestDeadline) {
+    this->addFake(50);
+    this->addFake(30);
+    this->addFake(never);
+    this->esp.delay(20);
+    EXPECT_EQ(this->scheduler.update(this->interfaces), 10);
+}
+
+TEST_F(SchedulerTest, DeadlineIsAskedAfterUpdate) {
+    auto& interface = this->addFake(0);
+    interface.nextUpdateAfterUpdate = 15;
+    EXPECT_EQ(this->scheduler.update(this->interfaces), 15);
+    EXPECT_EQ(this->scheduler.update(this->interfaces), 15);
+    EXPECT_EQ(interface.updates, 1);
+}
+
+TEST_F(SchedulerTest, SensorInterface) {
+    auto sensor = std::make_unique<FakeSensor>();
+    auto& sensorRef = *sensor;
+    auto& interface = this->add(std::make_unique<SensorInterface>(
+        this->debug, this->esp, this->timers, std::move(sensor), "sensor",
+        1000, 0, std::vector<std::string>{}));
+    EXPECT_EQ(this->timers.size(), 0);
+
+    this->esp.delay(10);
+    interface.start();
+    EXPECT_EQ(interface.getNextUpdate(), never);
+    EXPECT_EQ(this->timers.getNextUpdate(), 10);
+    this->scheduler.update(this->interfaces);
+    EXPECT_EQ(sensorRef.measurements, 1);
+    EXPECT_EQ(interface.getNextUpdate(), never);
+
+    int wakeups = 0;
+    while (this->esp.millis() < 1010) {
+        this->esp.delay(this->scheduler.update(this->interfaces));
+        ++wakeups;
+    }
+    EXPECT_EQ(sensorRef.measurements, 1);
+    EXPECT_EQ(this->esp.millis(), 1010);
+    // Once per maximum sleep, and at the start of each round of the wheel.
+    EXPECT_LE(wakeups, 1000 / 20 + 1000 / 64 + 1);
+    this->scheduler.update(this->interfaces);
+    EXPECT_EQ(sensorRef.measurements, 2);
+}
+
+TEST_F(SchedulerTest, SleepsUntilTimer) {
+    Timer timer{[]() {}};
+    this->addFake(never);
+    this->timers.start(timer, 7);
+    EXPECT_EQ(this->scheduler.update(this->interfaces), 7);
+    this->esp.delay(7);
+    this->scheduler.update(this->interfaces);
+    EXPECT_FALSE(timer.isActive());
+}
+
+TEST_F(SchedulerTest, SensorInterfacePulse) {
+    auto& interface = this->add(std::make_unique<SensorInterface>(
+        this->debug, this->esp, this->timers, std::make_unique<FakeSensor>(),
+        "sensor", 1000, 0, std::vector<std::string>{"0"}));
+    this->esp.delay(10);
+    interface.start();
+    this->scheduler.update(this->interfaces);
+    EXPECT_EQ(interface.getNextUpdate(), 0);
+    this->scheduler.update(this->interfaces);
+    EXPECT_EQ(this->interfaces[0]->storedValue[0], "0");
+    EXPECT_EQ(interface.getNextUpdate(), never);
+}
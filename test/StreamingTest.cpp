@@ -0,0 +1,211 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "EspTestBase.hpp"
+#include "common/InterfaceConfig.hpp"
+#include "operation/Memoized.hpp"
+#include "operation/OperationParser2.hpp"
+#include "operation/Program.hpp"
+
+struct StreamingTest : EspTestBase {
+    std::vector<std::unique_ptr<InterfaceConfig>> interfaces;
+
+    StreamingTest() {
+        this->interfaces.emplace_back(std::make_unique<InterfaceConfig>());
+        this->interfaces.back()->name = "x";
+        this->interfaces.back()->storedValue = {""};
+    }
+
+    std::unique_ptr<operation::Operation> parse(const std::string& data) {
+        operation::Parser2 parser{
+            this->debug, this->interfaces, this->interfaces[0].get(),
+            &this->esp};
+        return parser.parse(data);
+    }
+
+    void set(std::string value) {
+        this->interfaces[0]->storedValue[0] = std::move(value);
+        ++this->interfaces[0]->generation;
+    }
+
+    std::vector<std::string> evaluateAll(
+        operation::Operation& operation,
+        const std::vector<std::string>& values) {
+        std::vector<std::string> result;
+        for (const auto& value : values) {
+            this->set(value);
+            result.push_back(operation.evaluate());
+        }
+        return result;
+    }
+};
+
+using Values = std::vector<std::string>;
+
+TEST_F(StreamingTest, MovingAverage) {
+    auto operation = this->parse("avg([x], 3)");
+    ASSERT_NE(operation, nullptr);
+    EXPECT_EQ(
+        this->evaluateAll(*operation, {"3", "6", "", "9", "12", "0"}),
+        (Values{"3", "4.5", "4.5", "6", "9", "7"}));
+}
+
+TEST_F(StreamingTest, MovingAverageOfExpression) {
+    auto operation = this->parse("avg([x] * 2, 2) + 1");
+    ASSERT_NE(operation, nullptr);
+    EXPECT_EQ(
+        this->evaluateAll(*operation, {"1", "2", "3"}),
+        (Values{"3", "4", "6"}));
+}
+
+TEST_F(StreamingTest, MovingMinimumAndMaximum) {
+    auto minimum = this->parse("min([x], 4)");
+    auto maximum = this->parse("max([x], 4)");
+    ASSERT_NE(minimum, nullptr);
+    ASSERT_NE(maximum, nullptr);
+
+    std::mt19937 random{42};
+    std::uniform_int_distribution<int> distribution{-50, 50};
+    std::vector<int> samples;
+    for (int i = 0; i < 1000; ++i) {
+        samples.push_back(distribution(random));
+        this->set(std::to_string(samples.back()));
+        auto begin = samples.end() - std::min<std::size_t>(samples.size(), 4);
+        EXPECT_EQ(
+            minimum->evaluate(),
+            std::to_string(*std::min_element(begin, samples.end())));
+        EXPECT_EQ(
+            maximum->evaluate(),
+            std::to_string(*std::max_element(begin, samples.end())));
+    }
+}
+
+TEST_F(StreamingTest, WindowOfOne) {
+    auto operation = this->parse("max([x], 1)");
+    ASSERT_NE(operation, nullptr);
+    EXPECT_EQ(
+        this->evaluateAll(*operation, {"5", "2", "7", "1"}),
+        (Values{"5", "2", "7", "1"}));
+}
+
+TEST_F(StreamingTest, ExponentialAverage) {
+    auto operation = this->parse("ema([x], 0.5)");
+    ASSERT_NE(operation, nullptr);
+    EXPECT_EQ(
+        this->evaluateAll(*operation, {"10", "20", "", "0"}),
+        (Values{"10", "15", "15", "7.5"}));
+}
+
+TEST_F(StreamingTest, Rate) {
+    auto operation = this->parse("rate([x])");
+    ASSERT_NE(operation, nullptr);
+    this->set("100");
+    EXPECT_EQ(operation->evaluate(), "");
+    this->esp.delay(2000);
+    this->set("110");
+    EXPECT_EQ(operation->evaluate(), "5");
+    this->esp.delay(500);
+    this->set("100");
+    EXPECT_EQ(operation->evaluate(), "-20");
+    this->set("150");
+    EXPECT_EQ(operation->evaluate(), "-20");
+}
+
+TEST_F(StreamingTest, Hysteresis) {
+    auto operation = this->parse("hyst([x], 20, 22)");
+    ASSERT_NE(operation, nullptr);
+    EXPECT_EQ(
+        this->evaluateAll(
+            *operation, {"19", "21", "22", "21", "20.5", "20", "21", "23"}),
+        (Values{"0", "0", "1", "1", "1", "0", "0", "1"}));
+}
+
+TEST_F(StreamingTest, Changed) {
+    auto operation = this->parse("changed([x])");
+    ASSERT_NE(operation, nullptr);
+    EXPECT_EQ(
+        this->evaluateAll(*operation, {"a", "a", "b", "b", "", "b", "a"}),
+        (Values{"0", "0", "1", "0", "0", "0", "1"}));
+}
+
+TEST_F(StreamingTest, ConstantOperandIsNotFolded) {
+    auto operation = this->parse("changed(1) || avg(2, 2) > 1");
+    ASSERT_NE(operation, nullptr);
+    EXPECT_EQ(operation->getConstantValue(), nullptr);
+    EXPECT_EQ(operation->evaluate(), "1");
+}
+
+TEST_F(StreamingTest, SampledOnEveryEvaluationWhenMemoized) {
+    auto operation = operation::memoize(this->parse("avg([x], 2) s+ [x]"));
+    ASSERT_NE(operation, nullptr);
+    this->set("2");
+    EXPECT_EQ(operation->evaluate(), "22");
+    this->set("4");
+    EXPECT_EQ(operation->evaluate(), "34");
+    EXPECT_EQ(operation->evaluate(), "44");
+}
+
+TEST_F(StreamingTest, Compiled) {
+    auto operation = this->parse("avg([x], 2) + 1");
+    ASSERT_NE(operation, nullptr);
+    auto program = operation::Program::compile(*operation);
+    this->set("2");
+    EXPECT_EQ(program.evaluateString(), "3");
+    this->set("4");
+    EXPECT_EQ(program.evaluateString(), "4");
+}
+
+TEST_F(StreamingTest, FunctionNameIsNotConfusedWithConstant) {
+    auto operation = this->parse("on && true");
+    ASSERT_NE(operation, nullptr);
+    EXPECT_EQ(operation->evaluate(), "1");
+}
+
+TEST_F(StreamingTest, UnknownFunction) {
+    auto ex = expectLog("Error: Unknown function: foo");
+    EXPECT_EQ(this->parse("foo([x])"), nullptr);
+}
+
+TEST_F(StreamingTest, WrongNumberOfArguments) {
+    auto ex = expectLog("Error: avg() takes 2 arguments, got 1");
+    EXPECT_EQ(this->parse("avg([x])"), nullptr);
+}
+
+TEST_F(StreamingTest, NoArguments) {
+    auto ex = expectLog("Error: changed() takes 1 arguments, got 0");
+    EXPECT_EQ(this->parse("changed()"), nullptr);
+}
+
+TEST_F(StreamingTest, WindowSizeMustBeConstant) {
+    auto ex = expectLog("Error: avg(): Argument must be constant");
+    EXPECT_EQ(this->parse("avg([x], [x])"), nullptr);
+}
+
+TEST_F(StreamingTest, BadWindowSize) {
+    auto ex = expectLog("Error: min(): Window size", 3);
+    EXPECT_EQ(this->parse("min([x], 0)"), nullptr);
+    EXPECT_EQ(this->parse("min([x], 2.5)"), nullptr);
+    EXPECT_EQ(this->parse("min([x], 1001)"), nullptr);
+}
+
+TEST_F(StreamingTest, BadFactor) {
+    auto ex = expectLog("Error: ema(): Factor", 2);
+    EXPECT_EQ(this->parse("ema([x], 0)"), nullptr);
+    EXPECT_EQ(this->parse("ema([x], 1.5)"), nullptr);
+}
+
+TEST_F(StreamingTest, RateNeedsTime) {
+    operation::Parser2 parser{this->debug, this->interfaces, nullptr};
+    auto ex = expectLog("Error: rate(): Time is not available");
+    EXPECT_EQ(parser.parse("rate([x])"), nullptr);
+}
+
+TEST_F(StreamingTest, UnclosedArguments) {
+    auto ex = expectLog("Syntax error:");
+    EXPECT_EQ(this->parse("avg([x], 2"), nullptr);
+}
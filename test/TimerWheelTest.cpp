@@ -0,0 +1,171 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "EspTestBase.hpp"
+#include "common/TimerWheel.hpp"
+
+struct TimerWheelTest : EspTestBase {
+    TimerWheel timers{this->esp};
+    std::vector<unsigned long> fired;
+
+    std::unique_ptr<Timer> createTimer() {
+        return std::make_unique<Timer>(
+            [this]() { this->fired.push_back(this->esp.millis()); });
+    }
+
+    // Steps the time by 1 ms until the given time.
+    void runUntil(unsigned long time) {
+        while (this->esp.millis() != time) {
+            this->esp.delay(1);
+            this->timers.update();
+        }
+    }
+};
+
+TEST_F(TimerWheelTest, FiresAtDeadline) {
+    auto timer = this->createTimer();
+    this->timers.start(*timer, 10);
+    EXPECT_TRUE(timer->isActive());
+    EXPECT_EQ(timer->getDeadline(), 10);
+    EXPECT_EQ(this->timers.size(), 1);
+    this->runUntil(100);
+    EXPECT_EQ(this->fired, std::vector<unsigned long>{10});
+    EXPECT_FALSE(timer->isActive());
+    EXPECT_EQ(this->timers.size(), 0);
+}
+
+TEST_F(TimerWheelTest, FiresLateWhenUpdatedLate) {
+    auto timer = this->createTimer();
+    this->timers.startAfter(*timer, 10);
+    this->esp.delay(50);
+    this->timers.update();
+    EXPECT_EQ(this->fired, std::vector<unsigned long>{50});
+}
+
+TEST_F(TimerWheelTest, DeadlineInThePast) {
+    this->esp.delay(100);
+    auto timer = this->createTimer();
+    this->timers.start(*timer, 50);
+    this->timers.update();
+    EXPECT_EQ(this->fired, std::vector<unsigned long>{100});
+}
+
+TEST_F(TimerWheelTest, Cancel) {
+    auto timer = this->createTimer();
+    this->timers.start(*timer, 10);
+    this->timers.cancel(*timer);
+    EXPECT_FALSE(timer->isActive());
+    EXPECT_EQ(this->timers.size(), 0);
+    this->runUntil(100);
+    EXPECT_TRUE(this->fired.empty());
+}
+
+TEST_F(TimerWheelTest, DestroyingCancels) {
+    auto timer = this->createTimer();
+    this->timers.start(*timer, 10);
+    timer.reset();
+    EXPECT_EQ(this->timers.size(), 0);
+    this->runUntil(100);
+    EXPECT_TRUE(this->fired.empty());
+}
+
+TEST_F(TimerWheelTest, Restart) {
+    auto timer = this->createTimer();
+    this->timers.start(*timer, 10);
+    this->timers.start(*timer, 5000);
+    EXPECT_EQ(this->timers.size(), 1);
+    this->runUntil(10000);
+    EXPECT_EQ(this->fired, std::vector<unsigned long>{5000});
+}
+
+TEST_F(TimerWheelTest, Periodic) {
+    Timer timer{[&]() {
+        this->fired.push_back(this->esp.millis());
+        this->timers.startAfter(timer, 100);
+    }};
+    this->timers.start(timer, 100);
+    this->runUntil(450);
+    EXPECT_EQ(this->fired, (std::vector<unsigned long>{100, 200, 300, 400}));
+}
+
+TEST_F(TimerWheelTest, RestartForNowFiresInNextUpdate) {
+    int count = 0;
+    Timer timer{[&]() {
+        ++count;
+        this->timers.start(timer, this->esp.millis());
+    }};
+    this->timers.start(timer, 0);
+    this->timers.update();
+    EXPECT_EQ(count, 1);
+    this->timers.update();
+    EXPECT_EQ(count, 1);
+    this->esp.delay(1);
+    this->timers.update();
+    EXPECT_EQ(count, 2);
+}
+
+TEST_F(TimerWheelTest, CancelOtherTimerFromCallback) {
+    auto second = this->createTimer();
+    Timer first{[&]() { this->timers.cancel(*second); }};
+    this->timers.start(first, 10);
+    this->timers.start(*second, 10);
+    this->runUntil(20);
+    EXPECT_TRUE(this->fired.empty());
+    EXPECT_EQ(this->timers.size(), 0);
+}
+
+TEST_F(TimerWheelTest, ManyTimers) {
+    std::mt19937 random{1};
+    std::uniform_int_distribution<unsigned long> distribution{1, 300000};
+    std::vector<std::unique_ptr<Timer>> timers;
+    std::vector<unsigned long> deadlines;
+    this->esp.delay(12345);
+    for (int i = 0; i < 1000; ++i) {
+        timers.push_back(this->createTimer());
+        deadlines.push_back(this->esp.millis() + distribution(random));
+        this->timers.start(*timers.back(), deadlines.back());
+    }
+    std::sort(deadlines.begin(), deadlines.end());
+    this->runUntil(this->esp.millis() + 300000);
+    EXPECT_EQ(this->fired, deadlines);
+}
+
+TEST_F(TimerWheelTest, BeyondHighestLevel) {
+    auto timer = this->createTimer();
+    constexpr unsigned long deadline = 40000000;
+    this->timers.start(*timer, deadline);
+    this->runUntil(deadline + 1);
+    EXPECT_EQ(this->fired, std::vector<unsigned long>{deadline});
+}
+
+TEST_F(TimerWheelTest, WrapAround) {
+    constexpr auto max = std::numeric_limits<unsigned long>::max();
+    // The time cannot jump more than half of the range at once.
+    this->esp.delay(max / 2);
+    this->timers.update();
+    this->esp.delay(max - 100 - max / 2);
+    auto before = this->createTimer();
+    auto after = this->createTimer();
+    this->timers.start(*before, max - 10);
+    this->timers.start(*after, 200);
+    this->runUntil(500);
+    EXPECT_EQ(this->fired, (std::vector<unsigned long>{max - 10, 200}));
+}
+
+TEST_F(TimerWheelTest, NextUpdate) {
+    EXPECT_EQ(
+        this->timers.getNextUpdate(),
+        std::numeric_limits<unsigned long>::max());
+    this->esp.delay(1);
+    auto timer = this->createTimer();
+    this->timers.start(*timer, 30);
+    EXPECT_EQ(this->timers.getNextUpdate(), 30);
+    this->timers.start(*timer, 1000);
+    // The higher level is moved down at the start of the next round.
+    EXPECT_EQ(this->timers.getNextUpdate(), 64);
+}
@@ -0,0 +1,297 @@
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "EspTestBase.hpp"
+#include "common/Actions.hpp"
+#include "common/CommandAction.hpp"
+#include "common/Interface.hpp"
+#include "common/InterfaceConfig.hpp"
+#include "common/TimedAction.hpp"
+#include "common/TimerWheel.hpp"
+#include "operation/Memoized.hpp"
+#include "operation/OperationParser2.hpp"
+
+namespace {
+
+class RecordingInterface : public Interface {
+public:
+    void start() override {}
+    void execute(const std::string& command) override {
+        this->commands.push_back(command);
+    }
+    void update(Actions /*action*/) override {}
+
+    std::vector<std::string> commands;
+};
+
+}  // unnamed namespace
+
+struct TimingTest : EspTestBase {
+    std::vector<std::unique_ptr<InterfaceConfig>> interfaces;
+
+    TimingTest() {
+        this->addInterface("motion");
+        this->addInterface("light");
+    }
+
+    void addInterface(std::string name) {
+        this->interfaces.emplace_back(std::make_unique<InterfaceConfig>());
+        this->interfaces.back()->name = std::move(name);
+    }
+
+    std::unique_ptr<operation::Operation> parse(const std::string& data) {
+        operation::Parser2 parser{
+            this->debug, this->interfaces, this->interfaces[1].get(),
+            &this->esp};
+        return parser.parse(data);
+    }
+
+    void fire(std::size_t index, std::vector<std::string> values) {
+        Actions{*this->interfaces[index], this->esp}.fire(values);
+    }
+};
+
+TEST_F(TimingTest, Now) {
+    auto operation = this->parse("now()");
+    ASSERT_NE(operation, nullptr);
+    EXPECT_EQ(operation->evaluate(), "0");
+    this->esp.delay(1234);
+    EXPECT_EQ(operation->evaluate(), "1234");
+}
+
+TEST_F(TimingTest, SinceNeverFired) {
+    auto operation = this->parse("since([motion])");
+    ASSERT_NE(operation, nullptr);
+    this->esp.delay(1000);
+    EXPECT_EQ(operation->evaluate(), "");
+}
+
+TEST_F(TimingTest, SinceLastFired) {
+    auto operation = this->parse("since([motion])");
+    ASSERT_NE(operation, nullptr);
+    this->esp.delay(1000);
+    this->fire(0, {"1"});
+    EXPECT_EQ(operation->evaluate(), "0");
+    this->esp.delay(2500);
+    EXPECT_EQ(operation->evaluate(), "2500");
+    this->fire(0, {"1"});
+    this->esp.delay(100);
+    EXPECT_EQ(operation->evaluate(), "100");
+}
+
+TEST_F(TimingTest, FiringWithoutValueDoesNotCount) {
+    auto operation = this->parse("since([motion])");
+    ASSERT_NE(operation, nullptr);
+    this->fire(0, {"1"});
+    this->esp.delay(500);
+    this->fire(0, {});
+    EXPECT_EQ(operation->evaluate(), "500");
+}
+
+TEST_F(TimingTest, SinceDefaultInterface) {
+    auto operation = this->parse("since()");
+    ASSERT_NE(operation, nullptr);
+    this->fire(1, {"1"});
+    this->esp.delay(20);
+    EXPECT_EQ(operation->evaluate(), "20");
+}
+
+TEST_F(TimingTest, SinceUsesInterface) {
+    operation::Parser2 parser{
+        this->debug, this->interfaces, nullptr, &this->esp};
+    ASSERT_NE(parser.parse("since([motion]) > 1s"), nullptr);
+    EXPECT_EQ(
+        parser.getUsedInterfaces(),
+        std::unordered_set<InterfaceConfig*>{this->interfaces[0].get()});
+}
+
+TEST_F(TimingTest, Durations) {
+    const std::pair<const char*, const char*> samples[] = {
+        {"5ms", "5"},       {"1.5s", "1500"},   {"2m", "120000"},
+        {"1h", "3600000"},  {"1d", "86400000"}, {"-2s", "-2000"},
+        {"5s + 3", "5003"}, {"5 s+ 3", "53"},   {"5s+ 3", "53"},
+        {"5s<6", "1"},      {"5s < 6", "0"},
+    };
+    for (const auto& [expression, expected] : samples) {
+        auto operation = this->parse(expression);
+        ASSERT_NE(operation, nullptr) << expression;
+        EXPECT_EQ(operation->evaluate(), expected) << expression;
+    }
+}
+
+TEST_F(TimingTest, TurnOffAfterNoMotion) {
+    auto operation = operation::memoize(
+        this->parse("[motion] == 0 && since([motion]) >= 5m ? 'off' : 'on'"));
+    ASSERT_NE(operation, nullptr);
+    this->fire(0, {"1"});
+    this->esp.delay(60000);
+    EXPECT_EQ(operation->evaluate(), "on");
+    this->fire(0, {"0"});
+    this->esp.delay(299999);
+    EXPECT_EQ(operation->evaluate(), "on");
+    this->esp.delay(1);
+    EXPECT_EQ(operation->evaluate(), "off");
+    this->fire(0, {"1"});
+    EXPECT_EQ(operation->evaluate(), "on");
+}
+
+TEST_F(TimingTest, UnknownUnit) {
+    auto ex = expectLog("Syntax error: Unknown unit: sec");
+    EXPECT_EQ(this->parse("5sec"), nullptr);
+}
+
+TEST_F(TimingTest, SinceUnknownInterface) {
+    auto ex = expectLog("Error: Interface not found: foo");
+    EXPECT_EQ(this->parse("since([foo])"), nullptr);
+}
+
+TEST_F(TimingTest, SinceTakesInterface) {
+    auto ex = expectLog("Syntax error:");
+    EXPECT_EQ(this->parse("since([motion] + 1)"), nullptr);
+}
+
+TEST_F(TimingTest, SinceWithoutDefaultInterface) {
+    operation::Parser2 parser{
+        this->debug, this->interfaces, nullptr, &this->esp};
+    auto ex = expectLog("Error: No default interface");
+    EXPECT_EQ(parser.parse("since()"), nullptr);
+}
+
+TEST_F(TimingTest, TimeNotAvailable) {
+    operation::Parser2 parser{
+        this->debug, this->interfaces, this->interfaces[0].get()};
+    auto ex = expectLog("Error: now(): Time is not available");
+    EXPECT_EQ(parser.parse("now()"), nullptr);
+    auto ex2 = expectLog("Error: since(): Time is not available");
+    EXPECT_EQ(parser.parse("since()"), nullptr);
+}
+
+TEST_F(TimingTest, NextChange) {
+    const std::pair<const char*, unsigned long> samples[] = {
+        {"since([motion]) >= 5s", 6000},
+        {"since([motion]) > 5s", 6001},
+        {"since([motion]) < 2.5s", 3500},
+        {"5s <= since([motion])", 6000},
+        {"since([motion]) == 5s", 6000},
+        {"now() > 10s", 10001},
+        {"[motion] == 0 && since([motion]) >= 5s ? 'off' : 'on'", 6000},
+        // Beyond 2^24 ms, the time is rounded to a float the same way when it
+        // is evaluated.
+        {"since([motion]) >= 5h", 18000999},
+        {"now() > 5h", 18000002},
+        {"since([motion]) > 1d", 86401005},
+        {"since([motion]) < 30d", 2592000872},
+    };
+    this->esp.delay(1000);
+    this->fire(0, {"0"});
+    for (const auto& [expression, expected] : samples) {
+        auto operation = this->parse(expression);
+        ASSERT_NE(operation, nullptr) << expression;
+        EXPECT_EQ(operation->getNextChange(this->esp.millis()), expected)
+            << expression;
+    }
+}
+
+TEST_F(TimingTest, NoNextChange) {
+    for (const char* expression :
+         {"since([motion]) >= 5s", "since([motion]) + 5s", "[motion] > 5s",
+          "since([motion]) >= [light]", "since([motion]) s== '5'"}) {
+        auto operation = this->parse(expression);
+        ASSERT_NE(operation, nullptr) << expression;
+        EXPECT_EQ(operation->getNextChange(this->esp.millis()), std::nullopt)
+            << expression;
+        this->fire(0, {"0"});
+        this->fire(1, {"0"});
+    }
+
+    auto operation = this->parse("since([motion]) >= 5s");
+    this->esp.delay(6000);
+    EXPECT_EQ(operation->getNextChange(this->esp.millis()), std::nullopt);
+}
+
+TEST_F(TimingTest, BeyondIntRange) {
+    this->esp.delay(2147483648UL);
+    this->fire(0, {"0"});
+    this->esp.delay(3000000000UL - 2147483648UL);
+    const std::pair<const char*, const char*> samples[] = {
+        {"now()", "3000000000"},
+        {"since([motion])", "852516352"},
+        {"now() >= 3000000000", "1"},
+        {"now() / 1000", "3000000"},
+    };
+    for (const auto& [expression, expected] : samples) {
+        auto operation = this->parse(expression);
+        ASSERT_NE(operation, nullptr) << expression;
+        EXPECT_EQ(operation->evaluate(), expected) << expression;
+    }
+    auto operation = this->parse("since([motion]) >= 10d");
+    EXPECT_EQ(operation->getNextChange(this->esp.millis()), 3011483616UL);
+}
+
+TEST_F(TimingTest, EqualityChangesTwice) {
+    auto operation = this->parse("since([motion]) == 5s");
+    ASSERT_NE(operation, nullptr);
+    this->fire(0, {"0"});
+    this->esp.delay(5000);
+    EXPECT_EQ(operation->getNextChange(this->esp.millis()), 5001);
+}
+
+TEST_F(TimingTest, TimedActionTurnsOffWithoutEvents) {
+    TimerWheel timers{this->esp};
+    RecordingInterface light;
+    auto operation = operation::memoize(
+        this->parse("[motion] == 0 && since([motion]) >= 5m ? 'off' : 'on'"));
+    ASSERT_NE(operation, nullptr);
+    auto& timedOperation = *operation;
+    this->interfaces[0]->actions.push_back(std::make_unique<TimedAction>(
+        std::make_unique<CommandAction>(light, std::move(operation)),
+        timedOperation, this->esp, timers));
+
+    auto run = [&](unsigned long time) {
+        this->delayUntil(time, 1000, [&]() { timers.update(); });
+    };
+
+    this->fire(0, {"1"});
+    run(60000);
+    this->fire(0, {"0"});
+    run(60000 + 299000);
+    EXPECT_EQ(light.commands, (std::vector<std::string>{"on", "on"}));
+    run(60000 + 300000);
+    EXPECT_EQ(light.commands, (std::vector<std::string>{"on", "on", "off"}));
+    EXPECT_EQ(timers.size(), 0);
+    run(60000 + 600000);
+    EXPECT_EQ(light.commands.size(), 3);
+
+    // Motion again before the time is up.
+    this->fire(0, {"0"});
+    run(60000 + 600000 + 100000);
+    this->fire(0, {"0"});
+    run(60000 + 600000 + 399000);
+    EXPECT_EQ(light.commands.size(), 5);
+    run(60000 + 600000 + 400000);
+    EXPECT_EQ(light.commands.size(), 6);
+    EXPECT_EQ(light.commands.back(), "off");
+}
+
+TEST_F(TimingTest, TimedActionAfterHours) {
+    TimerWheel timers{this->esp};
+    RecordingInterface light;
+    auto operation = operation::memoize(
+        this->parse("since([motion]) >= 5h ? 'off' : 'on'"));
+    ASSERT_NE(operation, nullptr);
+    auto& timedOperation = *operation;
+    this->interfaces[0]->actions.push_back(std::make_unique<TimedAction>(
+        std::make_unique<CommandAction>(light, std::move(operation)),
+        timedOperation, this->esp, timers));
+
+    this->esp.delay(1000);
+    this->fire(0, {"1"});
+    this->delayUntil(
+        1000 + 5 * 3600000 - 60000, 60000, [&]() { timers.update(); });
+    EXPECT_EQ(light.commands, (std::vector<std::string>{"on"}));
+    this->delayUntil(1000 + 5 * 3600000, 1000, [&]() { timers.update(); });
+    EXPECT_EQ(light.commands, (std::vector<std::string>{"on", "off"}));
+}
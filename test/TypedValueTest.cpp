@@ -0,0 +1,96 @@
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+
+#include "operation/TypedValue.hpp"
+#include "tools/string.hpp"
+
+using operation::TypedValue;
+
+TEST(TypedValueTest, StringIsKeptAsIs) {
+    auto value = TypedValue::fromString("foo");
+    EXPECT_EQ(value.getType(), TypedValue::Type::string);
+    EXPECT_EQ(value.asString(), "foo");
+    EXPECT_EQ(std::move(value).releaseString(), "foo");
+}
+
+TEST(TypedValueTest, ReferenceDoesNotCopy) {
+    const std::string s = "bar";
+    auto value = TypedValue::fromReference(s);
+    EXPECT_EQ(&value.asString(), &s);
+    EXPECT_EQ(std::move(value).releaseString(), "bar");
+}
+
+TEST(TypedValueTest, DefaultIsEmptyString) {
+    TypedValue value;
+    EXPECT_EQ(value.getType(), TypedValue::Type::string);
+    EXPECT_EQ(value.asString(), "");
+    EXPECT_EQ(value.asNumber(), 0.0f);
+    EXPECT_FALSE(value.asBool());
+}
+
+TEST(TypedValueTest, StringToNumber) {
+    EXPECT_EQ(TypedValue::fromString("12.5").asNumber(), 12.5f);
+    EXPECT_EQ(TypedValue::fromString("-3").asNumber(), -3.0f);
+    EXPECT_EQ(TypedValue::fromString("foo").asNumber(), 0.0f);
+    EXPECT_EQ(TypedValue::fromString("on").asNumber(), 0.0f);
+}
+
+TEST(TypedValueTest, StringToBool) {
+    EXPECT_TRUE(TypedValue::fromString("1").asBool());
+    EXPECT_TRUE(TypedValue::fromString("on").asBool());
+    EXPECT_TRUE(TypedValue::fromString("TRUE").asBool());
+    EXPECT_FALSE(TypedValue::fromString("0").asBool());
+    EXPECT_FALSE(TypedValue::fromString("off").asBool());
+    EXPECT_FALSE(TypedValue::fromString("2").asBool());
+    EXPECT_FALSE(TypedValue::fromString("foo").asBool());
+}
+
+TEST(TypedValueTest, NumberToString) {
+    EXPECT_EQ(TypedValue::fromNumber(8).asString(), "8");
+    EXPECT_EQ(TypedValue::fromNumber(-2).asString(), "-2");
+    EXPECT_EQ(TypedValue::fromNumber(4.5).asString(), "4.5");
+    EXPECT_EQ(TypedValue::fromNumber(-0.0f).asString(), "0");
+    EXPECT_EQ(TypedValue::fromNumber(0.1f + 0.2f).asString(), "0.300000");
+}
+
+TEST(TypedValueTest, NumberToNumberMatchesStringRoundTrip) {
+    for (float number :
+         {0.0f, -0.0f, 1.0f, -7.0f, 4.5f, 1.0f / 3.0f, -2.0f / 3.0f,
+          0.1f + 0.2f, 0.0000001f, 123456789.0f, 16777217.0f}) {
+        float expected = std::atof(tools::floatToString(number, 6).c_str());
+        EXPECT_EQ(TypedValue::fromNumber(number).asNumber(), expected)
+            << number;
+    }
+}
+
+TEST(TypedValueTest, NumberToBool) {
+    EXPECT_TRUE(TypedValue::fromNumber(1).asBool());
+    EXPECT_FALSE(TypedValue::fromNumber(0).asBool());
+    EXPECT_FALSE(TypedValue::fromNumber(2).asBool());
+    EXPECT_FALSE(TypedValue::fromNumber(1.0000001f).asBool());
+}
+
+TEST(TypedValueTest, BoolConversions) {
+    EXPECT_EQ(TypedValue::fromBool(true).asString(), "1");
+    EXPECT_EQ(TypedValue::fromBool(false).asString(), "0");
+    EXPECT_EQ(TypedValue::fromBool(true).asNumber(), 1.0f);
+    EXPECT_EQ(TypedValue::fromBool(false).asNumber(), 0.0f);
+    EXPECT_TRUE(TypedValue::fromBool(true).asBool());
+    EXPECT_FALSE(TypedValue::fromBool(false).asBool());
+}
+
+TEST(TypedValueTest, AssignInPlace) {
+    const std::string s = "foo";
+    auto value = TypedValue::fromNumber(4.5);
+    EXPECT_EQ(value.asString(), "4.5");
+    value.assignReference(s);
+    EXPECT_EQ(&value.asString(), &s);
+    value.assignNumber(2);
+    EXPECT_EQ(value.asString(), "2");
+    value.assignBool(false);
+    EXPECT_EQ(value.asString(), "0");
+    value.assignString("bar");
+    EXPECT_EQ(value.getType(), TypedValue::Type::string);
+    EXPECT_EQ(value.asString(), "bar");
+}
@@ -0,0 +1,160 @@
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "EspTestBase.hpp"
+#include "common/InterfaceConfig.hpp"
+#include "operation/OperationParser2.hpp"
+#include "tools/arena.hpp"
+
+namespace {
+
+struct Allocated : tools::ArenaAllocated {
+    char data[40];
+};
+
+struct Large : tools::ArenaAllocated {
+    char data[300];
+};
+
+}  // unnamed namespace
+
+TEST(ArenaTest, AllocatesFromBlocks) {
+    tools::Arena arena{256};
+    void* first = arena.allocate(10);
+    void* second = arena.allocate(10);
+    EXPECT_EQ(tools::Arena::find(first), &arena);
+    EXPECT_EQ(tools::Arena::find(second), &arena);
+    EXPECT_GT(second, first);
+    EXPECT_LT(
+        static_cast<char*>(second) - static_cast<char*>(first),
+        static_cast<std::ptrdiff_t>(2 * alignof(std::max_align_t)));
+    EXPECT_EQ(arena.getStatistics().blocks, 1);
+    EXPECT_EQ(arena.getStatistics().capacity, 256);
+}
+
+TEST(ArenaTest, NewBlockWhenFull) {
+    tools::Arena arena{256};
+    for (int i = 0; i < 12; ++i) {
+        arena.allocate(40);
+    }
+    EXPECT_EQ(arena.getStatistics().blocks, 3);
+    EXPECT_EQ(arena.getStatistics().capacity, 3 * 256);
+}
+
+TEST(ArenaTest, LargeObjectGetsOwnBlock) {
+    tools::Arena arena{256};
+    void* small1 = arena.allocate(16);
+    void* large = arena.allocate(1024);
+    void* small2 = arena.allocate(16);
+    EXPECT_EQ(tools::Arena::find(large), &arena);
+    EXPECT_LT(
+        static_cast<char*>(small2) - static_cast<char*>(small1),
+        static_cast<std::ptrdiff_t>(256));
+    EXPECT_EQ(arena.getStatistics().blocks, 2);
+    EXPECT_EQ(arena.getStatistics().capacity, 256 + 1024);
+}
+
+TEST(ArenaTest, ObjectsAreCreatedInCurrentArena) {
+    tools::Arena arena;
+    std::unique_ptr<Allocated> outside = std::make_unique<Allocated>();
+    std::unique_ptr<Allocated> inside;
+    {
+        tools::Arena::Scope scope{arena};
+        EXPECT_EQ(tools::Arena::getCurrent(), &arena);
+        inside = std::make_unique<Allocated>();
+    }
+    EXPECT_EQ(tools::Arena::getCurrent(), nullptr);
+    EXPECT_EQ(tools::Arena::find(outside.get()), nullptr);
+    EXPECT_EQ(tools::Arena::find(inside.get()), &arena);
+    EXPECT_EQ(arena.getStatistics().released, 0);
+    inside.reset();
+    outside.reset();
+    EXPECT_GE(arena.getStatistics().released, sizeof(Allocated));
+}
+
+TEST(ArenaTest, ScopesNest) {
+    tools::Arena arena1;
+    tools::Arena arena2;
+    tools::Arena::Scope scope1{arena1};
+    {
+        tools::Arena::Scope scope2{arena2};
+        auto object = std::make_unique<Large>();
+        EXPECT_EQ(tools::Arena::find(object.get()), &arena2);
+    }
+    auto object = std::make_unique<Large>();
+    EXPECT_EQ(tools::Arena::find(object.get()), &arena1);
+}
+
+TEST(ArenaTest, TotalStatistics) {
+    tools::Arena arena1{256};
+    tools::Arena arena2{512};
+    arena1.allocate(16);
+    arena2.allocate(16);
+    auto statistics = tools::Arena::getTotalStatistics();
+    EXPECT_EQ(statistics.blocks, 2);
+    EXPECT_EQ(statistics.capacity, 768);
+}
+
+struct ArenaOperationTest : EspTestBase {
+    std::vector<std::unique_ptr<InterfaceConfig>> interfaces;
+
+    ArenaOperationTest() {
+        for (int i = 0; i < 10; ++i) {
+            this->interfaces.emplace_back(std::make_unique<InterfaceConfig>());
+            this->interfaces.back()->name = "itf" + std::to_string(i);
+            this->interfaces.back()->storedValue = {std::to_string(i)};
+        }
+    }
+};
+
+TEST_F(ArenaOperationTest, ParsedOperationsAreInArena) {
+    tools::Arena arena;
+    std::vector<std::unique_ptr<operation::Operation>> operations;
+    {
+        tools::Arena::Scope scope{arena};
+        operation::Parser2 parser{
+            this->debug, this->interfaces, this->interfaces[0].get()};
+        for (int i = 0; i < 9; ++i) {
+            std::string expression = "[itf" + std::to_string(i) +
+                                     "] * 2 + [itf" + std::to_string(i + 1) +
+                                     "] > 10 ? 'on' : 'off'";
+            operations.push_back(parser.parse(expression));
+            ASSERT_NE(operations.back(), nullptr);
+            EXPECT_EQ(tools::Arena::find(operations.back().get()), &arena);
+        }
+    }
+    EXPECT_EQ(operations[0]->evaluate(), "off");
+    EXPECT_EQ(operations[8]->evaluate(), "on");
+
+    const auto& statistics = arena.getStatistics();
+    EXPECT_LT(statistics.blocks, operations.size());
+    EXPECT_LE(statistics.used, statistics.capacity);
+    operations.clear();
+}
+
+TEST_F(ArenaOperationTest, DroppedOperationsAreReleased) {
+    tools::Arena arena;
+    std::unique_ptr<operation::Operation> operation;
+    {
+        tools::Arena::Scope scope{arena};
+        operation::Parser2 parser{
+            this->debug, this->interfaces, this->interfaces[0].get()};
+        operation = parser.parse("[itf1] + 2 * 3");
+        ASSERT_NE(operation, nullptr);
+    }
+    std::size_t released = arena.getStatistics().released;
+    EXPECT_GT(released, 0);
+
+    {
+        tools::Arena::Scope scope{arena};
+        operation::Parser2 parser{
+            this->debug, this->interfaces, this->interfaces[0].get()};
+        parser.setLimits({2, 100, 1000});
+        EXPECT_EQ(parser.parse("[itf1] + ([itf2] * ([itf3] - 1))"), nullptr);
+    }
+    EXPECT_GT(arena.getStatistics().released, released);
+    operation.reset();
+}
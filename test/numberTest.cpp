@@ -0,0 +1,272 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <optional>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Benchmark.hpp"
+#include "common/ArduinoJson.hpp"
+#include "tools/fromString.hpp"
+#include "tools/number.hpp"
+
+namespace {
+
+// The way numbers were converted before the number functions.
+std::string oldIntToString(int value, unsigned radix = 10) {
+    constexpr const char* characters = "0123456789ABCDEF";
+    if (value == 0) {
+        return "0";
+    }
+    std::string result;
+    bool negative = value < 0;
+    if (negative) {
+        value *= -1;
+    }
+    while (value != 0) {
+        result += characters[value % radix];
+        value /= radix;
+    }
+    if (negative) {
+        result += '-';
+    }
+    std::reverse(result.begin(), result.end());
+    return result;
+}
+
+std::string oldFloatToString(double value, int decimals) {
+    int intpart = static_cast<int>(value);
+    std::string result =
+        intpart == 0 && value < 0 ? "-0" : oldIntToString(intpart);
+    value -= intpart;
+    if (value == 0) {
+        return result;
+    }
+    if (value < 0) {
+        value *= -1;
+    }
+    result += '.';
+    for (int i = 0; i < decimals; ++i) {
+        if (value == 0) {
+            break;
+        }
+        value *= 10;
+        intpart = static_cast<int>(value);
+        result += intpart + '0';
+        value -= intpart;
+    }
+    return result;
+}
+
+template <typename T>
+std::optional<T> oldFromString(const std::string& s) {
+    ArduinoJson::StaticJsonBuffer<20> buf;
+    auto json = buf.parse(s);
+    return json.is<T>() ? std::make_optional<T>(json.as<T>()) : std::nullopt;
+}
+
+std::string formatInt(int value, unsigned radix = 10) {
+    char buffer[tools::maxIntLength];
+    return std::string(buffer, tools::formatInt(buffer, value, radix));
+}
+
+std::string formatFloat(double value, int decimals) {
+    std::vector<char> buffer(tools::maxFloatLength(decimals));
+    return std::string(
+        buffer.data(), tools::formatFloat(buffer.data(), value, decimals));
+}
+
+}  // unnamed namespace
+
+TEST(NumberTest, FormatInt) {
+    EXPECT_EQ(formatInt(0), "0");
+    EXPECT_EQ(formatInt(-125), "-125");
+    EXPECT_EQ(formatInt(0x12dead, 16), "12DEAD");
+    EXPECT_EQ(formatInt(INT_MAX), "2147483647");
+    EXPECT_EQ(formatInt(INT_MIN), "-2147483648");
+    EXPECT_EQ(formatInt(INT_MIN, 2), "-1" + std::string(31, '0'));
+    EXPECT_EQ(formatInt(12, 17), "");
+    EXPECT_EQ(formatInt(12, 1), "");
+}
+
+TEST(NumberTest, FormatIntSameAsOld) {
+    std::mt19937 random{42};
+    std::uniform_int_distribution<int> value{INT_MIN + 1, INT_MAX};
+    std::uniform_int_distribution<unsigned> radix{2, 16};
+    for (int i = 0; i < 10000; ++i) {
+        int n = i % 2 ? value(random) : value(random) % 1000;
+        unsigned r = i % 4 ? 10 : radix(random);
+        EXPECT_EQ(formatInt(n, r), oldIntToString(n, r)) << n << " " << r;
+    }
+}
+
+TEST(NumberTest, FormatFloatSameAsOld) {
+    std::mt19937 random{42};
+    std::uniform_real_distribution<double> value{-100000.0, 100000.0};
+    std::uniform_int_distribution<int> decimals{0, 8};
+    std::uniform_int_distribution<int> digits{0, 6};
+    for (int i = 0; i < 10000; ++i) {
+        double x = value(random);
+        switch (i % 4) {
+        case 1:
+            x = static_cast<float>(x);
+            break;
+        case 2:
+            x = std::round(x * std::pow(10, digits(random))) /
+                std::pow(10, digits(random));
+            break;
+        case 3:
+            x /= 100000.0;
+            break;
+        }
+        int d = decimals(random);
+        // The old function only worked for integer parts that fit in an int.
+        if (std::fabs(x) < 2147483648.0) {
+            EXPECT_EQ(formatFloat(x, d), oldFloatToString(x, d))
+                << x << " " << d;
+        }
+    }
+}
+
+TEST(NumberTest, FormatFloatBeyondInt) {
+    EXPECT_EQ(formatFloat(3000000000.0, 6), "3000000000");
+    EXPECT_EQ(formatFloat(-4294967296.5, 2), "-4294967296.5");
+    EXPECT_EQ(formatFloat(1e30, 0), "18446744073709549568");
+    EXPECT_EQ(
+        formatFloat(-std::numeric_limits<double>::infinity(), 2), "-inf");
+    EXPECT_EQ(formatFloat(std::numeric_limits<double>::quiet_NaN(), 2), "nan");
+    EXPECT_TRUE(std::isnan(tools::parseDouble("nan")));
+    EXPECT_EQ(tools::parseDouble("-inf"), -HUGE_VAL);
+}
+
+TEST(NumberTest, ParseDoubleSameAsAtof) {
+    const char* inputs[] = {
+        "0", "-0", "12", " \t+12.5", "-0.25", ".5", "5.", "1e3", "1E-3", "1e",
+        "1e+", "2.5e-300", "1e400", "0x1A", "-0X10", "inf", "-Infinity", "nan",
+        "", "abc", "12abc", "1.2.3", "00012.500", "9007199254740993",
+        "123456789012345678901234567890", "0.000000000000000000000001",
+        "3.4028235e38", "1.17549435e-38", "16777217", "0.1", "0.3"};
+    for (const char* input : inputs) {
+        double expected = std::atof(input);
+        double actual = tools::parseDouble(input);
+        if (std::isnan(expected)) {
+            EXPECT_TRUE(std::isnan(actual)) << input;
+        } else {
+            EXPECT_EQ(actual, expected) << input;
+            EXPECT_EQ(std::signbit(actual), std::signbit(expected)) << input;
+        }
+    }
+
+    std::mt19937 random{42};
+    std::uniform_real_distribution<double> value{-1e7, 1e7};
+    std::uniform_int_distribution<int> decimals{0, 9};
+    for (int i = 0; i < 10000; ++i) {
+        std::string input = formatFloat(value(random), decimals(random));
+        EXPECT_EQ(tools::parseDouble(input.c_str()), std::atof(input.c_str()))
+            << input;
+    }
+}
+
+TEST(NumberTest, ParseIntSameAsJson) {
+    const char* inputs[] = {
+        "12", " 12", "12 ", "-12", "+12", "", "12abc", "12;x", "12.5", "1e3",
+        "0x10", "\"12\"", "abc", "true", "12 34", "007", "-0", "2147483647",
+        "-2147483648", "\t\n 5", "1_000"};
+    for (const char* input : inputs) {
+        EXPECT_EQ(tools::fromString<int>(input), oldFromString<int>(input))
+            << input;
+    }
+}
+
+TEST(NumberTest, ParseIntRejectsWhatDoesNotFit) {
+    int result = 0;
+    EXPECT_FALSE(tools::parseInt("2147483648", result));
+    EXPECT_FALSE(tools::parseInt("-2147483649", result));
+    EXPECT_FALSE(tools::parseInt("99999999999", result));
+    EXPECT_FALSE(tools::parseInt("-", result));
+}
+
+TEST(NumberTest, ParseFloatSameAsJson) {
+    const char* inputs[] = {
+        "12", " 12", "12 ", "-12", "+12", "", "12abc", "12;x", "12.5", "1e3",
+        "0x10", "\"12\"", "abc", "true", "12 34", "-0", "  -3.25 ", ".5", "5.",
+        "1e", "Infinity", "-Infinity", ".", "e5", "-", "1.5e-3", "0.1", "1_0"};
+    for (const char* input : inputs) {
+        EXPECT_EQ(
+            tools::fromString<double>(input), oldFromString<double>(input))
+            << input;
+    }
+    auto nan = tools::fromString<double>("NaN");
+    ASSERT_TRUE(nan);
+    EXPECT_TRUE(std::isnan(*nan));
+}
+
+TEST(NumberTest, ParseFloatIsCorrectlyRounded) {
+    std::mt19937 random{42};
+    std::uniform_real_distribution<double> value{-1e5, 1e5};
+    for (int i = 0; i < 10000; ++i) {
+        std::string input = formatFloat(value(random), 9) + "e-3";
+        double result = 0.0;
+        ASSERT_TRUE(tools::parseFloat(input, result));
+        EXPECT_EQ(result, std::strtod(input.c_str(), nullptr)) << input;
+    }
+}
+
+TEST(NumberTest, DISABLED_Benchmark) {
+    constexpr int iterations = 100000;
+    const std::vector<std::string> inputs{"0", "512", "-12.25", "1023.5"};
+    std::vector<double> values;
+    for (const auto& input : inputs) {
+        values.push_back(std::atof(input.c_str()));
+    }
+    std::size_t length = 0;
+    double sum = 0;
+
+    double oldInt = measure(iterations, [&](int i) {
+        length += oldIntToString(i * 7919).size();
+    });
+    double newInt = measure(iterations, [&](int i) {
+        char buffer[tools::maxIntLength];
+        length += tools::formatInt(buffer, i * 7919) - buffer;
+    });
+    double oldFloat = measure(iterations, [&](int i) {
+        length += oldFloatToString(values[i % 4] + i, 6).size();
+    });
+    double newFloat = measure(iterations, [&](int i) {
+        char buffer[tools::maxFloatLength(6)];
+        length += tools::formatFloat(buffer, values[i % 4] + i, 6) - buffer;
+    });
+    double oldAtof = measure(iterations, [&](int i) {
+        sum += std::atof(inputs[i % 4].c_str());
+    });
+    double newAtof = measure(iterations, [&](int i) {
+        sum += tools::parseDouble(inputs[i % 4].c_str());
+    });
+    double oldFromInt = measure(iterations, [&](int i) {
+        sum += *oldFromString<int>(inputs[i % 2]);
+    });
+    double newFromInt = measure(iterations, [&](int i) {
+        sum += *tools::fromString<int>(inputs[i % 2]);
+    });
+    double oldFromDouble = measure(iterations, [&](int i) {
+        sum += *oldFromString<double>(inputs[i % 4]);
+    });
+    double newFromDouble = measure(iterations, [&](int i) {
+        sum += *tools::fromString<double>(inputs[i % 4]);
+    });
+
+    std::cout << "old/new ns: intToString " << oldInt << "/" << newInt
+              << ", floatToString " << oldFloat << "/" << newFloat
+              << ", atof " << oldAtof << "/" << newAtof
+              << ", fromString<int> " << oldFromInt << "/" << newFromInt
+              << ", fromString<double> " << oldFromDouble << "/"
+              << newFromDouble << std::endl;
+    EXPECT_GT(length, 0);
+    EXPECT_NE(sum, 0);
+}
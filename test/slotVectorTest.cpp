@@ -0,0 +1,57 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "tools/slotVector.hpp"
+
+using Strings = tools::SlotVector<std::string, 2>;
+
+TEST(SlotVectorTest, Empty) {
+    Strings values;
+    EXPECT_TRUE(values.empty());
+    EXPECT_EQ(values.size(), 0);
+    EXPECT_EQ(values.begin(), values.end());
+    EXPECT_EQ(values.capacity(), 2);
+}
+
+TEST(SlotVectorTest, Assign) {
+    Strings values{"a", "b"};
+    ASSERT_EQ(values.size(), 2);
+    EXPECT_EQ(values[0], "a");
+    EXPECT_EQ(values[1], "b");
+    EXPECT_EQ(values, (std::vector<std::string>{"a", "b"}));
+    EXPECT_NE(values, (std::vector<std::string>{"a"}));
+    EXPECT_NE(values, (std::vector<std::string>{"a", "c"}));
+
+    values = {"c"};
+    EXPECT_EQ(values, (std::vector<std::string>{"c"}));
+}
+
+TEST(SlotVectorTest, ReusesSlots) {
+    Strings values{std::string(100, 'a')};
+    const std::string* slot = &values[0];
+    const char* storage = values[0].data();
+    values.clear();
+    EXPECT_TRUE(values.empty());
+    values.push_back(std::string_view{"b"});
+    EXPECT_EQ(&values[0], slot);
+    EXPECT_EQ(values[0].data(), storage);
+    EXPECT_EQ(values[0], "b");
+}
+
+TEST(SlotVectorTest, MovesToHeapWhenFull) {
+    Strings values{"a", "b"};
+    const std::string* inlineData = values.data();
+    values.push_back("c");
+    EXPECT_NE(values.data(), inlineData);
+    EXPECT_EQ(values, (std::vector<std::string>{"a", "b", "c"}));
+
+    values = {"d"};
+    EXPECT_EQ(values, (std::vector<std::string>{"d"}));
+    EXPECT_EQ(values.capacity(), 3);
+    values.push_back("e");
+    values.push_back("f");
+    EXPECT_EQ(values, (std::vector<std::string>{"d", "e", "f"}));
+}
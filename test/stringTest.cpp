@@ -1,5 +1,9 @@
 #include <gtest/gtest.h>
 
+#include <iostream>
+#include <random>
+
+#include "Benchmark.hpp"
 #include "tools/string.hpp"
 
 TEST(StringTest, NextTokenTest_ReadTokensInString) {
@@ -127,6 +131,92 @@ TEST(StringTest, SubstituteTest_IgnoreNegativeReference) {
     EXPECT_EQ(tools::substitute("%-1", values), "-1");
 }
 
+TEST(StringTest, SubstituteTest_CompiledTemplateIsReusable) {
+    const tools::ValueTemplate valueTemplate{"%2 %3"};
+    EXPECT_EQ(
+        valueTemplate.substitute(std::vector<std::string>{"a", "b", "c"}),
+        "b c");
+    EXPECT_EQ(
+        valueTemplate.substitute(std::vector<std::string>{"blink", "500"}),
+        "500 ");
+}
+
+namespace {
+
+// The way templates were substituted before they were compiled.
+std::string scanningSubstitute(
+    const std::string& valueTemplate, const std::vector<std::string>& values) {
+    std::string result;
+    std::string reference;
+    auto addValue = [&]() {
+        std::size_t value = std::atol(reference.c_str());
+        if (value > 0 && value <= values.size()) {
+            result += values[value - 1];
+        }
+        reference = "";
+    };
+    bool inReference = false;
+    for (char c : valueTemplate) {
+        if (inReference) {
+            if (c >= '0' && c <= '9') {
+                reference += c;
+                continue;
+            }
+            inReference = false;
+            if (reference.empty()) {
+                result += c;
+                continue;
+            }
+            addValue();
+        }
+        if (c == '%') {
+            inReference = true;
+        } else {
+            result += c;
+        }
+    }
+    addValue();
+    return result;
+}
+
+}  // unnamed namespace
+
+TEST(StringTest, SubstituteTest_SameAsScanning) {
+    const std::vector<std::string> values{"foo", "bar", "baz"};
+    const char characters[] = "%%0123a ";
+    std::mt19937 random{42};
+    std::uniform_int_distribution<std::size_t> character{
+        0, sizeof(characters) - 2};
+    std::uniform_int_distribution<std::size_t> length{0, 12};
+    for (int i = 0; i < 10000; ++i) {
+        std::string valueTemplate;
+        for (std::size_t j = length(random); j > 0; --j) {
+            valueTemplate += characters[character(random)];
+        }
+        EXPECT_EQ(
+            tools::substitute(valueTemplate, values),
+            scanningSubstitute(valueTemplate, values))
+            << valueTemplate;
+    }
+}
+
+TEST(StringTest, DISABLED_SubstituteTest_BenchmarkCompiledTemplate) {
+    const std::vector<std::string> values{"blink", "500", "1000"};
+    const std::string templateString = "%2 %3";
+    const tools::ValueTemplate valueTemplate{templateString};
+    constexpr int iterations = 200000;
+    std::size_t length = 0;
+    double scanning = measure(iterations, [&](int /*i*/) {
+        length += scanningSubstitute(templateString, values).size();
+    });
+    double compiled = measure(iterations, [&](int /*i*/) {
+        length += valueTemplate.substitute(values).size();
+    });
+    EXPECT_EQ(length, iterations * 2 * std::string{"500 1000"}.size());
+    std::cout << "\"" << templateString << "\" scanning: " << scanning
+              << " ns, compiled: " << compiled << " ns" << std::endl;
+}
+
 TEST(StringTest, GetBoolValueTest_Zero) {
     bool result = false;
     EXPECT_TRUE(tools::getBoolValue("0", result));